@@ -0,0 +1,157 @@
+/*
+** Copyright (c) 2017-2019 The Khronos Group Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef OPENXR_LOADER_H_
+#define OPENXR_LOADER_H_ 1
+
+/* Entry points exported by the OpenXR loader library itself.
+ *
+ * These are not part of the OpenXR API: they can only be linked against (or
+ * looked up in the loader library directly), never retrieved through
+ * xrGetInstanceProcAddr, and no runtime or API layer implements them.
+ */
+
+#include "openxr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Start finding and opening the active runtime and the implicit API layers on
+ * a background thread and return immediately.  A later xrCreateInstance waits
+ * for that work and reuses it instead of repeating it.  Calling it again does
+ * nothing.  A process that exits without creating an instance waits for the
+ * work in progress to finish first.
+ */
+typedef XrResult (XRAPI_PTR *PFN_xrLoaderPreload)(void);
+
+/* The loader reads the environment variables it depends on (XR_RUNTIME_JSON,
+ * XR_API_LAYER_PATH, XR_ENABLE_API_LAYERS, the XDG directories and so on) once,
+ * the first time it needs them.  Changes an application makes to its own
+ * environment after that only take effect once it calls this.
+ */
+typedef void (XRAPI_PTR *PFN_xrLoaderRefreshEnvironment)(void);
+
+/* Time spent in each phase of creating an instance, in nanoseconds.  Each phase only counts
+ * its own time, not that of phases nested in it (for example the runtime's xrCreateInstance
+ * is not part of apiLayerCreateInstanceNs), and only work done on the calling thread is
+ * included.  totalNs also covers everything not attributed to a phase.
+ */
+typedef struct XrLoaderInstanceCreateTimings {
+    uint64_t totalNs;
+    uint64_t manifestDiscoveryNs;
+    uint64_t manifestParsingNs;
+    uint64_t libraryLoadingNs;
+    uint64_t negotiationNs;
+    uint64_t apiLayerCreateInstanceNs;
+    uint64_t runtimeCreateInstanceNs;
+    uint64_t dispatchTableNs;
+} XrLoaderInstanceCreateTimings;
+
+/* Get the phase timings recorded while instance was created.  The same breakdown is logged
+ * at the info level (XR_LOADER_DEBUG=info) as each instance is created.
+ */
+typedef XrResult (XRAPI_PTR *PFN_xrLoaderGetInstanceCreateTimings)(XrInstance instance,
+                                                                   XrLoaderInstanceCreateTimings *timings);
+
+/* Bytes the loader currently keeps resident, by what they are used for.  These cover the whole
+ * process, not just one instance: the tables tracking handles and the parsed manifests are shared
+ * by all instances, so they can't be split between them.  What one instance costs shows as the
+ * difference between the footprint taken before it is created and one taken while it is alive.
+ * Manifest and object name bytes are estimated from the sizes of the containers holding them.
+ * The same breakdown is logged at the info level (XR_LOADER_DEBUG=info) whenever an instance is
+ * created or destroyed.
+ */
+typedef struct XrLoaderMemoryFootprint {
+    uint64_t totalBytes;
+    uint64_t instanceBytes;
+    uint64_t dispatchTableBytes;
+    uint64_t handleMapBytes;
+    uint64_t manifestBytes;
+    uint64_t objectNameBytes;
+} XrLoaderMemoryFootprint;
+
+typedef XrResult (XRAPI_PTR *PFN_xrLoaderGetMemoryFootprint)(XrLoaderMemoryFootprint *footprint);
+
+/* Chained to XrInstanceCreateInfo::next to have the loader allocate the memory it keeps around
+ * (instances, dispatch tables, the tables tracking handles) through the application rather than
+ * the global heap.  The loader tracks the handles of all instances together, so all instances
+ * alive at the same time must be created with the same callbacks, or all without any:
+ * xrCreateInstance fails with XR_ERROR_VALIDATION_FAILURE otherwise.  The callbacks are no longer
+ * called once the last instance using them has been destroyed.  The structure is taken out of the
+ * chain passed on to API layers and the runtime, which allocate on their own, so only
+ * XrDebugUtilsMessengerCreateInfoEXT structures may come before it in the chain.
+ */
+#define XR_TYPE_LOADER_ALLOCATION_CALLBACKS ((XrStructureType)1000999000)
+
+typedef void *(XRAPI_PTR *PFN_xrLoaderAllocationFunction)(void *userData, size_t size, size_t alignment);
+typedef void (XRAPI_PTR *PFN_xrLoaderFreeFunction)(void *userData, void *memory);
+
+typedef struct XrLoaderAllocationCallbacks {
+    XrStructureType type;
+    const void *XR_MAY_ALIAS next;
+    void *userData;
+    PFN_xrLoaderAllocationFunction pfnAllocation;
+    PFN_xrLoaderFreeFunction pfnFree;
+} XrLoaderAllocationCallbacks;
+
+/* XR_EXT_loader_statistics is implemented by the loader itself, and only offered by loaders
+ * built with LOADER_STATISTICS enabled.  Once it is enabled on an instance, its commands are
+ * retrieved through xrGetInstanceProcAddr like those of any other extension.
+ *
+ * Statistics cover the whole process rather than just the instance they are queried through.
+ * Calls are counted, and timed from the loader trampoline down to the runtime and back, for
+ * each command the loader dispatches through a generated trampoline.
+ */
+#define XR_EXT_loader_statistics 1
+#define XR_EXT_loader_statistics_SPEC_VERSION 1
+#define XR_EXT_LOADER_STATISTICS_EXTENSION_NAME "XR_EXT_loader_statistics"
+
+typedef struct XrLoaderCommandStatisticsEXT {
+    const char *commandName;
+    uint64_t callCount;
+    uint64_t totalNs;
+    uint64_t maxNs;
+} XrLoaderCommandStatisticsEXT;
+
+/* Number of handles of one type currently tracked by the loader. */
+typedef struct XrLoaderHandleStatisticsEXT {
+    XrObjectType objectType;
+    uint64_t handleCount;
+} XrLoaderHandleStatisticsEXT;
+
+/* Both follow the usual two-call idiom.  Every command is always reported, whether it has been
+ * called yet or not, so the count doesn't change between the two calls.
+ */
+typedef XrResult (XRAPI_PTR *PFN_xrEnumerateLoaderCommandStatisticsEXT)(XrInstance instance, uint32_t statisticCapacityInput,
+                                                                        uint32_t *statisticCountOutput,
+                                                                        XrLoaderCommandStatisticsEXT *statistics);
+typedef XrResult (XRAPI_PTR *PFN_xrEnumerateLoaderHandleStatisticsEXT)(XrInstance instance, uint32_t statisticCapacityInput,
+                                                                       uint32_t *statisticCountOutput,
+                                                                       XrLoaderHandleStatisticsEXT *statistics);
+
+#ifndef XR_NO_PROTOTYPES
+XRAPI_ATTR XrResult XRAPI_CALL xrLoaderPreload(void);
+XRAPI_ATTR void XRAPI_CALL xrLoaderRefreshEnvironment(void);
+XRAPI_ATTR XrResult XRAPI_CALL xrLoaderGetInstanceCreateTimings(XrInstance instance, XrLoaderInstanceCreateTimings *timings);
+XRAPI_ATTR XrResult XRAPI_CALL xrLoaderGetMemoryFootprint(XrLoaderMemoryFootprint *footprint);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,163 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Pass-through API layer.
+//
+// Forwards every command to the next layer or the runtime without doing anything else, as a
+// baseline for what a layer costs just by being in the chain.  The library can back several
+// layers at once, so it can be stacked many times in one chain: each layer name negotiated gets a
+// slot of its own, with its own instantiation of every generated command.
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "xr_generated_passthrough.hpp"
+#include "xr_generated_dispatch_table.h"
+#include "loader_interfaces.h"
+#include "api_layer_slots.hpp"
+
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define LAYER_EXPORT __attribute__((visibility("default")))
+#elif defined(__SUNPRO_C) && (__SUNPRO_C >= 0x590)
+#define LAYER_EXPORT __attribute__((visibility("default")))
+#else
+#define LAYER_EXPORT
+#endif
+
+// Commands can skip the maps while a slot has a single instance.  Call with state.map_mutex held.
+static void PassthroughLayerUpdateOnlyDispatch(PassthroughLayerState &state) {
+    XrGeneratedDispatchTable *only_dispatch = nullptr;
+    if (1 == state.instance_dispatch_map.size()) {
+        only_dispatch = state.instance_dispatch_map.begin()->second;
+    }
+    state.only_dispatch.store(only_dispatch, std::memory_order_release);
+}
+
+template <uint32_t Slot>
+XrResult PassthroughLayerXrCreateApiLayerInstance(const XrInstanceCreateInfo *info, const struct XrApiLayerCreateInfo *apiLayerInfo,
+                                                  XrInstance *instance);
+
+template <uint32_t Slot>
+struct PassthroughLayerSlotCommands {
+    static PFN_xrGetInstanceProcAddr GetInstanceProcAddr() {
+        return reinterpret_cast<PFN_xrGetInstanceProcAddr>(PassthroughLayerXrGetInstanceProcAddr<Slot>);
+    }
+    static PFN_xrCreateApiLayerInstance CreateApiLayerInstance() {
+        return reinterpret_cast<PFN_xrCreateApiLayerInstance>(PassthroughLayerXrCreateApiLayerInstance<Slot>);
+    }
+};
+
+static ApiLayerSlots<PassthroughLayerSlotCommands, XR_PASSTHROUGH_LAYER_MAX_SLOTS> g_slots;
+
+template <uint32_t Slot>
+XrResult PassthroughLayerXrCreateApiLayerInstance(const XrInstanceCreateInfo *info, const struct XrApiLayerCreateInfo *apiLayerInfo,
+                                                  XrInstance *instance) {
+    try {
+        std::string layer_name = g_slots.LayerName(Slot);
+
+        // Validate the API layer info and next API layer info structures before we try to use them
+        if (nullptr == apiLayerInfo || XR_LOADER_INTERFACE_STRUCT_API_LAYER_CREATE_INFO != apiLayerInfo->structType ||
+            XR_API_LAYER_CREATE_INFO_STRUCT_VERSION > apiLayerInfo->structVersion ||
+            sizeof(XrApiLayerCreateInfo) > apiLayerInfo->structSize || nullptr == apiLayerInfo->loaderInstance ||
+            nullptr == apiLayerInfo->nextInfo ||
+            XR_LOADER_INTERFACE_STRUCT_API_LAYER_NEXT_INFO != apiLayerInfo->nextInfo->structType ||
+            XR_API_LAYER_NEXT_INFO_STRUCT_VERSION > apiLayerInfo->nextInfo->structVersion ||
+            sizeof(XrApiLayerNextInfo) > apiLayerInfo->nextInfo->structSize ||
+            layer_name != apiLayerInfo->nextInfo->layerName || nullptr == apiLayerInfo->nextInfo->nextGetInstanceProcAddr ||
+            nullptr == apiLayerInfo->nextInfo->nextCreateApiLayerInstance) {
+            return XR_ERROR_INITIALIZATION_FAILED;
+        }
+
+        // Copy the contents of the layer info struct, but then move the next info up by
+        // one slot so that the next layer gets information.
+        XrApiLayerCreateInfo new_api_layer_info = *apiLayerInfo;
+        new_api_layer_info.nextInfo = apiLayerInfo->nextInfo->next;
+        PFN_xrGetInstanceProcAddr next_get_instance_proc_addr = apiLayerInfo->nextInfo->nextGetInstanceProcAddr;
+
+        XrResult result = apiLayerInfo->nextInfo->nextCreateApiLayerInstance(info, &new_api_layer_info, instance);
+        if (XR_FAILED(result)) {
+            return result;
+        }
+
+        // Create the dispatch table to the next levels
+        std::unique_ptr<XrGeneratedDispatchTable> next_dispatch(new XrGeneratedDispatchTable());
+        GeneratedXrPopulateDispatchTable(next_dispatch.get(), *instance, next_get_instance_proc_addr);
+
+        PassthroughLayerState &state = g_passthrough_state[Slot];
+        std::unique_lock<std::mutex> map_lock(state.map_mutex);
+        state.instance_dispatch_map[*instance] = next_dispatch.release();
+        PassthroughLayerUpdateOnlyDispatch(state);
+        return result;
+    } catch (...) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+}
+
+template <uint32_t Slot>
+XrResult PassthroughLayerXrDestroyInstance(XrInstance instance) {
+    PassthroughLayerState &state = g_passthrough_state[Slot];
+    XrGeneratedDispatchTable *next_dispatch = PassthroughLayerNextDispatch(state, state.instance_dispatch_map, instance);
+    if (nullptr == next_dispatch) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    XrResult result = next_dispatch->DestroyInstance(instance);
+
+    std::unique_lock<std::mutex> map_lock(state.map_mutex);
+    PassthroughLayerCleanUpMapsForTable(state, next_dispatch);
+    PassthroughLayerUpdateOnlyDispatch(state);
+    map_lock.unlock();
+    delete next_dispatch;
+    return result;
+}
+
+extern "C" {
+
+// Function used to negotiate an interface betewen the loader and an API layer.  Each library exposing one or
+// more API layers needs to expose at least this function.
+LAYER_EXPORT XrResult xrNegotiateLoaderApiLayerInterface(const XrNegotiateLoaderInfo *loaderInfo, const char *apiLayerName,
+                                                         XrNegotiateApiLayerRequest *apiLayerRequest) {
+    if (nullptr == loaderInfo || nullptr == apiLayerName || nullptr == apiLayerRequest ||
+        loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO ||
+        loaderInfo->structVersion != XR_LOADER_INFO_STRUCT_VERSION || loaderInfo->structSize != sizeof(XrNegotiateLoaderInfo) ||
+        apiLayerRequest->structType != XR_LOADER_INTERFACE_STRUCT_API_LAYER_REQUEST ||
+        apiLayerRequest->structVersion != XR_API_LAYER_INFO_STRUCT_VERSION ||
+        apiLayerRequest->structSize != sizeof(XrNegotiateApiLayerRequest) ||
+        loaderInfo->minInterfaceVersion > XR_CURRENT_LOADER_API_LAYER_VERSION ||
+        loaderInfo->maxInterfaceVersion < XR_CURRENT_LOADER_API_LAYER_VERSION ||
+        loaderInfo->maxInterfaceVersion > XR_CURRENT_LOADER_API_LAYER_VERSION ||
+        loaderInfo->maxXrVersion < XR_CURRENT_API_VERSION || loaderInfo->minXrVersion > XR_CURRENT_API_VERSION) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+
+    uint32_t slot = 0;
+    try {
+        if (!g_slots.AcquireSlot(apiLayerName, slot)) {
+            return XR_ERROR_INITIALIZATION_FAILED;
+        }
+    } catch (...) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+
+    apiLayerRequest->layerInterfaceVersion = XR_CURRENT_LOADER_API_LAYER_VERSION;
+    apiLayerRequest->layerXrVersion = XR_CURRENT_API_VERSION;
+    apiLayerRequest->getInstanceProcAddr = g_slots.EntryPoints(slot).get_instance_proc_addr;
+    apiLayerRequest->createApiLayerInstance = g_slots.EntryPoints(slot).create_api_layer_instance;
+
+    return XR_SUCCESS;
+}
+
+}  // extern "C"
@@ -0,0 +1,105 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Slots for API layer libraries that back several layers at once.
+//
+// Each layer name negotiated gets a slot of its own, and each slot its own instantiation of the
+// layer's entry points, so that the layers can tell themselves apart in one chain.  The library
+// supplies the entry points through a class template taking the slot:
+//
+//     template <uint32_t Slot>
+//     struct MyLayerSlotCommands {
+//         static PFN_xrGetInstanceProcAddr GetInstanceProcAddr();
+//         static PFN_xrCreateApiLayerInstance CreateApiLayerInstance();
+//     };
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <openxr/openxr.h>
+
+#include "loader_interfaces.h"
+
+struct ApiLayerSlotEntryPoints {
+    PFN_xrGetInstanceProcAddr get_instance_proc_addr;
+    PFN_xrCreateApiLayerInstance create_api_layer_instance;
+};
+
+// Fills in the entry points of the first Count slots
+template <template <uint32_t> class SlotCommands, uint32_t Count>
+struct ApiLayerSlotEntryPointTable {
+    static void Fill(ApiLayerSlotEntryPoints *entry_points) {
+        ApiLayerSlotEntryPointTable<SlotCommands, Count - 1>::Fill(entry_points);
+        entry_points[Count - 1].get_instance_proc_addr = SlotCommands<Count - 1>::GetInstanceProcAddr();
+        entry_points[Count - 1].create_api_layer_instance = SlotCommands<Count - 1>::CreateApiLayerInstance();
+    }
+};
+
+template <template <uint32_t> class SlotCommands>
+struct ApiLayerSlotEntryPointTable<SlotCommands, 0> {
+    static void Fill(ApiLayerSlotEntryPoints * /*entry_points*/) {}
+};
+
+template <template <uint32_t> class SlotCommands, uint32_t MaxSlots>
+class ApiLayerSlots {
+   public:
+    ApiLayerSlots() { ApiLayerSlotEntryPointTable<SlotCommands, MaxSlots>::Fill(_entry_points); }
+
+    // Find the slot already given to this layer name, or hand out a free one.  Returns false once all slots are taken.
+    bool AcquireSlot(const char *layer_name, uint32_t &slot) {
+        std::unique_lock<std::mutex> slot_lock(_mutex);
+        if (FindSlotLocked(layer_name, slot)) {
+            return true;
+        }
+        for (slot = 0; slot < MaxSlots; ++slot) {
+            if (_layer_names[slot].empty()) {
+                _layer_names[slot] = layer_name;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Find the slot given to this layer name, without handing out a new one
+    bool FindSlot(const char *layer_name, uint32_t &slot) {
+        std::unique_lock<std::mutex> slot_lock(_mutex);
+        return FindSlotLocked(layer_name, slot);
+    }
+
+    std::string LayerName(uint32_t slot) {
+        std::unique_lock<std::mutex> slot_lock(_mutex);
+        return _layer_names[slot];
+    }
+
+    // Never changes after construction, so needs no lock
+    const ApiLayerSlotEntryPoints &EntryPoints(uint32_t slot) const { return _entry_points[slot]; }
+
+   private:
+    bool FindSlotLocked(const char *layer_name, uint32_t &slot) const {
+        for (slot = 0; slot < MaxSlots; ++slot) {
+            if (_layer_names[slot] == layer_name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::mutex _mutex;
+    std::string _layer_names[MaxSlots];
+    ApiLayerSlotEntryPoints _entry_points[MaxSlots];
+};
@@ -79,6 +79,21 @@
 #include <dirent.h>
 #endif
 
+// Includes for directory scanning and mapped files
+#if defined(XR_OS_LINUX) || defined(XR_OS_APPLE)
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#if defined(XR_OS_WINDOWS)
+#include <windows.h>
+#endif
+#endif
+
 #include "filesystem_utils.hpp"
 
 #if defined(XR_OS_WINDOWS)
@@ -452,3 +467,260 @@ bool FileSysUtilsFindFilesInPath(const std::string& path, std::vector<std::strin
 }
 
 #endif
+
+static inline bool FileSysUtilsNameHasExtension(const char* name, size_t name_length, const std::string& extension) {
+    return name_length > extension.size() && 0 == memcmp(name + name_length - extension.size(), extension.data(), extension.size());
+}
+
+#if defined(XR_OS_LINUX) || defined(XR_OS_APPLE)
+
+bool FileSysUtilsGetFileIdentity(const std::string& path, FileSysUtilsFileIdentity& identity) {
+    struct stat path_stat;
+    if (0 != stat(path.c_str(), &path_stat)) {
+        return false;
+    }
+    identity.device = static_cast<uint64_t>(path_stat.st_dev);
+    identity.index = static_cast<uint64_t>(path_stat.st_ino);
+    return true;
+}
+
+bool FileSysUtilsGetFileStamp(const std::string& path, FileSysUtilsFileStamp& stamp) {
+    struct stat path_stat;
+    if (0 != stat(path.c_str(), &path_stat)) {
+        return false;
+    }
+    stamp.size = static_cast<uint64_t>(path_stat.st_size);
+#if defined(XR_OS_APPLE)
+    stamp.modified = static_cast<int64_t>(path_stat.st_mtimespec.tv_sec) * 1000000000 + path_stat.st_mtimespec.tv_nsec;
+#else
+    stamp.modified = static_cast<int64_t>(path_stat.st_mtim.tv_sec) * 1000000000 + path_stat.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+bool FileSysUtilsScanDirectory(const std::string& path, const std::string& extension,
+                               std::vector<FileSysUtilsDirectoryEntry>& entries) {
+    try {
+        int dir_fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd < 0) {
+            return false;
+        }
+        // The DIR stream takes ownership of dir_fd, which we keep using for fstatat below.
+        DIR* dir = fdopendir(dir_fd);
+        if (nullptr == dir) {
+            close(dir_fd);
+            return false;
+        }
+        struct dirent* entry;
+        while (nullptr != (entry = readdir(dir))) {
+            size_t name_length = strlen(entry->d_name);
+            // Filter on the name first, that never requires touching the filesystem.
+            if (!FileSysUtilsNameHasExtension(entry->d_name, name_length, extension)) {
+                continue;
+            }
+            bool is_symlink = false;
+            bool is_regular = false;
+            unsigned char entry_type = entry->d_type;
+            if (DT_UNKNOWN == entry_type) {
+                struct stat entry_stat;
+                if (0 != fstatat(dir_fd, entry->d_name, &entry_stat, AT_SYMLINK_NOFOLLOW)) {
+                    continue;
+                }
+                entry_type = S_ISLNK(entry_stat.st_mode) ? DT_LNK : (S_ISREG(entry_stat.st_mode) ? DT_REG : DT_UNKNOWN);
+            }
+            if (DT_REG == entry_type) {
+                is_regular = true;
+            } else if (DT_LNK == entry_type) {
+                struct stat target_stat;
+                is_symlink = true;
+                is_regular = (0 == fstatat(dir_fd, entry->d_name, &target_stat, 0) && S_ISREG(target_stat.st_mode));
+            }
+            if (is_regular) {
+                entries.push_back({std::string(entry->d_name, name_length), is_symlink});
+            }
+        }
+        closedir(dir);
+        return true;
+    } catch (...) {
+    }
+    return false;
+}
+
+#else  // No directory entry types, fall back to checking each file
+
+bool FileSysUtilsGetFileIdentity(const std::string& path, FileSysUtilsFileIdentity& identity) {
+#if defined(XR_OS_WINDOWS)
+    // FILE_FLAG_BACKUP_SEMANTICS is required to open a handle to a directory.
+    HANDLE file_handle = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                     OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (INVALID_HANDLE_VALUE == file_handle) {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION file_info;
+    BOOL got_info = GetFileInformationByHandle(file_handle, &file_info);
+    CloseHandle(file_handle);
+    if (!got_info) {
+        return false;
+    }
+    identity.device = file_info.dwVolumeSerialNumber;
+    identity.index = (static_cast<uint64_t>(file_info.nFileIndexHigh) << 32) | file_info.nFileIndexLow;
+    return true;
+#else
+    (void)path;
+    (void)identity;
+    return false;
+#endif
+}
+
+bool FileSysUtilsGetFileStamp(const std::string& path, FileSysUtilsFileStamp& stamp) {
+#if defined(XR_OS_WINDOWS)
+    WIN32_FILE_ATTRIBUTE_DATA file_data;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &file_data)) {
+        return false;
+    }
+    stamp.size = (static_cast<uint64_t>(file_data.nFileSizeHigh) << 32) | file_data.nFileSizeLow;
+    stamp.modified = static_cast<int64_t>((static_cast<uint64_t>(file_data.ftLastWriteTime.dwHighDateTime) << 32) |
+                                          file_data.ftLastWriteTime.dwLowDateTime);
+    return true;
+#else
+    (void)path;
+    (void)stamp;
+    return false;
+#endif
+}
+
+bool FileSysUtilsScanDirectory(const std::string& path, const std::string& extension,
+                               std::vector<FileSysUtilsDirectoryEntry>& entries) {
+    try {
+        std::vector<std::string> files;
+        if (!FileSysUtilsFindFilesInPath(path, files)) {
+            return false;
+        }
+        for (std::string& file : files) {
+            std::string full_path;
+            if (!FileSysUtilsNameHasExtension(file.c_str(), file.size(), extension) ||
+                !FileSysUtilsCombinePaths(path, file, full_path) || !FileSysUtilsIsRegularFile(full_path)) {
+                continue;
+            }
+            entries.push_back({file, true});
+        }
+        return true;
+    } catch (...) {
+    }
+    return false;
+}
+
+#endif
+
+FileSysUtilsMappedFile::FileSysUtilsMappedFile() : _is_open(false), _data(nullptr), _size(0), _mapping(nullptr) {}
+
+FileSysUtilsMappedFile::~FileSysUtilsMappedFile() { Close(); }
+
+#if defined(XR_OS_LINUX) || defined(XR_OS_APPLE)
+
+bool FileSysUtilsMappedFile::Open(const std::string& path) {
+    Close();
+    try {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat file_stat;
+        if (0 != fstat(fd, &file_stat) || !S_ISREG(file_stat.st_mode)) {
+            close(fd);
+            return false;
+        }
+        size_t file_size = static_cast<size_t>(file_stat.st_size);
+        if (file_size > kMapThreshold) {
+            void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED != mapping) {
+                close(fd);
+                _mapping = mapping;
+                _data = static_cast<const char*>(mapping);
+                _size = file_size;
+                _is_open = true;
+                return true;
+            }
+            // Mapping can fail on some special filesystems, fall back to reading the file.
+        }
+        _buffer.resize(file_size);
+        size_t total_read = 0;
+        while (total_read < file_size) {
+            ssize_t bytes_read = read(fd, _buffer.data() + total_read, file_size - total_read);
+            if (bytes_read < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+                break;
+            }
+            if (0 == bytes_read) {
+                break;
+            }
+            total_read += static_cast<size_t>(bytes_read);
+        }
+        close(fd);
+        if (total_read != file_size) {
+            _buffer.clear();
+            return false;
+        }
+        // An empty vector may have no storage at all, so point empty files at an empty string
+        _data = _buffer.empty() ? "" : _buffer.data();
+        _size = file_size;
+        _is_open = true;
+        return true;
+    } catch (...) {
+    }
+    Close();
+    return false;
+}
+
+void FileSysUtilsMappedFile::Close() {
+    if (nullptr != _mapping) {
+        munmap(_mapping, _size);
+        _mapping = nullptr;
+    }
+    _buffer.clear();
+    _data = nullptr;
+    _size = 0;
+    _is_open = false;
+}
+
+#else  // No mapping support, read the whole file into a buffer
+
+bool FileSysUtilsMappedFile::Open(const std::string& path) {
+    Close();
+    try {
+        std::ifstream file_stream(path, std::ios::in | std::ios::binary);
+        if (!file_stream.is_open()) {
+            return false;
+        }
+        file_stream.seekg(0, std::ios::end);
+        std::streamoff file_size = file_stream.tellg();
+        if (file_size < 0) {
+            return false;
+        }
+        file_stream.seekg(0, std::ios::beg);
+        _buffer.resize(static_cast<size_t>(file_size));
+        if (!_buffer.empty() && !file_stream.read(_buffer.data(), file_size)) {
+            _buffer.clear();
+            return false;
+        }
+        // An empty vector may have no storage at all, so point empty files at an empty string
+        _data = _buffer.empty() ? "" : _buffer.data();
+        _size = _buffer.size();
+        _is_open = true;
+        return true;
+    } catch (...) {
+    }
+    Close();
+    return false;
+}
+
+void FileSysUtilsMappedFile::Close() {
+    _buffer.clear();
+    _data = nullptr;
+    _size = 0;
+    _is_open = false;
+}
+
+#endif
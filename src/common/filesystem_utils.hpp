@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -51,3 +53,70 @@ bool FileSysUtilsParsePathList(std::string& path_list, std::vector<std::string>&
 
 // Record all the filenames for files found in the provided path.
 bool FileSysUtilsFindFilesInPath(const std::string& path, std::vector<std::string>& files);
+
+// Identifies a file or directory independently of the path used to reach it.
+struct FileSysUtilsFileIdentity {
+    uint64_t device;
+    uint64_t index;
+
+    bool operator==(const FileSysUtilsFileIdentity& other) const { return device == other.device && index == other.index; }
+};
+
+// Get the identity of the file or directory a path refers to, following symbolic links
+bool FileSysUtilsGetFileIdentity(const std::string& path, FileSysUtilsFileIdentity& identity);
+
+// Size and last modification time of a file, used to tell whether its contents may have changed.
+struct FileSysUtilsFileStamp {
+    uint64_t size;
+    int64_t modified;
+
+    bool operator==(const FileSysUtilsFileStamp& other) const { return size == other.size && modified == other.modified; }
+    bool operator!=(const FileSysUtilsFileStamp& other) const { return !(*this == other); }
+};
+
+// Get the size and modification time of the file a path refers to, following symbolic links
+bool FileSysUtilsGetFileStamp(const std::string& path, FileSysUtilsFileStamp& stamp);
+
+// A single entry found by FileSysUtilsScanDirectory.
+struct FileSysUtilsDirectoryEntry {
+    std::string name;     // Relative to the scanned directory
+    bool may_be_symlink;  // Set when the entry is, or couldn't be ruled out as, a symbolic link
+};
+
+// Enumerate the regular files (or links to regular files) directly inside a directory whose names end with
+// the given extension, in a single pass.  File types come from the directory entries themselves and are only
+// looked up individually when the filesystem doesn't report them.
+bool FileSysUtilsScanDirectory(const std::string& path, const std::string& extension,
+                               std::vector<FileSysUtilsDirectoryEntry>& entries);
+
+// Read-only, contiguous view of a file's contents.  Larger files are memory-mapped where the
+// platform supports it, small files are pulled in with a single read into an owned buffer.
+class FileSysUtilsMappedFile {
+   public:
+    FileSysUtilsMappedFile();
+    ~FileSysUtilsMappedFile();
+
+    // We don't want any copy constructors
+    FileSysUtilsMappedFile(const FileSysUtilsMappedFile&) = delete;
+    FileSysUtilsMappedFile& operator=(const FileSysUtilsMappedFile&) = delete;
+
+    // Open and map (or read) the file, releasing any previous contents first
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return _is_open; }
+    bool IsMapped() const { return nullptr != _mapping; }
+    // Never null once open, even for an empty file
+    const char* Data() const { return _data; }
+    size_t Size() const { return _size; }
+
+    // Files at or below this size are read rather than mapped
+    static const size_t kMapThreshold = 16 * 1024;
+
+   private:
+    bool _is_open;
+    const char* _data;
+    size_t _size;
+    void* _mapping;
+    std::vector<char> _buffer;
+};
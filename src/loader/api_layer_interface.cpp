@@ -19,9 +19,13 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <utility>
 
 #include "platform_utils.hpp"
+#include "loader_create_timings.hpp"
+#include "loader_environment.hpp"
 #include "manifest_file.hpp"
 #include "xr_generated_dispatch_table.h"
 #include "api_layer_interface.hpp"
@@ -30,14 +34,56 @@
 
 #define OPENXR_ENABLE_LAYERS_ENV_VAR "XR_ENABLE_API_LAYERS"
 
+// A layer library that has been opened and successfully negotiated with.  Kept in a cache, so that later instances
+// enabling the same layer reuse it instead of loading and negotiating again.
+struct NegotiatedApiLayer {
+    std::string layer_name;
+    std::string library_path;
+    uint32_t spec_version = 0;
+    uint32_t implementation_version = 0;
+    LoaderPlatformLibraryHandle layer_library = nullptr;
+    PFN_xrGetInstanceProcAddr get_instance_proc_addr = nullptr;
+    PFN_xrCreateApiLayerInstance create_api_layer_instance = nullptr;
+    std::vector<std::string> supported_extensions;
+
+    ~NegotiatedApiLayer() {
+        if (nullptr != layer_library) {
+            LoaderPlatformLibraryClose(layer_library);
+        }
+    }
+};
+
+// Entries stay cached while the runtime they were used with is loaded, see ReleaseUnusedApiLayers.
+struct NegotiatedApiLayerCache {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<NegotiatedApiLayer>> layers;
+};
+static NegotiatedApiLayerCache& GetNegotiatedApiLayerCache() {
+    static NegotiatedApiLayerCache negotiated_api_layer_cache;
+    return negotiated_api_layer_cache;
+}
+
+// Look a layer up by its name, library and versions, since a manifest changing any of those describes a different layer.
+static std::shared_ptr<NegotiatedApiLayer> FindNegotiatedApiLayer(ApiLayerManifestFile& manifest_file) {
+    XrApiLayerProperties layer_properties = manifest_file.GetApiLayerProperties();
+    std::string library_path = manifest_file.LibraryPath();
+    NegotiatedApiLayerCache& cache = GetNegotiatedApiLayerCache();
+    std::unique_lock<std::mutex> cache_lock(cache.mutex);
+    for (std::shared_ptr<NegotiatedApiLayer>& negotiated_layer : cache.layers) {
+        if (negotiated_layer->layer_name == manifest_file.LayerName() && negotiated_layer->library_path == library_path &&
+            negotiated_layer->spec_version == layer_properties.specVersion &&
+            negotiated_layer->implementation_version == layer_properties.implementationVersion) {
+            return negotiated_layer;
+        }
+    }
+    return nullptr;
+}
+
 // Add any layers defined in the loader layer environment variable.
 static void AddEnvironmentApiLayers(const std::string& openxr_command, std::vector<std::string>& enabled_layers) {
     try {
-        char* layer_environment_variable = PlatformUtilsGetEnv(OPENXR_ENABLE_LAYERS_ENV_VAR);
-        if (nullptr != layer_environment_variable) {
-            std::string layers = layer_environment_variable;
-            PlatformUtilsFreeEnv(layer_environment_variable);
-
+        std::string layers;
+        if (LoaderEnvironment::Get(OPENXR_ENABLE_LAYERS_ENV_VAR, layers)) {
             std::size_t last_found = 0;
             std::size_t found = layers.find_first_of(PATH_SEPARATOR);
             std::string cur_search;
@@ -62,25 +108,105 @@ static void AddEnvironmentApiLayers(const std::string& openxr_command, std::vect
     }
 }
 
+#if defined(XR_LOADER_WATCH_MANIFESTS)
+// Properties from the last API layer manifest scan, along with everything that could make them stale.
+struct ApiLayerPropertiesCache {
+    std::mutex mutex;
+    bool valid = false;
+    ManifestFileWatcher watcher;
+    std::vector<std::string> search_paths;
+    std::vector<std::pair<std::string, bool>> environment;
+    std::vector<XrApiLayerProperties> properties;
+};
+static ApiLayerPropertiesCache& GetApiLayerPropertiesCache() {
+    static ApiLayerPropertiesCache api_layer_properties_cache;
+    return api_layer_properties_cache;
+}
+#endif  // XR_LOADER_WATCH_MANIFESTS
+
+// Read the properties of every available API layer.  When manifest watching is enabled, the results of the
+// previous scan are reused as long as the search paths, the implicit layer environment variables and the
+// contents of the search directories are unchanged.
+static XrResult ReadAllApiLayerProperties(const std::string& openxr_command, std::vector<XrApiLayerProperties>& layer_properties) {
+    std::vector<std::unique_ptr<ApiLayerManifestFile>> manifest_files;
+    std::vector<std::string> environment_dependencies;
+
+#if defined(XR_LOADER_WATCH_MANIFESTS)
+    std::vector<std::string> search_paths;
+    XrResult result = ApiLayerManifestFile::GetSearchPaths(MANIFEST_TYPE_IMPLICIT_API_LAYER, search_paths);
+    if (XR_SUCCESS == result) {
+        result = ApiLayerManifestFile::GetSearchPaths(MANIFEST_TYPE_EXPLICIT_API_LAYER, search_paths);
+    }
+    if (XR_SUCCESS != result) {
+        return result;
+    }
+
+    ApiLayerPropertiesCache& cache = GetApiLayerPropertiesCache();
+    std::lock_guard<std::mutex> cache_lock(cache.mutex);
+    if (cache.valid && cache.search_paths == search_paths) {
+        bool environment_changed = false;
+        for (const auto& env_var : cache.environment) {
+            if (LoaderEnvironment::IsSet(env_var.first) != env_var.second) {
+                environment_changed = true;
+                break;
+            }
+        }
+        if (!environment_changed && !cache.watcher.HasChanged()) {
+            layer_properties = cache.properties;
+            return XR_SUCCESS;
+        }
+    }
+    cache.valid = false;
+
+    // Set up the watch before reading so nothing changing during the scan gets missed.
+    bool watching = cache.watcher.Watch(search_paths);
+#endif  // XR_LOADER_WATCH_MANIFESTS
+
+    // Find any implicit layers which we may need to report information for.
+    XrResult find_result =
+        ApiLayerManifestFile::FindManifestFiles(MANIFEST_TYPE_IMPLICIT_API_LAYER, manifest_files, &environment_dependencies);
+    if (XR_SUCCESS == find_result) {
+        // Find any explicit layers which we may need to report information for.
+        find_result = ApiLayerManifestFile::FindManifestFiles(MANIFEST_TYPE_EXPLICIT_API_LAYER, manifest_files, nullptr);
+    }
+    if (XR_SUCCESS != find_result) {
+        LoaderLogger::LogErrorMessage(openxr_command,
+                                      "ApiLayerInterface::GetApiLayerProperties - failed searching for API layer manifest files");
+        return find_result;
+    }
+
+    layer_properties.clear();
+    layer_properties.reserve(manifest_files.size());
+    for (auto& manifest_file : manifest_files) {
+        layer_properties.push_back(manifest_file->GetApiLayerProperties());
+    }
+
+#if defined(XR_LOADER_WATCH_MANIFESTS)
+    if (watching) {
+        cache.search_paths = std::move(search_paths);
+        cache.environment.clear();
+        for (const std::string& env_var : environment_dependencies) {
+            cache.environment.emplace_back(env_var, LoaderEnvironment::IsSet(env_var));
+        }
+        cache.properties = layer_properties;
+        cache.valid = true;
+    }
+#endif  // XR_LOADER_WATCH_MANIFESTS
+    return XR_SUCCESS;
+}
+
 XrResult ApiLayerInterface::GetApiLayerProperties(const std::string& openxr_command, uint32_t incoming_count,
                                                   uint32_t* outgoing_count, XrApiLayerProperties* api_layer_properties) {
     try {
-        std::vector<std::unique_ptr<ApiLayerManifestFile>> manifest_files;
+        std::vector<XrApiLayerProperties> layer_properties;
         uint32_t manifest_count = 0;
 
-        // Find any implicit layers which we may need to report information for.
-        XrResult result = ApiLayerManifestFile::FindManifestFiles(MANIFEST_TYPE_IMPLICIT_API_LAYER, manifest_files);
-        if (XR_SUCCESS == result) {
-            // Find any explicit layers which we may need to report information for.
-            result = ApiLayerManifestFile::FindManifestFiles(MANIFEST_TYPE_EXPLICIT_API_LAYER, manifest_files);
-        }
+        XrResult result = ReadAllApiLayerProperties(openxr_command, layer_properties);
         if (XR_SUCCESS != result) {
-            LoaderLogger::LogErrorMessage(
-                openxr_command, "ApiLayerInterface::GetApiLayerProperties - failed searching for API layer manifest files");
             return result;
         }
 
-        manifest_count = static_cast<uint32_t>(manifest_files.size());
+        manifest_count = static_cast<uint32_t>(layer_properties.size());
         if (0 == incoming_count) {
             *outgoing_count = manifest_count;
         } else if (nullptr != api_layer_properties) {
@@ -105,7 +231,7 @@ XrResult ApiLayerInterface::GetApiLayerProperties(const std::string& openxr_comm
                     properties_valid = false;
                 }
                 if (properties_valid) {
-                    api_layer_properties[prop] = manifest_files[prop]->GetApiLayerProperties();
+                    api_layer_properties[prop] = layer_properties[prop];
                 }
             }
             if (!properties_valid) {
@@ -263,7 +389,23 @@ XrResult ApiLayerInterface::LoadApiLayers(const std::string& openxr_command, uin
                 continue;
             }
 
-            LoaderPlatformLibraryHandle layer_library = LoaderPlatformLibraryOpen(manifest_file->LibraryPath());
+            std::shared_ptr<NegotiatedApiLayer> negotiated_layer = FindNegotiatedApiLayer(*manifest_file);
+            if (negotiated_layer != nullptr) {
+                std::string info_message = "ApiLayerInterface::LoadApiLayers reusing already negotiated layer ";
+                info_message += manifest_file->LayerName();
+                LoaderLogger::LogInfoMessage(openxr_command, info_message);
+                api_layer_interfaces.emplace_back(new ApiLayerInterface(negotiated_layer));
+                api_layer_interfaces.back()->SetInterceptedFunctions(*manifest_file);
+                any_loaded = true;
+                last_error = XR_SUCCESS;
+                continue;
+            }
+
+            LoaderPlatformLibraryHandle layer_library;
+            {
+                LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_LIBRARY_LOADING);
+                layer_library = LoaderPlatformLibraryOpen(manifest_file->LibraryPath());
+            }
             if (nullptr == layer_library) {
                 if (!any_loaded) {
                     last_error = XR_ERROR_FILE_ACCESS_ERROR;
@@ -299,7 +441,11 @@ XrResult ApiLayerInterface::LoadApiLayers(const std::string& openxr_command, uin
             api_layer_info.structVersion = XR_API_LAYER_INFO_STRUCT_VERSION;
             api_layer_info.structSize = sizeof(XrNegotiateApiLayerRequest);
 
-            XrResult res = negotiate(&loader_info, manifest_file->LayerName().c_str(), &api_layer_info);
+            XrResult res;
+            {
+                LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_NEGOTIATION);
+                res = negotiate(&loader_info, manifest_file->LayerName().c_str(), &api_layer_info);
+            }
             // If we supposedly succeeded, but got a nullptr for getInstanceProcAddr
             // then something still went wrong, so return with an error.
             if (XR_SUCCESS == res && nullptr == api_layer_info.getInstanceProcAddr) {
@@ -332,19 +478,33 @@ XrResult ApiLayerInterface::LoadApiLayers(const std::string& openxr_command, uin
             info_message += std::to_string(XR_VERSION_MINOR(api_layer_info.layerXrVersion));
             LoaderLogger::LogInfoMessage(openxr_command, info_message);
 
+            XrApiLayerProperties layer_properties = manifest_file->GetApiLayerProperties();
+            negotiated_layer = std::make_shared<NegotiatedApiLayer>();
+            negotiated_layer->layer_name = manifest_file->LayerName();
+            negotiated_layer->library_path = manifest_file->LibraryPath();
+            negotiated_layer->spec_version = layer_properties.specVersion;
+            negotiated_layer->implementation_version = layer_properties.implementationVersion;
+            negotiated_layer->layer_library = layer_library;
+            negotiated_layer->get_instance_proc_addr = api_layer_info.getInstanceProcAddr;
+            negotiated_layer->create_api_layer_instance = api_layer_info.createApiLayerInstance;
+
             // Grab the list of extensions this layer supports for easy filtering after the
             // xrCreateInstance call
-            std::vector<std::string> supported_extensions;
             std::vector<XrExtensionProperties> extension_properties;
             manifest_file->GetInstanceExtensionProperties(extension_properties);
             for (XrExtensionProperties& ext_prop : extension_properties) {
-                supported_extensions.push_back(ext_prop.extensionName);
+                negotiated_layer->supported_extensions.push_back(ext_prop.extensionName);
+            }
+
+            {
+                NegotiatedApiLayerCache& cache = GetNegotiatedApiLayerCache();
+                std::unique_lock<std::mutex> cache_lock(cache.mutex);
+                cache.layers.push_back(negotiated_layer);
             }
 
             // Add this runtime to the vector
-            api_layer_interfaces.emplace_back(new ApiLayerInterface(manifest_file->LayerName(), layer_library, supported_extensions,
-                                                                    api_layer_info.getInstanceProcAddr,
-                                                                    api_layer_info.createApiLayerInstance));
+            api_layer_interfaces.emplace_back(new ApiLayerInterface(negotiated_layer));
+            api_layer_interfaces.back()->SetInterceptedFunctions(*manifest_file);
 
             // If we load one, clear all errors.
             any_loaded = true;
@@ -379,32 +539,71 @@ XrResult ApiLayerInterface::LoadApiLayers(const std::string& openxr_command, uin
     return last_error;
 }
 
-ApiLayerInterface::ApiLayerInterface(std::string layer_name, LoaderPlatformLibraryHandle layer_library,
-                                     std::vector<std::string>& supported_extensions,
-                                     PFN_xrGetInstanceProcAddr get_instant_proc_addr,
-                                     PFN_xrCreateApiLayerInstance create_api_layer_instance)
-    : _layer_name(layer_name),
-      _layer_library(layer_library),
-      _get_instant_proc_addr(get_instant_proc_addr),
-      _create_api_layer_instance(create_api_layer_instance),
-      _supported_extensions(supported_extensions) {}
+void ApiLayerInterface::ReleaseUnusedApiLayers() {
+    std::vector<std::shared_ptr<NegotiatedApiLayer>> unused_layers;
+    NegotiatedApiLayerCache& cache = GetNegotiatedApiLayerCache();
+    std::unique_lock<std::mutex> cache_lock(cache.mutex);
+    for (auto layer_iter = cache.layers.begin(); layer_iter != cache.layers.end();) {
+        if (layer_iter->use_count() == 1) {
+            unused_layers.push_back(std::move(*layer_iter));
+            layer_iter = cache.layers.erase(layer_iter);
+        } else {
+            ++layer_iter;
+        }
+    }
+    cache_lock.unlock();
+
+    // Close the libraries without holding the lock
+    for (std::shared_ptr<NegotiatedApiLayer>& unused_layer : unused_layers) {
+        std::string info_message = "ApiLayerInterface releasing cached layer ";
+        info_message += unused_layer->layer_name;
+        LoaderLogger::LogInfoMessage("", info_message);
+    }
+    unused_layers.clear();
+}
+
+ApiLayerInterface::ApiLayerInterface(std::shared_ptr<NegotiatedApiLayer> negotiated_layer)
+    : _layer_name(negotiated_layer->layer_name),
+      _negotiated_layer(negotiated_layer),
+      _get_instant_proc_addr(negotiated_layer->get_instance_proc_addr),
+      _create_api_layer_instance(negotiated_layer->create_api_layer_instance),
+      _declares_intercepted_functions(false) {
+    for (const std::string& supported_extension : negotiated_layer->supported_extensions) {
+        _supported_extensions.Add(supported_extension);
+    }
+}
 
 ApiLayerInterface::~ApiLayerInterface() {
     std::string info_message = "ApiLayerInterface being destroyed for layer ";
     info_message += _layer_name;
     LoaderLogger::LogInfoMessage("", info_message);
-    LoaderPlatformLibraryClose(_layer_library);
+}
+
+void ApiLayerInterface::SetInterceptedFunctions(ApiLayerManifestFile& manifest_file) {
+    _declares_intercepted_functions = manifest_file.DeclaresInterceptedFunctions();
+    _intercepted_functions.clear();
+    for (const std::string& intercepted_function : manifest_file.InterceptedFunctions()) {
+        _intercepted_functions.insert(intercepted_function);
+    }
+}
+
+bool ApiLayerInterface::InterceptsFunction(const char* name) {
+    // Every layer saw the instance being created, so every layer sees it destroyed
+    if (!_declares_intercepted_functions || 0 == strcmp(name, "xrDestroyInstance")) {
+        return true;
+    }
+    bool found_func = false;
+    try {
+        found_func = _intercepted_functions.count(name) > 0;
+    } catch (...) {
+    }
+    return found_func;
 }
 
 bool ApiLayerInterface::SupportsExtension(const std::string& extension_name) {
     bool found_prop = false;
     try {
-        for (std::string supported_extension : _supported_extensions) {
-            if (supported_extension == extension_name) {
-                found_prop = true;
-                break;
-            }
-        }
+        found_prop = _supported_extensions.Contains(extension_name);
     } catch (...) {
     }
     return found_prop;
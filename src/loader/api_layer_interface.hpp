@@ -19,11 +19,18 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "loader_platform.hpp"
 #include "loader_interfaces.h"
+#include "loader_allocator.hpp"
+#include "loader_extension_set.hpp"
+
+struct NegotiatedApiLayer;
+class ApiLayerManifestFile;
 
 class ApiLayerInterface {
    public:
@@ -36,25 +43,34 @@ class ApiLayerInterface {
                                           XrApiLayerProperties* api_layer_properties);
     static XrResult GetInstanceExtensionProperties(const std::string& openxr_command, const char* layer_name,
                                                    std::vector<XrExtensionProperties>& extension_properties);
+    // Close any cached layer libraries no instance is using any more
+    static void ReleaseUnusedApiLayers();
 
-    ApiLayerInterface(std::string layer_name, LoaderPlatformLibraryHandle layer_library,
-                      std::vector<std::string>& supported_extensions, PFN_xrGetInstanceProcAddr get_instant_proc_addr,
-                      PFN_xrCreateApiLayerInstance create_api_layer_instance);
+    ApiLayerInterface(std::shared_ptr<NegotiatedApiLayer> negotiated_layer);
     virtual ~ApiLayerInterface();
 
     PFN_xrGetInstanceProcAddr GetInstanceProcAddrFuncPointer() { return _get_instant_proc_addr; }
     PFN_xrCreateApiLayerInstance GetCreateApiLayerInstanceFuncPointer() { return _create_api_layer_instance; }
 
     std::string LayerName() { return _layer_name; }
+    // Take the "intercepted_functions" list, if any, from the manifest the layer was enabled through
+    void SetInterceptedFunctions(ApiLayerManifestFile& manifest_file);
+    bool DeclaresInterceptedFunctions() { return _declares_intercepted_functions; }
+    // Whether the layer needs to be in the call path of a command
+    bool InterceptsFunction(const char* name);
 
     // Generated methods
-    void GenUpdateInstanceDispatchTable(XrInstance instance, std::unique_ptr<XrGeneratedDispatchTable>& table);
+    static void GenUpdateInstanceDispatchTable(XrInstance instance, PFN_xrGetInstanceProcAddr get_instance_proc_addr,
+                                               LoaderUniquePtr<XrGeneratedDispatchTable>& table);
     bool SupportsExtension(const std::string& extension_name);
 
    private:
     std::string _layer_name;
-    LoaderPlatformLibraryHandle _layer_library;
+    // Owns the layer library, which may be shared with the layer interfaces of other instances
+    std::shared_ptr<NegotiatedApiLayer> _negotiated_layer;
     PFN_xrGetInstanceProcAddr _get_instant_proc_addr;
     PFN_xrCreateApiLayerInstance _create_api_layer_instance;
-    std::vector<std::string> _supported_extensions;
+    ExtensionSet _supported_extensions;
+    bool _declares_intercepted_functions;
+    std::unordered_set<std::string> _intercepted_functions;
 };
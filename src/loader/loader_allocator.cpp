@@ -0,0 +1,177 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "loader_allocator.hpp"
+
+// Placed in front of every block, padded so the block keeps the alignment of the allocation
+union LoaderAllocationHeader {
+    struct {
+        PFN_xrLoaderFreeFunction pfn_free;
+        void* user_data;
+        size_t size;
+        LoaderMemoryCategory category;
+    } block;
+    std::max_align_t alignment;
+};
+
+// Zero initialized before any code runs, so allocations made by other static initializers are counted
+static std::atomic<uint64_t> g_footprint_bytes[LOADER_MEMORY_CATEGORY_COUNT];
+
+static const char* const g_memory_category_names[LOADER_MEMORY_CATEGORY_COUNT] = {
+    "instance", "dispatch_table", "handle_map", "manifest", "object_name",
+};
+
+// Callbacks as they were when an instance acquired them, never changed once published
+struct LoaderAllocationSource {
+    PFN_xrLoaderAllocationFunction pfn_allocation;
+    PFN_xrLoaderFreeFunction pfn_free;
+    void* user_data;
+};
+
+// The allocation source shared by every live instance, and how many instances are using it.  Allocate only reads
+// the published source, the mutex is only taken to acquire and release it.
+struct LoaderAllocationState {
+    std::mutex mutex;
+    uint32_t instance_count = 0;
+    // nullptr while allocating from the global heap
+    std::atomic<const LoaderAllocationSource*> source{nullptr};
+    // Every source published so far.  Allocate may still be reading one after it has been released, so they are kept
+    // until the loader is unloaded, and reused when the same callbacks come back.
+    std::vector<std::unique_ptr<LoaderAllocationSource>> sources;
+};
+
+static LoaderAllocationState& GetAllocationState() {
+    static LoaderAllocationState allocation_state;
+    return allocation_state;
+}
+
+static bool SameCallbacks(const LoaderAllocationSource& source, const XrLoaderAllocationCallbacks& callbacks) {
+    return source.pfn_allocation == callbacks.pfnAllocation && source.pfn_free == callbacks.pfnFree &&
+           source.user_data == callbacks.userData;
+}
+
+void* LoaderAllocation::Allocate(size_t size, LoaderMemoryCategory category) {
+    const LoaderAllocationSource* source = GetAllocationState().source.load(std::memory_order_acquire);
+
+    LoaderAllocationHeader* header;
+    if (nullptr != source) {
+        header = static_cast<LoaderAllocationHeader*>(
+            source->pfn_allocation(source->user_data, sizeof(LoaderAllocationHeader) + size, alignof(LoaderAllocationHeader)));
+        if (nullptr == header) {
+            throw std::bad_alloc();
+        }
+        header->block.pfn_free = source->pfn_free;
+        header->block.user_data = source->user_data;
+    } else {
+        header = static_cast<LoaderAllocationHeader*>(::operator new(sizeof(LoaderAllocationHeader) + size));
+        header->block.pfn_free = nullptr;
+        header->block.user_data = nullptr;
+    }
+    header->block.size = sizeof(LoaderAllocationHeader) + size;
+    header->block.category = category;
+    AddFootprint(category, header->block.size);
+    return header + 1;
+}
+
+void LoaderAllocation::Free(void* memory) {
+    if (nullptr == memory) {
+        return;
+    }
+    LoaderAllocationHeader* header = static_cast<LoaderAllocationHeader*>(memory) - 1;
+    RemoveFootprint(header->block.category, header->block.size);
+    if (nullptr != header->block.pfn_free) {
+        header->block.pfn_free(header->block.user_data, header);
+    } else {
+        ::operator delete(header);
+    }
+}
+
+bool LoaderAllocation::AcquireCallbacks(const XrLoaderAllocationCallbacks* callbacks) {
+    LoaderAllocationState& state = GetAllocationState();
+    std::unique_lock<std::mutex> state_lock(state.mutex);
+    const LoaderAllocationSource* source = state.source.load(std::memory_order_relaxed);
+    if (0 == state.instance_count) {
+        source = nullptr;
+        if (nullptr != callbacks) {
+            for (const auto& published : state.sources) {
+                if (SameCallbacks(*published, *callbacks)) {
+                    source = published.get();
+                    break;
+                }
+            }
+            if (nullptr == source) {
+                state.sources.emplace_back(
+                    new LoaderAllocationSource{callbacks->pfnAllocation, callbacks->pfnFree, callbacks->userData});
+                source = state.sources.back().get();
+            }
+        }
+        state.source.store(source, std::memory_order_release);
+    } else if ((nullptr == source) != (nullptr == callbacks) || (nullptr != source && !SameCallbacks(*source, *callbacks))) {
+        return false;
+    }
+    state.instance_count++;
+    return true;
+}
+
+void LoaderAllocation::ReleaseCallbacks() {
+    LoaderAllocationState& state = GetAllocationState();
+    std::unique_lock<std::mutex> state_lock(state.mutex);
+    if (state.instance_count > 0 && 0 == --state.instance_count) {
+        state.source.store(nullptr, std::memory_order_release);
+    }
+}
+
+void LoaderAllocation::AddFootprint(LoaderMemoryCategory category, size_t bytes) {
+    g_footprint_bytes[category].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void LoaderAllocation::RemoveFootprint(LoaderMemoryCategory category, size_t bytes) {
+    g_footprint_bytes[category].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void LoaderAllocation::GetFootprint(XrLoaderMemoryFootprint& footprint) {
+    footprint.instanceBytes = g_footprint_bytes[LOADER_MEMORY_CATEGORY_INSTANCE].load(std::memory_order_relaxed);
+    footprint.dispatchTableBytes = g_footprint_bytes[LOADER_MEMORY_CATEGORY_DISPATCH_TABLE].load(std::memory_order_relaxed);
+    footprint.handleMapBytes = g_footprint_bytes[LOADER_MEMORY_CATEGORY_HANDLE_MAP].load(std::memory_order_relaxed);
+    footprint.manifestBytes = g_footprint_bytes[LOADER_MEMORY_CATEGORY_MANIFEST].load(std::memory_order_relaxed);
+    footprint.objectNameBytes = g_footprint_bytes[LOADER_MEMORY_CATEGORY_OBJECT_NAME].load(std::memory_order_relaxed);
+    footprint.totalBytes = footprint.instanceBytes + footprint.dispatchTableBytes + footprint.handleMapBytes +
+                           footprint.manifestBytes + footprint.objectNameBytes;
+}
+
+std::string LoaderAllocation::FootprintToString() {
+    uint64_t total_bytes = 0;
+    std::string category_bytes;
+    for (uint32_t category = 0; category < LOADER_MEMORY_CATEGORY_COUNT; ++category) {
+        uint64_t bytes = g_footprint_bytes[category].load(std::memory_order_relaxed);
+        total_bytes += bytes;
+        category_bytes += " ";
+        category_bytes += g_memory_category_names[category];
+        category_bytes += "_bytes=";
+        category_bytes += std::to_string(bytes);
+    }
+    return "total_bytes=" + std::to_string(total_bytes) + category_bytes;
+}
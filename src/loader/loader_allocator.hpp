@@ -0,0 +1,140 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_loader.h>
+
+// What the memory the loader keeps around is used for
+enum LoaderMemoryCategory {
+    LOADER_MEMORY_CATEGORY_INSTANCE = 0,
+    LOADER_MEMORY_CATEGORY_DISPATCH_TABLE,
+    LOADER_MEMORY_CATEGORY_HANDLE_MAP,
+    LOADER_MEMORY_CATEGORY_MANIFEST,
+    LOADER_MEMORY_CATEGORY_OBJECT_NAME,
+    LOADER_MEMORY_CATEGORY_COUNT,
+};
+
+// LoaderAllocation class -
+// Where the loader's own long lived allocations come from: the XrLoaderAllocationCallbacks an
+// application chained to XrInstanceCreateInfo::next, or the global heap.  The handle maps are
+// shared by all instances, so every live instance has to agree on the one source.  Since all of
+// these allocations are freed by the time the last instance is destroyed, the callbacks are never
+// called once no instance is using them.
+// Also keeps count of the bytes resident in each LoaderMemoryCategory.
+class LoaderAllocation {
+   public:
+    // Throws std::bad_alloc on failure, like operator new
+    static void* Allocate(size_t size, LoaderMemoryCategory category);
+    static void Free(void* memory);
+
+    // Take the allocation source of a new instance, its callbacks or the global heap when it has none.
+    // Fails if other instances are live and using a different source.
+    static bool AcquireCallbacks(const XrLoaderAllocationCallbacks* callbacks);
+    // Once for every successful AcquireCallbacks, after the instance has freed what it allocated
+    static void ReleaseCallbacks();
+
+    // For memory that isn't allocated through here, but still counts towards the footprint
+    static void AddFootprint(LoaderMemoryCategory category, size_t bytes);
+    static void RemoveFootprint(LoaderMemoryCategory category, size_t bytes);
+    static void GetFootprint(XrLoaderMemoryFootprint& footprint);
+    // One line of "name=bytes" pairs for the log
+    static std::string FootprintToString();
+};
+
+// LoaderMemoryFootprint class -
+// Bytes an object keeps outside of LoaderAllocation, counted towards a category for as long as
+// the object lives.  Copies count again.
+class LoaderMemoryFootprint {
+   public:
+    explicit LoaderMemoryFootprint(LoaderMemoryCategory category) : _category(category), _bytes(0) {}
+    LoaderMemoryFootprint(const LoaderMemoryFootprint& other) : _category(other._category), _bytes(0) { Set(other._bytes); }
+    ~LoaderMemoryFootprint() { Set(0); }
+    LoaderMemoryFootprint& operator=(const LoaderMemoryFootprint&) = delete;
+
+    void Set(size_t bytes) {
+        LoaderAllocation::AddFootprint(_category, bytes);
+        LoaderAllocation::RemoveFootprint(_category, _bytes);
+        _bytes = bytes;
+    }
+
+   private:
+    LoaderMemoryCategory _category;
+    size_t _bytes;
+};
+
+// Standard allocator over LoaderAllocation, for the loader's containers
+template <typename T, LoaderMemoryCategory category>
+class LoaderAllocator {
+   public:
+    using value_type = T;
+    template <typename U>
+    struct rebind {
+        using other = LoaderAllocator<U, category>;
+    };
+
+    LoaderAllocator() = default;
+    template <typename U>
+    LoaderAllocator(const LoaderAllocator<U, category>&) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(LoaderAllocation::Allocate(count * sizeof(T), category)); }
+    void deallocate(T* memory, size_t) { LoaderAllocation::Free(memory); }
+};
+
+template <typename T, typename U, LoaderMemoryCategory category>
+bool operator==(const LoaderAllocator<T, category>&, const LoaderAllocator<U, category>&) {
+    return true;
+}
+template <typename T, typename U, LoaderMemoryCategory category>
+bool operator!=(const LoaderAllocator<T, category>&, const LoaderAllocator<U, category>&) {
+    return false;
+}
+
+template <typename Key, typename Value>
+using LoaderUnorderedMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>,
+                                              LoaderAllocator<std::pair<const Key, Value>, LOADER_MEMORY_CATEGORY_HANDLE_MAP>>;
+
+template <typename T>
+struct LoaderDelete {
+    void operator()(T* object) const {
+        object->~T();
+        LoaderAllocation::Free(object);
+    }
+};
+
+template <typename T>
+using LoaderUniquePtr = std::unique_ptr<T, LoaderDelete<T>>;
+
+template <typename T, typename... Args>
+LoaderUniquePtr<T> LoaderMakeUnique(LoaderMemoryCategory category, Args&&... args) {
+    void* memory = LoaderAllocation::Allocate(sizeof(T), category);
+    try {
+        return LoaderUniquePtr<T>(new (memory) T(std::forward<Args>(args)...));
+    } catch (...) {
+        LoaderAllocation::Free(memory);
+        throw;
+    }
+}
@@ -29,16 +29,21 @@
 #include "xr_dependencies.h"
 #include <openxr/openxr.h>
 #include <openxr/openxr_platform.h>
+#include <openxr/openxr_loader.h>
 
 #include "loader_logger.hpp"
+#include "loader_create_timings.hpp"
+#include "loader_environment.hpp"
+#include "loader_extension_properties.hpp"
 #include "loader_instance.hpp"
+#include "loader_preload.hpp"
 #include "xr_generated_loader.cpp"
 
 // Flag to cause the one time to init to only occur one time.
 std::once_flag g_one_time_init_flag;
 
-// Global lock to prevent reading JSON manifest files at the same time.
-static std::mutex g_loader_json_mutex;
+// Global lock to prevent reading JSON manifest files at the same time, see loader_preload.hpp.
+std::mutex g_loader_json_mutex;
 
 // Global lock to prevent simultaneous instance creation/destruction
 static std::mutex g_loader_instance_mutex;
@@ -57,6 +62,63 @@ inline bool IsMissingNullTerminator(const char (&str)[max_length]) {
 
 extern "C" {
 
+// ---- Loader-specific entry points (declared in openxr_loader.h)
+
+LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrLoaderPreload(void) {
+    try {
+        LoaderLogger::LogVerboseMessage("xrLoaderPreload", "Entering loader trampoline");
+        return LoaderPreload::Start("xrLoaderPreload");
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("xrLoaderPreload", "Unknown error occurred");
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+}
+
+LOADER_EXPORT XRAPI_ATTR void XRAPI_CALL xrLoaderRefreshEnvironment(void) {
+    try {
+        LoaderLogger::LogVerboseMessage("xrLoaderRefreshEnvironment", "Entering loader trampoline");
+        LoaderEnvironment::Refresh();
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("xrLoaderRefreshEnvironment", "Unknown error occurred");
+    }
+}
+
+LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrLoaderGetInstanceCreateTimings(XrInstance instance,
+                                                                              XrLoaderInstanceCreateTimings *timings) {
+    try {
+        LoaderLogger::LogVerboseMessage("xrLoaderGetInstanceCreateTimings", "Entering loader trampoline");
+        LoaderInstance *const loader_instance = TryLookupLoaderInstance(instance);
+        if (loader_instance == nullptr) {
+            LoaderLogger::LogErrorMessage("xrLoaderGetInstanceCreateTimings", "invalid instance");
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        if (nullptr == timings) {
+            LoaderLogger::LogErrorMessage("xrLoaderGetInstanceCreateTimings", "timings must be non-NULL");
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        loader_instance->CreateTimings().GetTimings(*timings);
+        return XR_SUCCESS;
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("xrLoaderGetInstanceCreateTimings", "Unknown error occurred");
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+}
+
+LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrLoaderGetMemoryFootprint(XrLoaderMemoryFootprint *footprint) {
+    try {
+        LoaderLogger::LogVerboseMessage("xrLoaderGetMemoryFootprint", "Entering loader trampoline");
+        if (nullptr == footprint) {
+            LoaderLogger::LogErrorMessage("xrLoaderGetMemoryFootprint", "footprint must be non-NULL");
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        LoaderAllocation::GetFootprint(*footprint);
+        return XR_SUCCESS;
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("xrLoaderGetMemoryFootprint", "Unknown error occurred");
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+}
+
 // ---- Core 0.1 manual loader trampoline functions
 
 LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateApiLayerProperties(uint32_t propertyCapacityInput,
@@ -108,11 +170,9 @@ LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateInstanceExtensionPropert
                                                                        extension_properties);
             if (XR_SUCCESS == result && !just_layer_properties) {
                 // If not specific to a layer, get the runtime extension properties
-                result = RuntimeInterface::LoadRuntime("xrEnumerateInstanceExtensionProperties");
-                if (XR_SUCCESS == result) {
-                    RuntimeInterface::GetRuntime().GetInstanceExtensionProperties(extension_properties);
-                    RuntimeInterface::UnloadRuntime("xrEnumerateInstanceExtensionProperties");
-                } else {
+                result = RuntimeInterface::EnumerateInstanceExtensionProperties("xrEnumerateInstanceExtensionProperties",
+                                                                                extension_properties);
+                if (XR_SUCCESS != result) {
                     LoaderLogger::LogErrorMessage("xrEnumerateInstanceExtensionProperties",
                                                   "Failed to find default runtime with RuntimeInterface::LoadRuntime()");
                 }
@@ -127,24 +187,8 @@ LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateInstanceExtensionPropert
         // If this is not in reference to a specific layer, then add the loader-specific extension properties as well.
         // These are extensions that the loader directly supports.
         if (!just_layer_properties) {
-            auto loader_extension_props = LoaderInstance::LoaderSpecificExtensions();
-            for (XrExtensionProperties &loader_prop : loader_extension_props) {
-                bool found_prop = false;
-                for (XrExtensionProperties &existing_prop : extension_properties) {
-                    if (0 == strcmp(existing_prop.extensionName, loader_prop.extensionName)) {
-                        found_prop = true;
-                        // Use the loader version if it is newer
-                        if (existing_prop.specVersion < loader_prop.specVersion) {
-                            existing_prop.specVersion = loader_prop.specVersion;
-                        }
-                        break;
-                    }
-                }
-                // Only add extensions not supported by the loader
-                if (!found_prop) {
-                    extension_properties.push_back(loader_prop);
-                }
-            }
+            ExtensionPropertiesMerge merge(extension_properties);
+            merge.Add(LoaderInstance::LoaderSpecificExtensions());
         }
 
         uint32_t num_extension_properties = static_cast<uint32_t>(extension_properties.size());
@@ -197,6 +241,44 @@ LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateInstanceExtensionPropert
     }
 }
 
+// Find the loader allocation callbacks in the XrInstanceCreateInfo 'next' chain, if there are any.
+static const XrLoaderAllocationCallbacks *FindAllocationCallbacks(const XrInstanceCreateInfo *info) {
+    const XrBaseInStructure *next_header = reinterpret_cast<const XrBaseInStructure *>(info->next);
+    while (next_header != nullptr) {
+        if (next_header->type == XR_TYPE_LOADER_ALLOCATION_CALLBACKS) {
+            return reinterpret_cast<const XrLoaderAllocationCallbacks *>(next_header);
+        }
+        next_header = reinterpret_cast<const XrBaseInStructure *>(next_header->next);
+    }
+    return nullptr;
+}
+
+// The allocation callbacks are the loader's alone, so the API layers and the runtime get a 'next' chain without them.  The
+// structures in front of them are copied to leave them out, which limits those to the debug utils messenger create info,
+// the only other structure the loader knows.
+static bool RemoveAllocationCallbacks(const XrInstanceCreateInfo *info, const XrLoaderAllocationCallbacks *allocation_callbacks,
+                                      XrInstanceCreateInfo &down_info,
+                                      std::vector<XrDebugUtilsMessengerCreateInfoEXT> &copied_structures) {
+    down_info = *info;
+    if (nullptr == allocation_callbacks) {
+        return true;
+    }
+    const XrBaseInStructure *callbacks_header = reinterpret_cast<const XrBaseInStructure *>(allocation_callbacks);
+    for (const XrBaseInStructure *next_header = reinterpret_cast<const XrBaseInStructure *>(info->next);
+         next_header != callbacks_header; next_header = next_header->next) {
+        if (next_header->type != XR_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT) {
+            return false;
+        }
+        copied_structures.push_back(*reinterpret_cast<const XrDebugUtilsMessengerCreateInfoEXT *>(next_header));
+    }
+    down_info.next = allocation_callbacks->next;
+    for (auto copied = copied_structures.rbegin(); copied != copied_structures.rend(); ++copied) {
+        copied->next = down_info.next;
+        down_info.next = &*copied;
+    }
+    return true;
+}
+
 LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrCreateInstance(const XrInstanceCreateInfo *info, XrInstance *instance) {
     bool runtime_loaded = false;
 
@@ -229,9 +311,31 @@ LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrCreateInstance(const XrInstanceCr
             LoaderLogger::LogErrorMessage("xrCreateInstance", "VUID-xrCreateInstance-instance-parameter: must be non-NULL");
             return XR_ERROR_HANDLE_INVALID;
         }
+        const XrLoaderAllocationCallbacks *allocation_callbacks = FindAllocationCallbacks(info);
+        if (nullptr != allocation_callbacks &&
+            (nullptr == allocation_callbacks->pfnAllocation || nullptr == allocation_callbacks->pfnFree)) {
+            LoaderLogger::LogErrorMessage("xrCreateInstance",
+                                          "XrLoaderAllocationCallbacks in \'next\' chain must have non-NULL function pointers");
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        XrInstanceCreateInfo down_info = {};
+        std::vector<XrDebugUtilsMessengerCreateInfoEXT> copied_structures;
+        if (!RemoveAllocationCallbacks(info, allocation_callbacks, down_info, copied_structures)) {
+            LoaderLogger::LogErrorMessage("xrCreateInstance",
+                                          "XrLoaderAllocationCallbacks in \'next\' chain may only follow "
+                                          "XrDebugUtilsMessengerCreateInfoEXT structures");
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
 
         std::vector<std::unique_ptr<ApiLayerInterface>> api_layer_interfaces;
 
+        // Time each phase of the creation from here on, this thread's work only.
+        LoaderCreateTimings create_timings;
+        create_timings.Begin();
+
+        // Anything a preload is still finding or opening is about to be needed here.
+        LoaderPreload::Join();
+
         // Make sure only one thread is attempting to read the JSON files and use the instance.
         XrResult result;
         {
@@ -250,6 +354,8 @@ LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrCreateInstance(const XrInstanceCr
                 }
             }
         }
+        // Runtime and layers now hold their own references, the preloaded ones are no longer needed.
+        LoaderPreload::Release("xrCreateInstance");
 
         if (XR_SUCCESS != result) {
             if (runtime_loaded) {
@@ -262,7 +368,18 @@ LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrCreateInstance(const XrInstanceCr
 
         // Create the loader instance (only send down first runtime interface)
         XrInstance created_instance = XR_NULL_HANDLE;
-        result = LoaderInstance::CreateInstance(api_layer_interfaces, info, &created_instance);
+        // The loader instance, and whatever it keeps around from here on, come from the application's callbacks
+        if (!LoaderAllocation::AcquireCallbacks(allocation_callbacks)) {
+            LoaderLogger::LogErrorMessage("xrCreateInstance",
+                                          "XrLoaderAllocationCallbacks must be the same for all instances alive at once");
+            instance_lock.unlock();
+            RuntimeInterface::UnloadRuntime("xrCreateInstance");
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        result = LoaderInstance::CreateInstance(api_layer_interfaces, &down_info, &created_instance);
+        if (XR_SUCCESS != result) {
+            LoaderAllocation::ReleaseCallbacks();
+        }
 
         if (XR_SUCCESS == result) {
             *instance = created_instance;
@@ -290,6 +407,13 @@ LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrCreateInstance(const XrInstanceCr
                 }
                 next_header = reinterpret_cast<const XrBaseInStructure *>(next_header->next);
             }
+
+            create_timings.End();
+            loader_instance->SetCreateTimings(create_timings);
+            std::string info_message = "xrCreateInstance phase timings: ";
+            info_message += create_timings.ToString();
+            LoaderLogger::LogInfoMessage("xrCreateInstance", info_message);
+            LoaderLogger::LogInfoMessage("xrCreateInstance", "Loader memory footprint: " + LoaderAllocation::FootprintToString());
         }
 
         LoaderLogger::LogVerboseMessage("xrCreateInstance", "Completed loader trampoline");
@@ -323,7 +447,7 @@ LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrDestroyInstance(XrInstance instan
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        const std::unique_ptr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
+        const LoaderUniquePtr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
 
         // If we allocated a default debug utils messenger, free it
         XrDebugUtilsMessengerEXT messenger = loader_instance->DefaultDebugUtilsMessenger();
@@ -342,6 +466,8 @@ LOADER_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrDestroyInstance(XrInstance instan
         // Lock the instance create/destroy mutex
         std::unique_lock<std::mutex> loader_instance_lock(g_loader_instance_mutex);
         delete loader_instance;
+        LoaderAllocation::ReleaseCallbacks();
+        LoaderLogger::LogInfoMessage("xrDestroyInstance", "Loader memory footprint: " + LoaderAllocation::FootprintToString());
         LoaderLogger::LogVerboseMessage("xrDestroyInstance", "Completed loader trampoline");
     } catch (...) {
         LoaderLogger::LogErrorMessage("xrDestroyInstance", "Unknown error occurred");
@@ -426,7 +552,11 @@ XRAPI_ATTR XrResult XRAPI_CALL LoaderXrTermCreateInstance(const XrInstanceCreate
                                       "VUID-xrCreateInstance-info-parameter: something wrong with XrInstanceCreateInfo contents");
         return XR_ERROR_VALIDATION_FAILURE;
     }
-    XrResult result = RuntimeInterface::GetRuntime().CreateInstance(info, instance);
+    XrResult result;
+    {
+        LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_RUNTIME_CREATE_INSTANCE);
+        result = RuntimeInterface::GetRuntime().CreateInstance(info, instance);
+    }
     loader_instance->SetRuntimeInstance(*instance);
     LoaderLogger::LogVerboseMessage("xrCreateInstance", "Completed loader terminator");
     return result;
@@ -460,7 +590,7 @@ XRAPI_ATTR XrResult XRAPI_CALL xrCreateDebugUtilsMessengerEXT(XrInstance instanc
             loader_instance = g_instance_map[instance];
         }
 
-        if (!loader_instance->ExtensionIsEnabled(XR_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+        if (!loader_instance->ExtensionIsEnabled(LOADER_EXTENSION_ID_XR_EXT_debug_utils)) {
             std::string error_str = "The ";
             error_str += XR_EXT_DEBUG_UTILS_EXTENSION_NAME;
             error_str += " extension has not been enabled prior to calling xrCreateDebugUtilsMessengerEXT";
@@ -469,7 +599,7 @@ XRAPI_ATTR XrResult XRAPI_CALL xrCreateDebugUtilsMessengerEXT(XrInstance instanc
             return XR_ERROR_FUNCTION_UNSUPPORTED;
         }
 
-        const std::unique_ptr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
+        const LoaderUniquePtr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
         XrResult result = XR_SUCCESS;
         result = dispatch_table->CreateDebugUtilsMessengerEXT(instance, createInfo, messenger);
         if (XR_SUCCESS == result && nullptr != messenger) {
@@ -513,7 +643,7 @@ XRAPI_ATTR XrResult XRAPI_CALL xrDestroyDebugUtilsMessengerEXT(XrDebugUtilsMesse
             loader_instance = g_debugutilsmessengerext_map[messenger];
         }
 
-        if (!loader_instance->ExtensionIsEnabled(XR_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+        if (!loader_instance->ExtensionIsEnabled(LOADER_EXTENSION_ID_XR_EXT_debug_utils)) {
             std::string error_str = "The ";
             error_str += XR_EXT_DEBUG_UTILS_EXTENSION_NAME;
             error_str += " extension has not been enabled prior to calling xrDestroyDebugUtilsMessengerEXT";
@@ -522,7 +652,7 @@ XRAPI_ATTR XrResult XRAPI_CALL xrDestroyDebugUtilsMessengerEXT(XrDebugUtilsMesse
             return XR_ERROR_FUNCTION_UNSUPPORTED;
         }
 
-        const std::unique_ptr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
+        const LoaderUniquePtr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
         XrResult result = dispatch_table->DestroyDebugUtilsMessengerEXT(messenger);
         LoaderLogger::LogVerboseMessage("xrDestroyDebugUtilsMessengerEXT", "Completed loader trampoline");
         return result;
@@ -672,7 +802,7 @@ XRAPI_ATTR XrResult XRAPI_CALL xrSessionBeginDebugUtilsLabelRegionEXT(XrSession
                                                     loader_objects);
             return XR_ERROR_HANDLE_INVALID;
         }
-        if (!loader_instance->ExtensionIsEnabled(XR_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+        if (!loader_instance->ExtensionIsEnabled(LOADER_EXTENSION_ID_XR_EXT_debug_utils)) {
             LoaderLogger::LogValidationErrorMessage("TBD", "xrSessionBeginDebugUtilsLabelRegionEXT",
                                                     "Extension entrypoint called without enabling appropriate extension",
                                                     loader_objects);
@@ -685,7 +815,7 @@ XRAPI_ATTR XrResult XRAPI_CALL xrSessionBeginDebugUtilsLabelRegionEXT(XrSession
         }
 
         LoaderLogger::GetInstance().BeginLabelRegion(session, labelInfo);
-        const std::unique_ptr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
+        const LoaderUniquePtr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
         if (nullptr != dispatch_table->SessionBeginDebugUtilsLabelRegionEXT) {
             return dispatch_table->SessionBeginDebugUtilsLabelRegionEXT(session, labelInfo);
         }
@@ -715,11 +845,11 @@ XRAPI_ATTR XrResult XRAPI_CALL xrSessionEndDebugUtilsLabelRegionEXT(XrSession se
                                                     "xrSessionEndDebugUtilsLabelRegionEXT", "session is not a valid XrSession",
                                                     loader_objects);
             return XR_ERROR_HANDLE_INVALID;
-        } else if (!loader_instance->ExtensionIsEnabled(XR_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+        } else if (!loader_instance->ExtensionIsEnabled(LOADER_EXTENSION_ID_XR_EXT_debug_utils)) {
             return XR_ERROR_FUNCTION_UNSUPPORTED;
         }
         LoaderLogger::GetInstance().EndLabelRegion(session);
-        const std::unique_ptr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
+        const LoaderUniquePtr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
         if (nullptr != dispatch_table->SessionBeginDebugUtilsLabelRegionEXT) {
             return dispatch_table->SessionEndDebugUtilsLabelRegionEXT(session);
         }
@@ -750,7 +880,7 @@ XRAPI_ATTR XrResult XRAPI_CALL xrSessionInsertDebugUtilsLabelEXT(XrSession sessi
                                                     loader_objects);
             return XR_ERROR_HANDLE_INVALID;
         }
-        if (!loader_instance->ExtensionIsEnabled(XR_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+        if (!loader_instance->ExtensionIsEnabled(LOADER_EXTENSION_ID_XR_EXT_debug_utils)) {
             LoaderLogger::LogValidationErrorMessage("TBD", "xrSessionInsertDebugUtilsLabelEXT",
                                                     "Extension entrypoint called without enabling appropriate extension",
                                                     loader_objects);
@@ -763,7 +893,7 @@ XRAPI_ATTR XrResult XRAPI_CALL xrSessionInsertDebugUtilsLabelEXT(XrSession sessi
         }
 
         LoaderLogger::GetInstance().InsertLabel(session, labelInfo);
-        const std::unique_ptr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
+        const LoaderUniquePtr<XrGeneratedDispatchTable> &dispatch_table = loader_instance->DispatchTable();
         if (nullptr != dispatch_table->SessionInsertDebugUtilsLabelEXT) {
             return dispatch_table->SessionInsertDebugUtilsLabelEXT(session, labelInfo);
         }
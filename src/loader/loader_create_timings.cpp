@@ -0,0 +1,96 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "loader_create_timings.hpp"
+
+static thread_local LoaderCreateTimings* g_active_create_timings = nullptr;
+
+static const char* const g_create_phase_names[LOADER_CREATE_PHASE_COUNT] = {
+    "manifest_discovery",        "manifest_parsing",        "library_loading", "negotiation",
+    "api_layer_create_instance", "runtime_create_instance", "dispatch_table",
+};
+
+static uint64_t ElapsedNanoseconds(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+LoaderCreateTimings::LoaderCreateTimings() : _current_phase(LOADER_CREATE_PHASE_NONE), _total_ns(0), _phase_ns() {}
+
+void LoaderCreateTimings::Begin() {
+    _begin = _switch = std::chrono::steady_clock::now();
+    _current_phase = LOADER_CREATE_PHASE_NONE;
+    g_active_create_timings = this;
+}
+
+void LoaderCreateTimings::End() {
+    if (g_active_create_timings == this) {
+        SwitchPhase(LOADER_CREATE_PHASE_NONE);
+        _total_ns = ElapsedNanoseconds(_begin, _switch);
+        g_active_create_timings = nullptr;
+    }
+}
+
+void LoaderCreateTimings::SwitchPhase(LoaderCreatePhase phase) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (_current_phase != LOADER_CREATE_PHASE_NONE) {
+        _phase_ns[_current_phase] += ElapsedNanoseconds(_switch, now);
+    }
+    _current_phase = phase;
+    _switch = now;
+}
+
+void LoaderCreateTimings::GetTimings(XrLoaderInstanceCreateTimings& timings) const {
+    timings.totalNs = _total_ns;
+    timings.manifestDiscoveryNs = _phase_ns[LOADER_CREATE_PHASE_MANIFEST_DISCOVERY];
+    timings.manifestParsingNs = _phase_ns[LOADER_CREATE_PHASE_MANIFEST_PARSING];
+    timings.libraryLoadingNs = _phase_ns[LOADER_CREATE_PHASE_LIBRARY_LOADING];
+    timings.negotiationNs = _phase_ns[LOADER_CREATE_PHASE_NEGOTIATION];
+    timings.apiLayerCreateInstanceNs = _phase_ns[LOADER_CREATE_PHASE_API_LAYER_CREATE_INSTANCE];
+    timings.runtimeCreateInstanceNs = _phase_ns[LOADER_CREATE_PHASE_RUNTIME_CREATE_INSTANCE];
+    timings.dispatchTableNs = _phase_ns[LOADER_CREATE_PHASE_DISPATCH_TABLE];
+}
+
+std::string LoaderCreateTimings::ToString() const {
+    std::string timings = "total_ns=";
+    timings += std::to_string(_total_ns);
+    for (uint32_t phase = 0; phase < LOADER_CREATE_PHASE_COUNT; ++phase) {
+        timings += " ";
+        timings += g_create_phase_names[phase];
+        timings += "_ns=";
+        timings += std::to_string(_phase_ns[phase]);
+    }
+    return timings;
+}
+
+LoaderCreatePhaseTimer::LoaderCreatePhaseTimer(LoaderCreatePhase phase)
+    : _timings(g_active_create_timings), _previous_phase(LOADER_CREATE_PHASE_NONE) {
+    if (nullptr != _timings) {
+        _previous_phase = _timings->_current_phase;
+        _timings->SwitchPhase(phase);
+    }
+}
+
+LoaderCreatePhaseTimer::~LoaderCreatePhaseTimer() {
+    // Skip it if the recording ended in the meantime
+    if (nullptr != _timings && g_active_create_timings == _timings) {
+        _timings->SwitchPhase(_previous_phase);
+    }
+}
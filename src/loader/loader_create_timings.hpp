@@ -0,0 +1,84 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_loader.h>
+
+enum LoaderCreatePhase {
+    LOADER_CREATE_PHASE_NONE = -1,
+    LOADER_CREATE_PHASE_MANIFEST_DISCOVERY = 0,
+    LOADER_CREATE_PHASE_MANIFEST_PARSING,
+    LOADER_CREATE_PHASE_LIBRARY_LOADING,
+    LOADER_CREATE_PHASE_NEGOTIATION,
+    LOADER_CREATE_PHASE_API_LAYER_CREATE_INSTANCE,
+    LOADER_CREATE_PHASE_RUNTIME_CREATE_INSTANCE,
+    LOADER_CREATE_PHASE_DISPATCH_TABLE,
+    LOADER_CREATE_PHASE_COUNT,
+};
+
+// LoaderCreateTimings class -
+// Records how long each phase of an xrCreateInstance call takes.  Recording happens on the thread
+// between Begin and End, and phases are timed with LoaderCreatePhaseTimer wherever they happen to
+// run.  Time is exclusive: while a nested phase runs, the phase around it isn't charged.
+class LoaderCreateTimings {
+   public:
+    LoaderCreateTimings();
+    ~LoaderCreateTimings() { End(); }
+    LoaderCreateTimings(const LoaderCreateTimings&) = default;
+    LoaderCreateTimings& operator=(const LoaderCreateTimings&) = default;
+
+    // Make this the calling thread's recording, until End
+    void Begin();
+    void End();
+
+    void GetTimings(XrLoaderInstanceCreateTimings& timings) const;
+    // One line of "name=nanoseconds" pairs for the log
+    std::string ToString() const;
+
+   private:
+    friend class LoaderCreatePhaseTimer;
+
+    // Charge the time since the last switch to the current phase and move on to the next one
+    void SwitchPhase(LoaderCreatePhase phase);
+
+    std::chrono::steady_clock::time_point _begin;
+    std::chrono::steady_clock::time_point _switch;
+    LoaderCreatePhase _current_phase;
+    uint64_t _total_ns;
+    uint64_t _phase_ns[LOADER_CREATE_PHASE_COUNT];
+};
+
+// LoaderCreatePhaseTimer class -
+// Times the enclosing scope as the given phase of the calling thread's LoaderCreateTimings, if any.
+class LoaderCreatePhaseTimer {
+   public:
+    explicit LoaderCreatePhaseTimer(LoaderCreatePhase phase);
+    ~LoaderCreatePhaseTimer();
+
+    LoaderCreatePhaseTimer(const LoaderCreatePhaseTimer&) = delete;
+    LoaderCreatePhaseTimer& operator=(const LoaderCreatePhaseTimer&) = delete;
+
+   private:
+    LoaderCreateTimings* _timings;
+    LoaderCreatePhase _previous_phase;
+};
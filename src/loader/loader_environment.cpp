@@ -0,0 +1,118 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "xr_dependencies.h"
+#include "platform_utils.hpp"
+#include "loader_environment.hpp"
+
+// Variables read by every manifest search, instance creation or logger initialization.
+static const char* const g_snapshot_variables[] = {
+    "XR_RUNTIME_JSON", "XR_API_LAYER_PATH", "XR_ENABLE_API_LAYERS", "XR_LOADER_DEBUG", "XR_LOADER_RUNTIME_KEEP_ALIVE",
+    "XDG_CONFIG_DIRS", "XDG_DATA_DIRS",     "XDG_DATA_HOME",        "HOME",
+};
+
+struct EnvironmentValue {
+    bool is_set;
+    bool is_secure_set;
+    std::string value;
+};
+
+struct EnvironmentSnapshot {
+    std::mutex mutex;
+    uint64_t generation = 0;
+    std::unordered_map<std::string, EnvironmentValue> values;
+};
+
+static EnvironmentValue ReadEnvironmentValue(const std::string& name) {
+    EnvironmentValue environment_value = {};
+    char* value = PlatformUtilsGetEnv(name.c_str());
+    if (nullptr != value) {
+        environment_value.is_set = true;
+        environment_value.value = value;
+        PlatformUtilsFreeEnv(value);
+
+        char* secure_value = PlatformUtilsGetSecureEnv(name.c_str());
+        environment_value.is_secure_set = (nullptr != secure_value);
+        PlatformUtilsFreeEnv(secure_value);
+    }
+    return environment_value;
+}
+
+// Function local so that the snapshot can be used from static initializers.
+static EnvironmentSnapshot& GetEnvironmentSnapshot() {
+    static EnvironmentSnapshot snapshot;
+    static std::once_flag captured_flag;
+    std::call_once(captured_flag, []() {
+        for (const char* name : g_snapshot_variables) {
+            snapshot.values[name] = ReadEnvironmentValue(name);
+        }
+    });
+    return snapshot;
+}
+
+static const EnvironmentValue& LookUp(EnvironmentSnapshot& snapshot, const std::string& name) {
+    auto found = snapshot.values.find(name);
+    if (found == snapshot.values.end()) {
+        found = snapshot.values.emplace(name, ReadEnvironmentValue(name)).first;
+    }
+    return found->second;
+}
+
+bool LoaderEnvironment::Get(const std::string& name, std::string& value) {
+    EnvironmentSnapshot& snapshot = GetEnvironmentSnapshot();
+    std::lock_guard<std::mutex> snapshot_lock(snapshot.mutex);
+    const EnvironmentValue& environment_value = LookUp(snapshot, name);
+    if (environment_value.is_set) {
+        value = environment_value.value;
+    }
+    return environment_value.is_set;
+}
+
+bool LoaderEnvironment::GetSecure(const std::string& name, std::string& value) {
+    EnvironmentSnapshot& snapshot = GetEnvironmentSnapshot();
+    std::lock_guard<std::mutex> snapshot_lock(snapshot.mutex);
+    const EnvironmentValue& environment_value = LookUp(snapshot, name);
+    if (environment_value.is_secure_set) {
+        value = environment_value.value;
+    }
+    return environment_value.is_secure_set;
+}
+
+bool LoaderEnvironment::IsSet(const std::string& name) {
+    EnvironmentSnapshot& snapshot = GetEnvironmentSnapshot();
+    std::lock_guard<std::mutex> snapshot_lock(snapshot.mutex);
+    return LookUp(snapshot, name).is_set;
+}
+
+void LoaderEnvironment::Refresh() {
+    EnvironmentSnapshot& snapshot = GetEnvironmentSnapshot();
+    std::lock_guard<std::mutex> snapshot_lock(snapshot.mutex);
+    for (auto& entry : snapshot.values) {
+        entry.second = ReadEnvironmentValue(entry.first);
+    }
+    ++snapshot.generation;
+}
+
+uint64_t LoaderEnvironment::Generation() {
+    EnvironmentSnapshot& snapshot = GetEnvironmentSnapshot();
+    std::lock_guard<std::mutex> snapshot_lock(snapshot.mutex);
+    return snapshot.generation;
+}
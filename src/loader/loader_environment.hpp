@@ -0,0 +1,39 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// LoaderEnvironment class -
+// Snapshot of the environment variables the loader consults.  The variables the loader always reads
+// are captured together the first time any of them is needed, anything else (such as an implicit
+// layer's enable or disable variable) the first time it's looked up.  Every lookup after that is
+// answered from the snapshot, so the loader sees one consistent environment until Refresh is called.
+class LoaderEnvironment {
+   public:
+    // Look up a variable, returning false if it isn't set
+    static bool Get(const std::string& name, std::string& value);
+    // Same as Get, but variables are never set for a setuid/setgid process where secure_getenv is available
+    static bool GetSecure(const std::string& name, std::string& value);
+    static bool IsSet(const std::string& name);
+    // Re-read every variable in the snapshot from the process environment
+    static void Refresh();
+    // Incremented by every Refresh, so results derived from the snapshot can tell when to recompute
+    static uint64_t Generation();
+};
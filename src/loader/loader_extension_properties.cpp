@@ -0,0 +1,68 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstring>
+#include <vector>
+
+#include "loader_extension_properties.hpp"
+
+ExtensionPropertiesMerge::ExtensionPropertiesMerge(std::vector<XrExtensionProperties>& properties) : _properties(properties) {
+    _index.reserve(_properties.size());
+    for (size_t prop = 0; prop < _properties.size(); ++prop) {
+        _index.emplace(HashName(_properties[prop].extensionName), prop);
+    }
+}
+
+// FNV-1a, over at most the space XrExtensionProperties has for the name
+size_t ExtensionPropertiesMerge::HashName(const char* extension_name) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t ch = 0; ch < XR_MAX_EXTENSION_NAME_SIZE && extension_name[ch] != '\0'; ++ch) {
+        hash ^= static_cast<unsigned char>(extension_name[ch]);
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+void ExtensionPropertiesMerge::Add(const char* extension_name, uint32_t spec_version) {
+    size_t hash = HashName(extension_name);
+    auto range = _index.equal_range(hash);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        XrExtensionProperties& existing_prop = _properties[entry->second];
+        if (0 == strncmp(existing_prop.extensionName, extension_name, XR_MAX_EXTENSION_NAME_SIZE)) {
+            if (existing_prop.specVersion < spec_version) {
+                existing_prop.specVersion = spec_version;
+            }
+            return;
+        }
+    }
+
+    XrExtensionProperties prop = {};
+    prop.type = XR_TYPE_EXTENSION_PROPERTIES;
+    prop.next = nullptr;
+    strncpy(prop.extensionName, extension_name, XR_MAX_EXTENSION_NAME_SIZE - 1);
+    prop.extensionName[XR_MAX_EXTENSION_NAME_SIZE - 1] = '\0';
+    prop.specVersion = spec_version;
+    _properties.push_back(prop);
+    _index.emplace(hash, _properties.size() - 1);
+}
+
+void ExtensionPropertiesMerge::Add(const std::vector<XrExtensionProperties>& properties) {
+    _properties.reserve(_properties.size() + properties.size());
+    for (const XrExtensionProperties& prop : properties) {
+        Add(prop.extensionName, prop.specVersion);
+    }
+}
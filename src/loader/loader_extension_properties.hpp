@@ -0,0 +1,47 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <openxr/openxr.h>
+
+// ExtensionPropertiesMerge class -
+// Merges extension properties reported by the API layers, the runtime and the loader into one list.
+// Extensions are looked up by a hash of their name, so merging is linear in the number of properties.
+// Each extension keeps the position at which it was first added, and when an extension is reported
+// more than once, the newest spec version wins.
+class ExtensionPropertiesMerge {
+   public:
+    // Merge into properties, which may already contain (distinct) extensions
+    explicit ExtensionPropertiesMerge(std::vector<XrExtensionProperties>& properties);
+
+    void Add(const char* extension_name, uint32_t spec_version);
+    void Add(const XrExtensionProperties& property) { Add(property.extensionName, property.specVersion); }
+    void Add(const std::vector<XrExtensionProperties>& properties);
+
+   private:
+    static size_t HashName(const char* extension_name);
+
+    std::vector<XrExtensionProperties>& _properties;
+    // Name hash to index in _properties
+    std::unordered_multimap<size_t, size_t> _index;
+};
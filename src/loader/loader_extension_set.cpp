@@ -0,0 +1,76 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+#include "loader_extension_set.hpp"
+
+// Maps the registry extension names to their ids.  Built on first use and never modified afterwards,
+// so it is read without any locking.
+typedef std::unordered_map<std::string, uint32_t> ExtensionIdTable;
+
+static ExtensionIdTable BuildExtensionIdTable() {
+    ExtensionIdTable ids;
+    ids.reserve(LOADER_EXTENSION_ID_REGISTRY_COUNT);
+    for (uint32_t id = 0; id < LOADER_EXTENSION_ID_REGISTRY_COUNT; ++id) {
+        ids.emplace(g_loader_registry_extension_names[id], id);
+    }
+    return ids;
+}
+
+static const ExtensionIdTable& GetExtensionIdTable() {
+    static const ExtensionIdTable extension_id_table = BuildExtensionIdTable();
+    return extension_id_table;
+}
+
+bool ExtensionSet::FindId(const std::string& extension_name, uint32_t& id) {
+    const ExtensionIdTable& table = GetExtensionIdTable();
+    auto found = table.find(extension_name);
+    if (found == table.end()) {
+        return false;
+    }
+    id = found->second;
+    return true;
+}
+
+void ExtensionSet::Add(uint32_t id) {
+    if (id < LOADER_EXTENSION_ID_REGISTRY_COUNT) {
+        _registry_extensions.set(id);
+    }
+}
+
+void ExtensionSet::Add(const std::string& extension_name) {
+    uint32_t id;
+    if (FindId(extension_name, id)) {
+        Add(id);
+        return;
+    }
+    auto position = std::lower_bound(_other_extensions.begin(), _other_extensions.end(), extension_name);
+    if (position == _other_extensions.end() || *position != extension_name) {
+        _other_extensions.insert(position, extension_name);
+    }
+}
+
+bool ExtensionSet::Contains(const std::string& extension_name) const {
+    uint32_t id;
+    if (FindId(extension_name, id)) {
+        return Contains(id);
+    }
+    return std::binary_search(_other_extensions.begin(), _other_extensions.end(), extension_name);
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#include "xr_generated_dispatch_table.h"
+#include "xr_generated_loader.hpp"
+
+// ExtensionSet class -
+// A set of extensions with constant time membership tests.  Extensions defined in the registry are
+// identified by their generated LoaderExtensionId and kept in a bitset.  Any other extension is kept
+// by name in a short sorted list of the set's own, so that lookups never touch shared mutable state.
+class ExtensionSet {
+   public:
+    // Get the id of a registry extension, returning false for any other name
+    static bool FindId(const std::string& extension_name, uint32_t& id);
+
+    void Add(uint32_t id);
+    void Add(const std::string& extension_name);
+    bool Contains(uint32_t id) const { return id < LOADER_EXTENSION_ID_REGISTRY_COUNT && _registry_extensions.test(id); }
+    bool Contains(const std::string& extension_name) const;
+
+   private:
+    LoaderRegistryExtensionBits _registry_extensions;
+    std::vector<std::string> _other_extensions;
+};
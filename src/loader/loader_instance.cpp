@@ -29,8 +29,10 @@
 #include "xr_dependencies.h"
 #include <openxr/openxr.h>
 #include <openxr/openxr_platform.h>
+#include <openxr/openxr_loader.h>
 
 #include "loader_instance.hpp"
+#include "loader_create_timings.hpp"
 #include "xr_generated_dispatch_table.h"
 #include "xr_generated_loader.hpp"
 #include "loader_logger.hpp"
@@ -39,7 +41,67 @@
 // the the runtime.
 static const XrExtensionProperties g_debug_utils_props = {XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_EXT_DEBUG_UTILS_EXTENSION_NAME,
                                                           XR_EXT_debug_utils_SPEC_VERSION};
+#if defined(LOADER_STATISTICS)
+static const XrExtensionProperties g_loader_statistics_props = {XR_TYPE_EXTENSION_PROPERTIES, nullptr,
+                                                                XR_EXT_LOADER_STATISTICS_EXTENSION_NAME,
+                                                                XR_EXT_loader_statistics_SPEC_VERSION};
+const std::vector<XrExtensionProperties> LoaderInstance::_loader_supported_extensions = {g_debug_utils_props,
+                                                                                          g_loader_statistics_props};
+#else
 const std::vector<XrExtensionProperties> LoaderInstance::_loader_supported_extensions = {g_debug_utils_props};
+#endif
+
+// When any enabled layer declares the functions it intercepts, each layer's next xrGetInstanceProcAddr, and the one
+// the top-level dispatch table is built from, is one of these instead.  They resolve a command to the first layer at
+// or below their position in the chain that intercepts it, or to the loader terminator.  Layers only hand them the
+// instance, which isn't in g_instance_map until xrCreateInstance is done, so the instance this thread is creating
+// is used first.
+static thread_local LoaderInstance* g_creating_loader_instance = nullptr;
+
+template <uint32_t FirstLayer>
+static XrResult XRAPI_CALL LoaderXrChainGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
+    LoaderInstance* loader_instance = g_creating_loader_instance;
+    if (nullptr == loader_instance) {
+        std::unique_lock<std::mutex> lock(g_instance_mutex);
+        auto instance_iter = g_instance_map.find(instance);
+        if (instance_iter != g_instance_map.end()) {
+            loader_instance = instance_iter->second;
+        }
+    }
+    if (nullptr == loader_instance) {
+        return LoaderXrTermGetInstanceProcAddr(instance, name, function);
+    }
+    return loader_instance->ChainGetInstanceProcAddr(FirstLayer, instance, name, function);
+}
+
+// Layers deeper than this are still called for everything by the layer above them
+static const PFN_xrGetInstanceProcAddr g_chain_get_instance_proc_addrs[] = {
+    LoaderXrChainGetInstanceProcAddr<0>,  LoaderXrChainGetInstanceProcAddr<1>,  LoaderXrChainGetInstanceProcAddr<2>,
+    LoaderXrChainGetInstanceProcAddr<3>,  LoaderXrChainGetInstanceProcAddr<4>,  LoaderXrChainGetInstanceProcAddr<5>,
+    LoaderXrChainGetInstanceProcAddr<6>,  LoaderXrChainGetInstanceProcAddr<7>,  LoaderXrChainGetInstanceProcAddr<8>,
+    LoaderXrChainGetInstanceProcAddr<9>,  LoaderXrChainGetInstanceProcAddr<10>, LoaderXrChainGetInstanceProcAddr<11>,
+    LoaderXrChainGetInstanceProcAddr<12>, LoaderXrChainGetInstanceProcAddr<13>, LoaderXrChainGetInstanceProcAddr<14>,
+    LoaderXrChainGetInstanceProcAddr<15>,
+};
+
+static PFN_xrGetInstanceProcAddr ChainGetInstanceProcAddrFor(size_t first_layer) {
+    if (first_layer >= sizeof(g_chain_get_instance_proc_addrs) / sizeof(g_chain_get_instance_proc_addrs[0])) {
+        return nullptr;
+    }
+    return g_chain_get_instance_proc_addrs[first_layer];
+}
+
+// Makes the instance being created visible to LoaderXrChainGetInstanceProcAddr on this thread
+class LoaderCreatingInstanceScope {
+   public:
+    LoaderCreatingInstanceScope(LoaderInstance* loader_instance) : _previous(g_creating_loader_instance) {
+        g_creating_loader_instance = loader_instance;
+    }
+    ~LoaderCreatingInstanceScope() { g_creating_loader_instance = _previous; }
+
+   private:
+    LoaderInstance* _previous;
+};
 
 // Factory method
 XrResult LoaderInstance::CreateInstance(std::vector<std::unique_ptr<ApiLayerInterface>>& api_layer_interfaces,
@@ -56,10 +118,17 @@ XrResult LoaderInstance::CreateInstance(std::vector<std::unique_ptr<ApiLayerInte
         // Create the loader instance
         loader_instance = new LoaderInstance(api_layer_interfaces);
         *instance = reinterpret_cast<XrInstance>(loader_instance);
+        LoaderCreatingInstanceScope creating_instance_scope(loader_instance);
 
         // Only start the xrCreateApiLayerInstance stack if we have layers.
         std::vector<std::unique_ptr<ApiLayerInterface>>& layer_interfaces = loader_instance->LayerInterfaces();
         if (layer_interfaces.size() > 0) {
+            if (loader_instance->SkipsNonInterceptingLayers()) {
+                LoaderLogger::LogInfoMessage("xrCreateInstance",
+                                             "LoaderInstance::CreateInstance routing each command only through the API layers "
+                                             "that intercept it");
+            }
+
             // Initialize an array of ApiLayerNextInfo structs
             XrApiLayerNextInfo* next_info_list = new XrApiLayerNextInfo[layer_interfaces.size()];
             uint32_t ni_index = static_cast<uint32_t>(layer_interfaces.size() - 1);
@@ -89,6 +158,12 @@ XrResult LoaderInstance::CreateInstance(std::vector<std::unique_ptr<ApiLayerInte
                 next_info_list[ni_index].layerName[XR_MAX_API_LAYER_NAME_SIZE - 1] = '\0';
                 next_info_list[ni_index].next = prev_nextinfo;
                 next_info_list[ni_index].nextGetInstanceProcAddr = prev_gipa_fp;
+                if (loader_instance->SkipsNonInterceptingLayers() && ni_index + 1 < layer_interfaces.size()) {
+                    PFN_xrGetInstanceProcAddr chain_gipa_fp = ChainGetInstanceProcAddrFor(ni_index + 1);
+                    if (nullptr != chain_gipa_fp) {
+                        next_info_list[ni_index].nextGetInstanceProcAddr = chain_gipa_fp;
+                    }
+                }
                 next_info_list[ni_index].nextCreateApiLayerInstance = prev_cali_fp;
 
                 // Update saved pointers for next iteration
@@ -106,10 +181,14 @@ XrResult LoaderInstance::CreateInstance(std::vector<std::unique_ptr<ApiLayerInte
             api_layer_ci.loaderInstance = reinterpret_cast<void*>(loader_instance);
             api_layer_ci.settings_file_location[0] = '\0';
             api_layer_ci.nextInfo = next_info_list;
-            last_error = topmost_cali_fp(info, &api_layer_ci, instance);
+            {
+                LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_API_LAYER_CREATE_INSTANCE);
+                last_error = topmost_cali_fp(info, &api_layer_ci, instance);
+            }
 
             delete[] next_info_list;
         } else {
+            LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_API_LAYER_CREATE_INSTANCE);
             last_error = topmost_ci_fp(info, instance);
         }
 
@@ -124,7 +203,7 @@ XrResult LoaderInstance::CreateInstance(std::vector<std::unique_ptr<ApiLayerInte
                 }
                 // Next check the loader
                 if (!found) {
-                    for (auto loader_extension : LoaderInstance::_loader_supported_extensions) {
+                    for (const XrExtensionProperties& loader_extension : LoaderInstance::_loader_supported_extensions) {
                         if (!strcmp(loader_extension.extensionName, info->enabledExtensionNames[ext])) {
                             found = true;
                             break;
@@ -157,7 +236,10 @@ XrResult LoaderInstance::CreateInstance(std::vector<std::unique_ptr<ApiLayerInte
         if (XR_SUCCEEDED(last_error)) {
             // Create the top-level dispatch table for the instance.  This will contain the function pointers to the
             // first instantiation of every command, whether that is in a layer, or a runtime.
-            last_error = loader_instance->CreateDispatchTable(*instance);
+            {
+                LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_DISPATCH_TABLE);
+                last_error = loader_instance->CreateDispatchTable(*instance);
+            }
             if (XR_FAILED(last_error)) {
                 LoaderLogger::LogErrorMessage("xrCreateInstance",
                                               "LoaderInstance::CreateInstance failed creating top-level dispatch table");
@@ -197,10 +279,17 @@ XrResult LoaderInstance::CreateInstance(std::vector<std::unique_ptr<ApiLayerInte
 }
 
 LoaderInstance::LoaderInstance(std::vector<std::unique_ptr<ApiLayerInterface>>& api_layer_interfaces)
-    : _unique_id(0xDECAFBAD), _api_version(XR_CURRENT_API_VERSION), _dispatch_valid(false), _messenger(XR_NULL_HANDLE) {
+    : _unique_id(0xDECAFBAD),
+      _api_version(XR_CURRENT_API_VERSION),
+      _skips_non_intercepting_layers(false),
+      _dispatch_valid(false),
+      _messenger(XR_NULL_HANDLE) {
     try {
         for (auto l_iter = api_layer_interfaces.begin(); api_layer_interfaces.size() > 0 && l_iter != api_layer_interfaces.end();
              /* No iterate */) {
+            if ((*l_iter)->DeclaresInterceptedFunctions()) {
+                _skips_non_intercepting_layers = true;
+            }
             _api_layer_interfaces.push_back(std::move(*l_iter));
             api_layer_interfaces.erase(l_iter);
         }
@@ -224,14 +313,19 @@ XrResult LoaderInstance::CreateDispatchTable(XrInstance instance) {
         // Create the top-level dispatch table.  First, we want to start with a dispatch table generated
         // using the commands from the runtime, with the exception of commands that we need a terminator
         // for.  The loaderGenInitInstanceDispatchTable utility function handles that automatically for us.
-        std::unique_ptr<XrGeneratedDispatchTable> new_instance_dispatch_table(new XrGeneratedDispatchTable());
+        LoaderUniquePtr<XrGeneratedDispatchTable> new_instance_dispatch_table =
+            LoaderMakeUnique<XrGeneratedDispatchTable>(LOADER_MEMORY_CATEGORY_DISPATCH_TABLE);
         LoaderGenInitInstanceDispatchTable(_runtime_instance, new_instance_dispatch_table);
 
         // Go through all layers, and override the instance pointers with the layer version.  However,
         // go backwards through the layer list so we replace in reverse order so the layers can call their next function
         // appropriately.
         if (_api_layer_interfaces.size() > 0) {
-            (*_api_layer_interfaces.begin())->GenUpdateInstanceDispatchTable(instance, new_instance_dispatch_table);
+            PFN_xrGetInstanceProcAddr get_instance_proc_addr = (*_api_layer_interfaces.begin())->GetInstanceProcAddrFuncPointer();
+            if (_skips_non_intercepting_layers) {
+                get_instance_proc_addr = ChainGetInstanceProcAddrFor(0);
+            }
+            ApiLayerInterface::GenUpdateInstanceDispatchTable(instance, get_instance_proc_addr, new_instance_dispatch_table);
         }
 
         // Set the top-level instance dispatch table to the top-most commands now that we've figured them out.
@@ -247,11 +341,12 @@ XrResult LoaderInstance::CreateDispatchTable(XrInstance instance) {
     return res;
 }
 
-bool LoaderInstance::ExtensionIsEnabled(const std::string& extension) {
-    for (std::string& cur_enabled : _enabled_extensions) {
-        if (cur_enabled == extension) {
-            return true;
+XrResult LoaderInstance::ChainGetInstanceProcAddr(size_t first_layer, XrInstance instance, const char* name,
+                                                  PFN_xrVoidFunction* function) {
+    for (size_t layer = first_layer; layer < _api_layer_interfaces.size(); ++layer) {
+        if (_api_layer_interfaces[layer]->InterceptsFunction(name)) {
+            return _api_layer_interfaces[layer]->GetInstanceProcAddrFuncPointer()(instance, name, function);
         }
     }
-    return false;
+    return LoaderXrTermGetInstanceProcAddr(instance, name, function);
 }
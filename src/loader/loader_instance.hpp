@@ -26,6 +26,9 @@
 #include "platform_utils.hpp"
 #include "runtime_interface.hpp"
 #include "api_layer_interface.hpp"
+#include "loader_allocator.hpp"
+#include "loader_create_timings.hpp"
+#include "loader_extension_set.hpp"
 #include "xr_generated_dispatch_table.h"
 
 class LoaderInstance {
@@ -37,27 +40,41 @@ class LoaderInstance {
     LoaderInstance(std::vector<std::unique_ptr<ApiLayerInterface>>& api_layer_interfaces);
     virtual ~LoaderInstance();
 
+    // Instances are allocated through the application's allocation callbacks, when it supplied them
+    static void* operator new(size_t size) { return LoaderAllocation::Allocate(size, LOADER_MEMORY_CATEGORY_INSTANCE); }
+    static void operator delete(void* memory) { LoaderAllocation::Free(memory); }
+
     bool IsValid() { return _unique_id == 0xDECAFBAD; }
     uint32_t ApiVersion() { return _api_version; }
     XrResult CreateDispatchTable(XrInstance instance);
+    // Whether any enabled layer declared the functions it intercepts, so the others can be skipped for each command
+    bool SkipsNonInterceptingLayers() { return _skips_non_intercepting_layers; }
+    // Look a command up in the first layer, starting at first_layer, that intercepts it, or else the runtime
+    XrResult ChainGetInstanceProcAddr(size_t first_layer, XrInstance instance, const char* name, PFN_xrVoidFunction* function);
     void SetRuntimeInstance(XrInstance instance) { _runtime_instance = instance; }
-    const std::unique_ptr<XrGeneratedDispatchTable>& DispatchTable() { return _dispatch_table; }
+    const LoaderUniquePtr<XrGeneratedDispatchTable>& DispatchTable() { return _dispatch_table; }
     std::vector<std::unique_ptr<ApiLayerInterface>>& LayerInterfaces() { return _api_layer_interfaces; }
-    void AddEnabledExtension(const std::string& extension) { return _enabled_extensions.push_back(extension); }
-    bool ExtensionIsEnabled(const std::string& extension);
+    void AddEnabledExtension(const std::string& extension) { _enabled_extensions.Add(extension); }
+    bool ExtensionIsEnabled(const std::string& extension) { return _enabled_extensions.Contains(extension); }
+    bool ExtensionIsEnabled(LoaderExtensionId extension) { return _enabled_extensions.Contains(extension); }
     static const std::vector<XrExtensionProperties>& LoaderSpecificExtensions() { return _loader_supported_extensions; }
     XrDebugUtilsMessengerEXT DefaultDebugUtilsMessenger() { return _messenger; }
     void SetDefaultDebugUtilsMessenger(XrDebugUtilsMessengerEXT messenger) { _messenger = messenger; }
+    const LoaderCreateTimings& CreateTimings() { return _create_timings; }
+    void SetCreateTimings(const LoaderCreateTimings& create_timings) { _create_timings = create_timings; }
 
    private:
     uint32_t _unique_id;  // 0xDECAFBAD - for debugging
     uint32_t _api_version;
     std::vector<std::unique_ptr<ApiLayerInterface>> _api_layer_interfaces;
+    bool _skips_non_intercepting_layers;
     XrInstance _runtime_instance;
     bool _dispatch_valid;
-    std::unique_ptr<XrGeneratedDispatchTable> _dispatch_table;
+    LoaderUniquePtr<XrGeneratedDispatchTable> _dispatch_table;
     static const std::vector<XrExtensionProperties> _loader_supported_extensions;
-    std::vector<std::string> _enabled_extensions;
+    ExtensionSet _enabled_extensions;
     // Internal debug messenger created during xrCreateInstance
     XrDebugUtilsMessengerEXT _messenger;
+    // How long each phase of creating this instance took
+    LoaderCreateTimings _create_timings;
 };
@@ -28,6 +28,7 @@
 
 #include "loader_platform.hpp"
 #include "platform_utils.hpp"
+#include "loader_environment.hpp"
 #include "loader_logger.hpp"
 
 std::unique_ptr<LoaderLogger> LoaderLogger::_instance;
@@ -259,17 +260,15 @@ bool DebugUtilsLogRecorder::LogDebugUtilsMessage(XrDebugUtilsMessageSeverityFlag
     return (_user_callback(message_severity, message_type, callback_data, _user_data) == XR_TRUE);
 }
 
-LoaderLogger::LoaderLogger() {
+LoaderLogger::LoaderLogger() : _object_name_footprint(LOADER_MEMORY_CATEGORY_OBJECT_NAME) {
     // Add an error logger by default so that we at least get errors out to std::cerr.
     std::unique_ptr<LoaderLogRecorder> base_recorder(new StdErrLoaderLogRecorder(nullptr));
     AddLogRecorder(base_recorder);
 
     // If the environment variable to enable loader debugging is set, then enable the
     // appropriate logging out to std::cout.
-    char* loader_debug = PlatformUtilsGetSecureEnv("XR_LOADER_DEBUG");
-    if (nullptr != loader_debug) {
-        std::string debug_string = loader_debug;
-        PlatformUtilsFreeEnv(loader_debug);
+    std::string debug_string;
+    if (LoaderEnvironment::GetSecure("XR_LOADER_DEBUG", debug_string)) {
         XrLoaderLogMessageSeverityFlags debug_flags = {};
         if (debug_string == "error") {
             debug_flags = XR_LOADER_LOG_MESSAGE_SEVERITY_ERROR_BIT;
@@ -458,6 +457,12 @@ void LoaderLogger::AddObjectName(uint64_t object_handle, XrObjectType object_typ
             _object_info.push_back(new_object_info);
         }
     }
+
+    size_t footprint_bytes = _object_info.capacity() * sizeof(XrLoaderLogObjectInfo);
+    for (const XrLoaderLogObjectInfo& obj_info : _object_info) {
+        footprint_bytes += obj_info.name.capacity();
+    }
+    _object_name_footprint.Set(footprint_bytes);
 }
 
 // We always want to remove the old individual label before we do anything else.
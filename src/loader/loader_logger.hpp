@@ -25,6 +25,8 @@
 #include <unordered_map>
 #include <stack>
 
+#include "loader_allocator.hpp"
+
 // Use internal versions of flags similar to XR_EXT_debug_utils so that
 // we're not tightly coupled to that extension.  This way, if the extension
 // changes or gets replaced, we can be flexible in the loader.
@@ -216,6 +218,7 @@ class LoaderLogger {
 
     // Object names that have been set for given objects
     std::vector<XrLoaderLogObjectInfo> _object_info;
+    LoaderMemoryFootprint _object_name_footprint;
 
     // Session labels
     std::unordered_map<XrSession, std::vector<InternalSessionLabel*>*> _session_labels;
@@ -30,6 +30,15 @@
 #define LOADER_EXPORT
 #endif
 
+// Rarely run code, such as error reporting, that should stay out of line and away from hot code
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define LOADER_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define LOADER_COLD __declspec(noinline)
+#else
+#define LOADER_COLD
+#endif
+
 // Environment variables
 #if defined(XR_OS_LINUX) || defined(XR_OS_APPLE)
 
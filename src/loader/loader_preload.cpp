@@ -0,0 +1,154 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstdlib>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "loader_preload.hpp"
+#include "loader_logger.hpp"
+#include "runtime_interface.hpp"
+#include "api_layer_interface.hpp"
+
+struct LoaderPreloadState {
+    std::mutex mutex;
+    // Held while joining, so a second caller can't return before the preload has actually finished
+    std::mutex join_mutex;
+    std::thread thread;
+    bool started = false;
+    // Set when the process exits, so the preload skips whatever it hasn't started on yet
+    bool stopping = false;
+    bool runtime_loaded = false;
+    // Keep the negotiated layers cached until xrCreateInstance has picked them up
+    std::vector<std::unique_ptr<ApiLayerInterface>> layer_interfaces;
+};
+
+// Never destroyed, so that it outlives the preload thread however the process ends.  Function local so
+// that xrLoaderPreload may be called from an application's own static initializers.
+static LoaderPreloadState& GetPreloadState() {
+    static LoaderPreloadState* preload_state = new LoaderPreloadState;
+    return *preload_state;
+}
+
+static bool PreloadStopping() {
+    LoaderPreloadState& state = GetPreloadState();
+    std::unique_lock<std::mutex> state_lock(state.mutex);
+    return state.stopping;
+}
+
+static void RunPreload(const std::string& openxr_command) {
+    try {
+        std::unique_lock<std::mutex> json_lock(g_loader_json_mutex);
+        if (PreloadStopping()) {
+            return;
+        }
+        bool runtime_loaded = (XR_SUCCESS == RuntimeInterface::LoadRuntime(openxr_command));
+        if (!runtime_loaded) {
+            LoaderLogger::LogWarningMessage(openxr_command, "LoaderPreload - failed to preload the runtime");
+        }
+
+        // Negotiating with the layers that need no application request now leaves them in the negotiated layer
+        // cache, where xrCreateInstance finds them.
+        std::vector<std::unique_ptr<ApiLayerInterface>> layer_interfaces;
+        if (!PreloadStopping() && XR_SUCCESS != ApiLayerInterface::LoadApiLayers(openxr_command, 0, nullptr, layer_interfaces)) {
+            LoaderLogger::LogWarningMessage(openxr_command, "LoaderPreload - failed to preload the implicit API layers");
+        }
+        json_lock.unlock();
+
+        LoaderPreloadState& state = GetPreloadState();
+        std::unique_lock<std::mutex> state_lock(state.mutex);
+        state.runtime_loaded = runtime_loaded;
+        state.layer_interfaces = std::move(layer_interfaces);
+
+        std::string info_message = "LoaderPreload - preloaded ";
+        info_message += runtime_loaded ? "the runtime and " : "";
+        info_message += std::to_string(state.layer_interfaces.size());
+        info_message += " API layers";
+        LoaderLogger::LogInfoMessage(openxr_command, info_message);
+    } catch (...) {
+        LoaderLogger::LogErrorMessage(openxr_command, "LoaderPreload - unknown error occurred");
+    }
+}
+
+// A process that exits without ever creating an instance must not run the loader's static destructors
+// while the preload is still using what they destroy.
+static void StopPreloadAtExit() {
+    LoaderPreloadState& state = GetPreloadState();
+    {
+        std::unique_lock<std::mutex> state_lock(state.mutex);
+        state.stopping = true;
+    }
+    LoaderPreload::Join();
+}
+
+XrResult LoaderPreload::Start(const std::string& openxr_command) {
+    try {
+        LoaderPreloadState& state = GetPreloadState();
+        std::unique_lock<std::mutex> state_lock(state.mutex);
+        if (state.started) {
+            return XR_SUCCESS;
+        }
+        // Registered before the thread exists, so it runs ahead of the destructors of everything the loader set up
+        // before the preload started.
+        if (0 != std::atexit(StopPreloadAtExit)) {
+            LoaderLogger::LogErrorMessage(openxr_command, "LoaderPreload::Start - failed to register the exit handler");
+            return XR_ERROR_INITIALIZATION_FAILED;
+        }
+        state.thread = std::thread(RunPreload, openxr_command);
+        state.started = true;
+        return XR_SUCCESS;
+    } catch (std::bad_alloc&) {
+        LoaderLogger::LogErrorMessage(openxr_command, "LoaderPreload::Start - failed to allocate memory");
+        return XR_ERROR_OUT_OF_MEMORY;
+    } catch (std::system_error&) {
+        LoaderLogger::LogErrorMessage(openxr_command, "LoaderPreload::Start - failed to start the preload thread");
+        return XR_ERROR_INITIALIZATION_FAILED;
+    } catch (...) {
+        LoaderLogger::LogErrorMessage(openxr_command, "LoaderPreload::Start - unknown error occurred");
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+}
+
+void LoaderPreload::Join() {
+    LoaderPreloadState& state = GetPreloadState();
+    std::unique_lock<std::mutex> join_lock(state.join_mutex);
+    std::thread preload_thread;
+    {
+        std::unique_lock<std::mutex> state_lock(state.mutex);
+        preload_thread = std::move(state.thread);
+    }
+    if (preload_thread.joinable()) {
+        preload_thread.join();
+    }
+}
+
+void LoaderPreload::Release(const std::string& openxr_command) {
+    Join();
+    LoaderPreloadState& state = GetPreloadState();
+    std::unique_lock<std::mutex> state_lock(state.mutex);
+    // Layers first, so that unloading the runtime also releases any preloaded layer nobody else took up.
+    bool had_layers = !state.layer_interfaces.empty();
+    state.layer_interfaces.clear();
+    if (state.runtime_loaded) {
+        state.runtime_loaded = false;
+        RuntimeInterface::UnloadRuntime(openxr_command);
+    } else if (had_layers) {
+        ApiLayerInterface::ReleaseUnusedApiLayers();
+    }
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+
+#include <mutex>
+#include <string>
+
+#include <openxr/openxr.h>
+
+// Global lock to prevent reading JSON manifest files at the same time, taken both by the trampolines
+// and by the preload.  Defined in loader_core.cpp.
+extern std::mutex g_loader_json_mutex;
+
+// LoaderPreload class -
+// Finds, opens and negotiates with the active runtime and the implicit API layers on a background
+// thread, so that xrCreateInstance finds them already loaded and reuses them as they are.  Only ever
+// started by the application, through xrLoaderPreload.
+class LoaderPreload {
+   public:
+    // Start the background preload unless one has already been started
+    static XrResult Start(const std::string& openxr_command);
+    // Wait for a preload in progress to finish
+    static void Join();
+    // Drop the runtime and layer references held by the preload once the caller has taken its own
+    static void Release(const std::string& openxr_command);
+};
@@ -0,0 +1,208 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "loader_statistics.hpp"
+
+#if defined(LOADER_STATISTICS)
+
+#include "loader_instance.hpp"
+#include "loader_logger.hpp"
+
+// Counters of a single thread.  Only that thread writes them, other threads read them while summing.
+struct LoaderThreadStatistics {
+    std::atomic<uint64_t> call_count[LOADER_COMMAND_ID_COUNT];
+    std::atomic<uint64_t> total_ns[LOADER_COMMAND_ID_COUNT];
+    std::atomic<uint64_t> max_ns[LOADER_COMMAND_ID_COUNT];
+
+    LoaderThreadStatistics();
+    ~LoaderThreadStatistics();
+};
+
+// Every thread's counters, plus what threads that have since exited left behind
+struct LoaderStatisticsRegistry {
+    std::mutex mutex;
+    std::vector<LoaderThreadStatistics*> threads;
+    uint64_t retired_call_count[LOADER_COMMAND_ID_COUNT] = {};
+    uint64_t retired_total_ns[LOADER_COMMAND_ID_COUNT] = {};
+    uint64_t retired_max_ns[LOADER_COMMAND_ID_COUNT] = {};
+};
+
+static LoaderStatisticsRegistry& GetStatisticsRegistry() {
+    static LoaderStatisticsRegistry registry;
+    return registry;
+}
+
+LoaderThreadStatistics::LoaderThreadStatistics() {
+    for (uint32_t command = 0; command < LOADER_COMMAND_ID_COUNT; ++command) {
+        call_count[command].store(0, std::memory_order_relaxed);
+        total_ns[command].store(0, std::memory_order_relaxed);
+        max_ns[command].store(0, std::memory_order_relaxed);
+    }
+    LoaderStatisticsRegistry& registry = GetStatisticsRegistry();
+    std::unique_lock<std::mutex> registry_lock(registry.mutex);
+    registry.threads.push_back(this);
+}
+
+LoaderThreadStatistics::~LoaderThreadStatistics() {
+    LoaderStatisticsRegistry& registry = GetStatisticsRegistry();
+    std::unique_lock<std::mutex> registry_lock(registry.mutex);
+    for (uint32_t command = 0; command < LOADER_COMMAND_ID_COUNT; ++command) {
+        registry.retired_call_count[command] += call_count[command].load(std::memory_order_relaxed);
+        registry.retired_total_ns[command] += total_ns[command].load(std::memory_order_relaxed);
+        uint64_t thread_max_ns = max_ns[command].load(std::memory_order_relaxed);
+        if (thread_max_ns > registry.retired_max_ns[command]) {
+            registry.retired_max_ns[command] = thread_max_ns;
+        }
+    }
+    for (auto thread = registry.threads.begin(); thread != registry.threads.end(); ++thread) {
+        if (*thread == this) {
+            registry.threads.erase(thread);
+            break;
+        }
+    }
+}
+
+void LoaderStatistics::Record(LoaderCommandId command, uint64_t duration_ns) {
+    try {
+        static thread_local LoaderThreadStatistics thread_statistics;
+        // Nothing else writes these counters, so a plain load and store is enough
+        std::atomic<uint64_t>& call_count = thread_statistics.call_count[command];
+        call_count.store(call_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic<uint64_t>& total_ns = thread_statistics.total_ns[command];
+        total_ns.store(total_ns.load(std::memory_order_relaxed) + duration_ns, std::memory_order_relaxed);
+        std::atomic<uint64_t>& max_ns = thread_statistics.max_ns[command];
+        if (duration_ns > max_ns.load(std::memory_order_relaxed)) {
+            max_ns.store(duration_ns, std::memory_order_relaxed);
+        }
+    } catch (...) {
+        // Registering a new thread's counters can fail to allocate, the call just goes uncounted
+    }
+}
+
+static bool IsValidInstance(XrInstance instance) {
+    std::unique_lock<std::mutex> instance_lock(g_instance_mutex);
+    return g_instance_map.find(instance) != g_instance_map.end();
+}
+
+static XRAPI_ATTR XrResult XRAPI_CALL LoaderXrEnumerateLoaderCommandStatisticsEXT(XrInstance instance,
+                                                                                   uint32_t statisticCapacityInput,
+                                                                                   uint32_t* statisticCountOutput,
+                                                                                   XrLoaderCommandStatisticsEXT* statistics) {
+    try {
+        LoaderLogger::LogVerboseMessage("xrEnumerateLoaderCommandStatisticsEXT", "Entering loader trampoline");
+        if (!IsValidInstance(instance)) {
+            LoaderLogger::LogErrorMessage("xrEnumerateLoaderCommandStatisticsEXT", "invalid instance");
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        if (nullptr == statisticCountOutput) {
+            LoaderLogger::LogErrorMessage("xrEnumerateLoaderCommandStatisticsEXT", "statisticCountOutput must be non-NULL");
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        *statisticCountOutput = LOADER_COMMAND_ID_COUNT;
+        if (0 == statisticCapacityInput) {
+            return XR_SUCCESS;
+        }
+        if (statisticCapacityInput < LOADER_COMMAND_ID_COUNT) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        if (nullptr == statistics) {
+            LoaderLogger::LogErrorMessage("xrEnumerateLoaderCommandStatisticsEXT", "statistics must be non-NULL");
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        LoaderStatisticsRegistry& registry = GetStatisticsRegistry();
+        std::unique_lock<std::mutex> registry_lock(registry.mutex);
+        for (uint32_t command = 0; command < LOADER_COMMAND_ID_COUNT; ++command) {
+            XrLoaderCommandStatisticsEXT& statistic = statistics[command];
+            statistic.commandName = g_loader_command_names[command];
+            statistic.callCount = registry.retired_call_count[command];
+            statistic.totalNs = registry.retired_total_ns[command];
+            statistic.maxNs = registry.retired_max_ns[command];
+            for (const LoaderThreadStatistics* thread : registry.threads) {
+                statistic.callCount += thread->call_count[command].load(std::memory_order_relaxed);
+                statistic.totalNs += thread->total_ns[command].load(std::memory_order_relaxed);
+                uint64_t thread_max_ns = thread->max_ns[command].load(std::memory_order_relaxed);
+                if (thread_max_ns > statistic.maxNs) {
+                    statistic.maxNs = thread_max_ns;
+                }
+            }
+        }
+        return XR_SUCCESS;
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("xrEnumerateLoaderCommandStatisticsEXT", "Unknown error occurred");
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+}
+
+static XRAPI_ATTR XrResult XRAPI_CALL LoaderXrEnumerateLoaderHandleStatisticsEXT(XrInstance instance,
+                                                                                  uint32_t statisticCapacityInput,
+                                                                                  uint32_t* statisticCountOutput,
+                                                                                  XrLoaderHandleStatisticsEXT* statistics) {
+    try {
+        LoaderLogger::LogVerboseMessage("xrEnumerateLoaderHandleStatisticsEXT", "Entering loader trampoline");
+        if (!IsValidInstance(instance)) {
+            LoaderLogger::LogErrorMessage("xrEnumerateLoaderHandleStatisticsEXT", "invalid instance");
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        if (nullptr == statisticCountOutput) {
+            LoaderLogger::LogErrorMessage("xrEnumerateLoaderHandleStatisticsEXT", "statisticCountOutput must be non-NULL");
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        std::vector<std::pair<XrObjectType, size_t>> map_sizes;
+        LoaderGetHandleMapSizes(map_sizes);
+        *statisticCountOutput = static_cast<uint32_t>(map_sizes.size());
+        if (0 == statisticCapacityInput) {
+            return XR_SUCCESS;
+        }
+        if (statisticCapacityInput < map_sizes.size()) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        if (nullptr == statistics) {
+            LoaderLogger::LogErrorMessage("xrEnumerateLoaderHandleStatisticsEXT", "statistics must be non-NULL");
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        for (size_t handle_type = 0; handle_type < map_sizes.size(); ++handle_type) {
+            statistics[handle_type].objectType = map_sizes[handle_type].first;
+            statistics[handle_type].handleCount = map_sizes[handle_type].second;
+        }
+        return XR_SUCCESS;
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("xrEnumerateLoaderHandleStatisticsEXT", "Unknown error occurred");
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+}
+
+void LoaderStatistics::GetInstanceProcAddr(LoaderInstance* loader_instance, const char* name, PFN_xrVoidFunction* function) {
+    if (!loader_instance->ExtensionIsEnabled(XR_EXT_LOADER_STATISTICS_EXTENSION_NAME)) {
+        return;
+    }
+    if (0 == strcmp(name, "xrEnumerateLoaderCommandStatisticsEXT")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(LoaderXrEnumerateLoaderCommandStatisticsEXT);
+    } else if (0 == strcmp(name, "xrEnumerateLoaderHandleStatisticsEXT")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(LoaderXrEnumerateLoaderHandleStatisticsEXT);
+    }
+}
+
+#endif  // LOADER_STATISTICS
@@ -0,0 +1,66 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+#include <openxr/openxr_loader.h>
+
+#include "xr_generated_dispatch_table.h"
+#include "xr_generated_loader.hpp"
+
+// Only built when the generated loader sources were generated with -loaderStatistics
+#if defined(LOADER_STATISTICS)
+
+class LoaderInstance;
+
+// LoaderStatistics class -
+// Call counts and times of the generated trampolines, behind XR_EXT_loader_statistics.  Each thread
+// records into its own counters, which are only summed up when the statistics are queried.
+class LoaderStatistics {
+   public:
+    static void Record(LoaderCommandId command, uint64_t duration_ns);
+    // Fill in the extension's commands, if it's enabled on loader_instance
+    static void GetInstanceProcAddr(LoaderInstance* loader_instance, const char* name, PFN_xrVoidFunction* function);
+};
+
+// LoaderCommandTimer class -
+// Records one call of a command, taking as long as the enclosing scope.
+class LoaderCommandTimer {
+   public:
+    explicit LoaderCommandTimer(LoaderCommandId command) : _command(command), _start(std::chrono::steady_clock::now()) {}
+    ~LoaderCommandTimer() {
+        auto duration = std::chrono::steady_clock::now() - _start;
+        LoaderStatistics::Record(_command,
+                                 static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+    }
+
+    LoaderCommandTimer(const LoaderCommandTimer&) = delete;
+    LoaderCommandTimer& operator=(const LoaderCommandTimer&) = delete;
+
+   private:
+    LoaderCommandId _command;
+    std::chrono::steady_clock::time_point _start;
+};
+
+#endif  // LOADER_STATISTICS
@@ -21,14 +21,28 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif
 
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
-#include <fstream>
 #include <iostream>
+#include <mutex>
 #include <stdexcept>
+#include <utility>
+
+#ifdef XR_OS_LINUX
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "filesystem_utils.hpp"
 #include "loader_platform.hpp"
 #include "platform_utils.hpp"
+#include "loader_create_timings.hpp"
+#include "loader_environment.hpp"
+#include "loader_extension_properties.hpp"
 #include "manifest_file.hpp"
 #include "loader_logger.hpp"
 #include "loader_instance.hpp"
@@ -85,13 +99,20 @@ static void CheckAllFilesInThePath(ManifestFileType type, const std::string &sea
                     AddIfJson(type, absolute_path, manifest_files);
                 }
             } else {
-                std::vector<std::string> files;
-                if (FileSysUtilsFindFilesInPath(search_path, files)) {
-                    for (std::string &cur_file : files) {
-                        std::string relative_path;
-                        FileSysUtilsCombinePaths(search_path, cur_file, relative_path);
-                        if (!FileSysUtilsGetAbsolutePath(relative_path, absolute_path)) {
-                            continue;
+                // Resolve the directory once, only symbolic links need resolving individually.
+                std::string absolute_directory;
+                std::vector<FileSysUtilsDirectoryEntry> entries;
+                if (FileSysUtilsGetAbsolutePath(search_path, absolute_directory) &&
+                    FileSysUtilsScanDirectory(absolute_directory, ".json", entries)) {
+                    for (FileSysUtilsDirectoryEntry &cur_entry : entries) {
+                        if (cur_entry.may_be_symlink) {
+                            std::string relative_path;
+                            FileSysUtilsCombinePaths(absolute_directory, cur_entry.name, relative_path);
+                            if (!FileSysUtilsGetAbsolutePath(relative_path, absolute_path)) {
+                                continue;
+                            }
+                        } else {
+                            FileSysUtilsCombinePaths(absolute_directory, cur_entry.name, absolute_path);
                         }
                         AddIfJson(type, absolute_path, manifest_files);
                     }
@@ -104,37 +125,55 @@ static void CheckAllFilesInThePath(ManifestFileType type, const std::string &sea
     }
 }
 
-// Add all manifest files in the provided paths to the manifest_files list.  If search_path
-// is made up of directory listings (versus direct manifest file names) search each path for
-// any manifest files.
-static void AddFilesInPath(ManifestFileType type, const std::string &search_path, bool is_directory_list,
-                           std::vector<std::string> &manifest_files) {
+// Split a search path string into its individual, non-empty, entries.
+static void SplitSearchPath(const std::string &search_path, std::vector<std::string> &search_paths) {
     std::size_t last_found = 0;
     std::size_t found = search_path.find_first_of(PATH_SEPARATOR);
-    std::string cur_search;
+    while (found != std::string::npos) {
+        if (found > last_found) {
+            search_paths.push_back(search_path.substr(last_found, found - last_found));
+        }
+        last_found = found + 1;
+        found = search_path.find_first_of(PATH_SEPARATOR, last_found);
+    }
+    if (last_found < search_path.size()) {
+        search_paths.push_back(search_path.substr(last_found));
+    }
+}
 
+// Add all manifest files in the provided paths to the manifest_files list.  If search_paths
+// are directories (versus direct manifest file names) search each path for any manifest files.
+// Paths that refer to the same file or directory as an earlier one, for example through a
+// symbolic link, are only read once.
+static void AddFilesInPath(ManifestFileType type, const std::vector<std::string> &search_paths, bool is_directory_list,
+                           std::vector<std::string> &manifest_files) {
     try {
-        // Handle any path listings in the string (separated by the appropriate path separator)
-        while (found != std::string::npos) {
-            // substr takes a start index and length.
-            std::size_t length = found - last_found;
-            cur_search = search_path.substr(last_found, length);
-
-            CheckAllFilesInThePath(type, cur_search, is_directory_list, manifest_files);
-
-            // This works around issue if multiple path separator follow each other directly.
-            last_found = found;
-            while (found == last_found) {
-                std::ostringstream stringStream2;
-                last_found = found + 1;
-                found = search_path.find_first_of(PATH_SEPARATOR, last_found);
+        std::vector<FileSysUtilsFileIdentity> visited;
+        std::size_t first_new_file = manifest_files.size();
+        for (const std::string &cur_search : search_paths) {
+            FileSysUtilsFileIdentity identity;
+            if (FileSysUtilsGetFileIdentity(cur_search, identity)) {
+                if (std::find(visited.begin(), visited.end(), identity) != visited.end()) {
+                    std::string info_message = "AddFilesInPath - skipping ";
+                    info_message += cur_search;
+                    info_message += ", already searched through another path";
+                    LoaderLogger::LogVerboseMessage("", info_message);
+                    continue;
+                }
+                visited.push_back(identity);
             }
+            CheckAllFilesInThePath(type, cur_search, is_directory_list, manifest_files);
         }
 
-        // If there's something remaining in the string, copy it over
-        if (last_found < search_path.size()) {
-            cur_search = search_path.substr(last_found);
-            CheckAllFilesInThePath(type, cur_search, is_directory_list, manifest_files);
+        // Symbolic links in different directories may still lead to the same manifest file.
+        for (std::size_t cur_file = first_new_file; cur_file < manifest_files.size();) {
+            auto first_match = std::find(manifest_files.begin() + first_new_file, manifest_files.begin() + cur_file,
+                                         manifest_files[cur_file]);
+            if (first_match != manifest_files.begin() + cur_file) {
+                manifest_files.erase(manifest_files.begin() + cur_file);
+            } else {
+                ++cur_file;
+            }
         }
     } catch (...) {
         LoaderLogger::LogErrorMessage("", "AddFilesInPath - unknown error occurred");
@@ -142,140 +181,116 @@ static void AddFilesInPath(ManifestFileType type, const std::string &search_path
     }
 }
 
-// Copy all paths listed in the cur_path string into output_path and append the appropriate relative_path onto the end of each.
+// Copy all paths listed in the cur_path string into output_paths and append the appropriate relative_path onto the end of each.
 static void CopyIncludedPaths(bool is_directory_list, const std::string &cur_path, const std::string &relative_path,
-                              std::string &output_path) {
-    if (0 != cur_path.size()) {
-        std::size_t last_found = 0;
-        std::size_t found = cur_path.find_first_of(PATH_SEPARATOR);
-
-        try {
-            // Handle any path listings in the string (separated by the appropriate path separator)
-            while (found != std::string::npos) {
-                output_path += cur_path.substr(last_found, found);
-                if (is_directory_list && (cur_path[found - 1] != '\\' && cur_path[found - 1] != '/')) {
-                    output_path += DIRECTORY_SYMBOL;
-                }
-                output_path += relative_path;
-                output_path += PATH_SEPARATOR;
-
-                last_found = found;
-                found = cur_path.find_first_of(PATH_SEPARATOR, found + 1);
-            }
-
-            // If there's something remaining in the string, copy it over
-            size_t last_char = cur_path.size() - 1;
-            if (last_found != last_char) {
-                output_path += cur_path.substr(last_found, found);
-                if (is_directory_list && (cur_path[last_char] != '\\' && cur_path[last_char] != '/')) {
-                    output_path += DIRECTORY_SYMBOL;
-                }
-                output_path += relative_path;
-                output_path += PATH_SEPARATOR;
+                              std::vector<std::string> &output_paths) {
+    try {
+        std::vector<std::string> included_paths;
+        SplitSearchPath(cur_path, included_paths);
+        for (std::string &included_path : included_paths) {
+            char last_char = included_path.back();
+            if (is_directory_list && last_char != '\\' && last_char != '/') {
+                included_path += DIRECTORY_SYMBOL;
             }
-        } catch (...) {
-            LoaderLogger::LogErrorMessage("", "CopyIncludedPaths - unknown error occurred");
-            throw;
+            included_path += relative_path;
+            output_paths.push_back(included_path);
         }
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("", "CopyIncludedPaths - unknown error occurred");
+        throw;
     }
 }
 
-// Look for data files in the provided paths, but first check the environment override to determine if we should use that instead.
-static void ReadDataFilesInSearchPaths(ManifestFileType type, const std::string &override_env_var, const std::string &relative_path,
-                                       bool &override_active, std::vector<std::string> &manifest_files) {
-    bool is_directory_list = true;
+// Build the ordered list of paths to look for data files in, but first check the environment override to determine if we
+// should use that instead.
+static void GetDataFilesSearchPaths(ManifestFileType type, const std::string &override_env_var, const std::string &relative_path,
+                                    bool &override_active, bool &is_directory_list, std::vector<std::string> &search_paths) {
     bool is_runtime = (type == MANIFEST_TYPE_RUNTIME);
-    char *override_env = nullptr;
+    bool override_env_set = false;
     std::string override_path = "";
-    std::string search_path = "";
+    is_directory_list = true;
+    search_paths.clear();
 
     try {
         if (override_env_var.size() != 0) {
 #ifndef XR_OS_WINDOWS
             if (geteuid() != getuid() || getegid() != getgid()) {
                 // Don't allow setuid apps to use the env var:
-                override_env = nullptr;
+                override_env_set = false;
             } else
 #endif
             {
-                override_env = PlatformUtilsGetSecureEnv(override_env_var.c_str());
-                if (nullptr != override_env) {
+                override_env_set = LoaderEnvironment::GetSecure(override_env_var, override_path);
+                if (override_env_set) {
                     // The runtime override is actually a specific list of filenames, not directories
                     if (is_runtime) {
                         is_directory_list = false;
                     }
-                    override_path = override_env;
                 }
             }
         }
 
-        if (nullptr != override_env && override_path.size() != 0) {
-            CopyIncludedPaths(is_directory_list, override_path, "", search_path);
-            PlatformUtilsFreeEnv(override_env);
+        if (override_env_set && override_path.size() != 0) {
+            CopyIncludedPaths(is_directory_list, override_path, "", search_paths);
             override_active = true;
         } else {
             override_active = false;
 #ifndef XR_OS_WINDOWS
-            bool xdg_conf_dirs_alloc = true;
-            bool xdg_data_dirs_alloc = true;
             const char home_additional[] = ".local/share/";
 
             // Determine how much space is needed to generate the full search path
             // for the current manifest files.
-            char *xdg_conf_dirs = PlatformUtilsGetSecureEnv("XDG_CONFIG_DIRS");
-            char *xdg_data_dirs = PlatformUtilsGetSecureEnv("XDG_DATA_DIRS");
-            char *xdg_data_home = PlatformUtilsGetSecureEnv("XDG_DATA_HOME");
-            char *home = PlatformUtilsGetSecureEnv("HOME");
-
-            if (nullptr == xdg_conf_dirs) {
-                xdg_conf_dirs_alloc = false;
-            }
-            if (nullptr == xdg_data_dirs) {
-                xdg_data_dirs_alloc = false;
-            }
-
-            if (nullptr == xdg_conf_dirs || xdg_conf_dirs[0] == '\0') {
-                CopyIncludedPaths(true, FALLBACK_CONFIG_DIRS, relative_path, search_path);
+            std::string xdg_conf_dirs;
+            std::string xdg_data_dirs;
+            std::string xdg_data_home;
+            std::string home;
+            LoaderEnvironment::GetSecure("XDG_CONFIG_DIRS", xdg_conf_dirs);
+            LoaderEnvironment::GetSecure("XDG_DATA_DIRS", xdg_data_dirs);
+            bool xdg_data_home_set = LoaderEnvironment::GetSecure("XDG_DATA_HOME", xdg_data_home);
+            bool home_set = LoaderEnvironment::GetSecure("HOME", home);
+
+            if (xdg_conf_dirs.empty()) {
+                CopyIncludedPaths(true, FALLBACK_CONFIG_DIRS, relative_path, search_paths);
             } else {
-                CopyIncludedPaths(true, xdg_conf_dirs, relative_path, search_path);
+                CopyIncludedPaths(true, xdg_conf_dirs, relative_path, search_paths);
             }
 
-            CopyIncludedPaths(true, SYSCONFDIR, relative_path, search_path);
+            CopyIncludedPaths(true, SYSCONFDIR, relative_path, search_paths);
 #if defined(EXTRASYSCONFDIR)
-            CopyIncludedPaths(true, EXTRASYSCONFDIR, relative_path, search_path);
+            CopyIncludedPaths(true, EXTRASYSCONFDIR, relative_path, search_paths);
 #endif
 
-            if (xdg_data_dirs == nullptr || xdg_data_dirs[0] == '\0') {
-                CopyIncludedPaths(true, FALLBACK_DATA_DIRS, relative_path, search_path);
+            if (xdg_data_dirs.empty()) {
+                CopyIncludedPaths(true, FALLBACK_DATA_DIRS, relative_path, search_paths);
             } else {
-                CopyIncludedPaths(true, xdg_data_dirs, relative_path, search_path);
+                CopyIncludedPaths(true, xdg_data_dirs, relative_path, search_paths);
             }
 
-            if (nullptr != xdg_data_home) {
-                CopyIncludedPaths(true, xdg_data_home, relative_path, search_path);
-            } else if (nullptr != home) {
+            if (xdg_data_home_set) {
+                CopyIncludedPaths(true, xdg_data_home, relative_path, search_paths);
+            } else if (home_set) {
                 std::string relative_home_path = home_additional;
                 relative_home_path += relative_path;
-                CopyIncludedPaths(true, home, relative_home_path, search_path);
-            }
-
-            if (xdg_conf_dirs_alloc) {
-                PlatformUtilsFreeEnv(xdg_conf_dirs);
-            }
-            if (xdg_data_dirs_alloc) {
-                PlatformUtilsFreeEnv(xdg_data_dirs);
-            }
-            if (nullptr != xdg_data_home) {
-                PlatformUtilsFreeEnv(xdg_data_home);
-            }
-            if (nullptr != home) {
-                PlatformUtilsFreeEnv(home);
+                CopyIncludedPaths(true, home, relative_home_path, search_paths);
             }
 #endif
         }
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("", "GetDataFilesSearchPaths - unknown error occurred");
+        throw;
+    }
+}
+
+// Look for data files in the provided paths, but first check the environment override to determine if we should use that instead.
+static void ReadDataFilesInSearchPaths(ManifestFileType type, const std::string &override_env_var, const std::string &relative_path,
+                                       bool &override_active, std::vector<std::string> &manifest_files) {
+    try {
+        bool is_directory_list = true;
+        std::vector<std::string> search_paths;
+        GetDataFilesSearchPaths(type, override_env_var, relative_path, override_active, is_directory_list, search_paths);
 
         // Now, parse the paths and add any manifest files found in them.
-        AddFilesInPath(type, search_path, is_directory_list, manifest_files);
+        AddFilesInPath(type, search_paths, is_directory_list, manifest_files);
     } catch (...) {
         LoaderLogger::LogErrorMessage("", "ReadDataFilesInSearchPaths - unknown error occurred");
         throw;
@@ -308,7 +323,9 @@ static void ReadRuntimeDataFilesInRegistry(ManifestFileType type, const std::str
         } else if (ERROR_SUCCESS == RegQueryValueEx(hkey, default_runtime_value_name.c_str(), NULL, NULL,
                                                     reinterpret_cast<LPBYTE>(&value), &value_size) &&
                    value_size < 1024) {
-            AddFilesInPath(type, value, false, manifest_files);
+            std::vector<std::string> registry_paths;
+            SplitSearchPath(value, registry_paths);
+            AddFilesInPath(type, registry_paths, false, manifest_files);
         }
     } catch (...) {
         LoaderLogger::LogErrorMessage("", "ReadLayerDataFilesInRegistry - unknown error occurred");
@@ -352,8 +369,8 @@ static void ReadLayerDataFilesInRegistry(ManifestFileType type, const std::strin
             while (ERROR_SUCCESS ==
                    (rtn_value = RegEnumValue(hkey, key_index++, name, &name_size, NULL, NULL, (LPBYTE)&value, &value_size))) {
                 if (value_size == sizeof(value) && value == 0) {
-                    std::string filename = name;
-                    AddFilesInPath(type, filename, false, manifest_files);
+                    std::vector<std::string> registry_paths(1, name);
+                    AddFilesInPath(type, registry_paths, false, manifest_files);
                 }
                 // Reset some items for the next loop
                 name_size = 1023;
@@ -368,7 +385,11 @@ static void ReadLayerDataFilesInRegistry(ManifestFileType type, const std::strin
 #endif  // XR_OS_WINDOWS
 
 ManifestFile::ManifestFile(ManifestFileType type, const std::string &filename, const std::string &library_path)
-    : _filename(filename), _type(type), _library_path(library_path) {}
+    : _filename(filename),
+      _type(type),
+      _library_path(library_path),
+      _declares_instance_extensions(false),
+      _footprint(LOADER_MEMORY_CATEGORY_MANIFEST) {}
 
 ManifestFile::~ManifestFile() {}
 
@@ -402,32 +423,33 @@ bool ManifestFile::IsValidJson(Json::Value &root_node, JsonVersion &version) {
     return true;
 }
 
+// An estimate, from the capacity of each container and string, which includes any bytes a string keeps inline.
+void ManifestFile::UpdateFootprint() {
+    size_t bytes = sizeof(*this) + _filename.capacity() + _library_path.capacity();
+    for (const std::vector<ExtensionListing> *extensions : {&_instance_extensions, &_device_extensions}) {
+        bytes += extensions->capacity() * sizeof(ExtensionListing);
+        for (const ExtensionListing &ext : *extensions) {
+            bytes += ext.name.capacity() + ext.entrypoints.capacity() * sizeof(std::string);
+            for (const std::string &entrypoint : ext.entrypoints) {
+                bytes += entrypoint.capacity();
+            }
+        }
+    }
+    bytes += _functions_renamed.bucket_count() * sizeof(void *);
+    for (const auto &renamed : _functions_renamed) {
+        // Each node also holds a next pointer and the cached hash
+        bytes += sizeof(renamed) + 2 * sizeof(void *) + renamed.first.capacity() + renamed.second.capacity();
+    }
+    _footprint.Set(bytes);
+}
+
 // Return any instance extensions found in the manifest files in the proper form for
 // OpenXR (XrExtensionProperties).
 void ManifestFile::GetInstanceExtensionProperties(std::vector<XrExtensionProperties> &props) {
     try {
-        size_t ext_count = _instance_extensions.size();
-        size_t props_count = props.size();
-        bool found = false;
-        for (size_t ext = 0; ext < ext_count; ++ext) {
-            for (size_t prop = 0; prop < props_count; ++prop) {
-                if (!strcmp(props[prop].extensionName, _instance_extensions[ext].name.c_str())) {
-                    if (props[prop].specVersion < _instance_extensions[ext].spec_version) {
-                        props[prop].specVersion = _instance_extensions[ext].spec_version;
-                        found = true;
-                        break;
-                    }
-                }
-            }
-            if (!found) {
-                XrExtensionProperties prop = {};
-                prop.type = XR_TYPE_EXTENSION_PROPERTIES;
-                prop.next = nullptr;
-                strncpy(prop.extensionName, _instance_extensions[ext].name.c_str(), XR_MAX_EXTENSION_NAME_SIZE - 1);
-                prop.extensionName[XR_MAX_EXTENSION_NAME_SIZE - 1] = '\0';
-                prop.specVersion = _instance_extensions[ext].spec_version;
-                props.push_back(prop);
-            }
+        ExtensionPropertiesMerge merge(props);
+        for (const ExtensionListing &ext : _instance_extensions) {
+            merge.Add(ext.name.c_str(), ext.spec_version);
         }
     } catch (...) {
         LoaderLogger::LogErrorMessage("", "ManifestFile::GetInstanceExtensionProperties - unknown error occurred");
@@ -439,28 +461,9 @@ void ManifestFile::GetInstanceExtensionProperties(std::vector<XrExtensionPropert
 // OpenXR (XrExtensionProperties).
 void ManifestFile::GetDeviceExtensionProperties(std::vector<XrExtensionProperties> &props) {
     try {
-        size_t ext_count = _device_extensions.size();
-        size_t props_count = props.size();
-        bool found = false;
-        for (size_t ext = 0; ext < ext_count; ++ext) {
-            for (size_t prop = 0; prop < props_count; ++prop) {
-                if (!strcmp(props[prop].extensionName, _device_extensions[ext].name.c_str())) {
-                    if (props[prop].specVersion < _device_extensions[ext].spec_version) {
-                        props[prop].specVersion = _device_extensions[ext].spec_version;
-                        found = true;
-                        break;
-                    }
-                }
-            }
-            if (!found) {
-                XrExtensionProperties prop = {};
-                prop.type = XR_TYPE_EXTENSION_PROPERTIES;
-                prop.next = nullptr;
-                strncpy(prop.extensionName, _device_extensions[ext].name.c_str(), XR_MAX_EXTENSION_NAME_SIZE - 1);
-                prop.extensionName[XR_MAX_EXTENSION_NAME_SIZE - 1] = '\0';
-                prop.specVersion = _device_extensions[ext].spec_version;
-                props.push_back(prop);
-            }
+        ExtensionPropertiesMerge merge(props);
+        for (const ExtensionListing &ext : _device_extensions) {
+            merge.Add(ext.name.c_str(), ext.spec_version);
         }
     } catch (...) {
         LoaderLogger::LogErrorMessage("", "ManifestFile::GetDeviceExtensionProperties - unknown error occurred");
@@ -483,6 +486,96 @@ const std::string &ManifestFile::GetFunctionName(const std::string &func_name) {
     return func_name;
 }
 
+// A file or directory whose state a cached result was derived from.
+struct FileDependency {
+    std::string path;
+    bool exists;
+    FileSysUtilsFileStamp stamp;
+};
+
+static void AddFileDependency(const std::string &path, std::vector<FileDependency> &dependencies) {
+    FileDependency dependency = {};
+    dependency.path = path;
+    dependency.exists = FileSysUtilsGetFileStamp(path, dependency.stamp);
+    dependencies.push_back(dependency);
+}
+
+static bool FileDependenciesUnchanged(const std::vector<FileDependency> &dependencies) {
+    for (const FileDependency &dependency : dependencies) {
+        FileSysUtilsFileStamp current_stamp = {};
+        bool exists = FileSysUtilsGetFileStamp(dependency.path, current_stamp);
+        if (exists != dependency.exists || (exists && current_stamp != dependency.stamp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Results of earlier runtime manifest searches.  The resolved manifest file names stay valid for as long as the
+// environment snapshot, the searched paths and the files found are unchanged, each parsed manifest for as long as
+// its own file is.
+struct RuntimeManifestCache {
+    std::mutex mutex;
+    bool filenames_valid = false;
+    uint64_t environment_generation = 0;
+    bool override_active = false;
+    std::vector<std::string> filenames;
+    std::vector<FileDependency> filename_dependencies;
+    std::unordered_map<std::string, std::pair<FileSysUtilsFileStamp, std::unique_ptr<RuntimeManifestFile>>> manifests;
+};
+
+static RuntimeManifestCache &GetRuntimeManifestCache() {
+    static RuntimeManifestCache runtime_manifest_cache;
+    return runtime_manifest_cache;
+}
+
+static bool ReadCachedRuntimeFilenames(uint64_t environment_generation, bool &override_active,
+                                       std::vector<std::string> &filenames) {
+    RuntimeManifestCache &cache = GetRuntimeManifestCache();
+    std::lock_guard<std::mutex> cache_lock(cache.mutex);
+    if (!cache.filenames_valid || cache.environment_generation != environment_generation ||
+        !FileDependenciesUnchanged(cache.filename_dependencies)) {
+        return false;
+    }
+    override_active = cache.override_active;
+    filenames = cache.filenames;
+    return true;
+}
+
+static void UpdateCachedRuntimeFilenames(uint64_t environment_generation, bool override_active,
+                                         const std::vector<std::string> &search_paths, const std::vector<std::string> &filenames) {
+    RuntimeManifestCache &cache = GetRuntimeManifestCache();
+    std::lock_guard<std::mutex> cache_lock(cache.mutex);
+    cache.filenames_valid = true;
+    cache.environment_generation = environment_generation;
+    cache.override_active = override_active;
+    cache.filenames = filenames;
+    cache.filename_dependencies.clear();
+    for (const std::string &search_path : search_paths) {
+        AddFileDependency(search_path, cache.filename_dependencies);
+    }
+    for (const std::string &filename : filenames) {
+        AddFileDependency(filename, cache.filename_dependencies);
+    }
+    // A fresh search is also when parsed manifests of files that have since been removed get dropped.
+    for (auto cached = cache.manifests.begin(); cached != cache.manifests.end();) {
+        if (FileSysUtilsPathExists(cached->first)) {
+            ++cached;
+        } else {
+            cached = cache.manifests.erase(cached);
+        }
+    }
+}
+
+// A library path with a directory in it was checked to exist when the manifest was parsed, and has to still exist
+// for the cached manifest to stand in for parsing it again.
+static bool CachedLibraryPathValid(const std::string &library_path) {
+    if (library_path.find('\\') == std::string::npos && library_path.find('/') == std::string::npos) {
+        return true;
+    }
+    return FileSysUtilsPathExists(library_path);
+}
+
 RuntimeManifestFile::RuntimeManifestFile(const std::string &filename, const std::string &library_path)
     : ManifestFile(MANIFEST_TYPE_RUNTIME, filename, library_path) {}
 
@@ -490,8 +583,42 @@ RuntimeManifestFile::~RuntimeManifestFile() {}
 
 void RuntimeManifestFile::CreateIfValid(std::string filename, std::vector<std::unique_ptr<RuntimeManifestFile>> &manifest_files) {
     try {
-        std::ifstream json_stream = std::ifstream(filename, std::ifstream::in);
-        if (!json_stream.is_open()) {
+        FileSysUtilsFileStamp stamp = {};
+        bool has_stamp = FileSysUtilsGetFileStamp(filename, stamp);
+        RuntimeManifestCache &cache = GetRuntimeManifestCache();
+        {
+            std::lock_guard<std::mutex> cache_lock(cache.mutex);
+            auto cached = cache.manifests.find(filename);
+            if (cached != cache.manifests.end()) {
+                if (has_stamp && cached->second.first == stamp && CachedLibraryPathValid(cached->second.second->LibraryPath())) {
+                    manifest_files.emplace_back(new RuntimeManifestFile(*cached->second.second));
+                    return;
+                }
+                cache.manifests.erase(cached);
+            }
+        }
+
+        std::size_t manifest_count = manifest_files.size();
+        {
+            LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_MANIFEST_PARSING);
+            ParseIfValid(filename, manifest_files);
+        }
+        if (has_stamp && manifest_files.size() > manifest_count) {
+            std::lock_guard<std::mutex> cache_lock(cache.mutex);
+            cache.manifests[filename] = std::make_pair(
+                stamp, std::unique_ptr<RuntimeManifestFile>(new RuntimeManifestFile(*manifest_files.back())));
+        }
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("", "RuntimeManifestFile::CreateIfValid - unknown error occurred");
+        throw;
+    }
+}
+
+void RuntimeManifestFile::ParseIfValid(const std::string &filename,
+                                       std::vector<std::unique_ptr<RuntimeManifestFile>> &manifest_files) {
+    try {
+        FileSysUtilsMappedFile json_file;
+        if (!json_file.Open(filename)) {
             std::string error_message = "RuntimeManifestFile::createIfValid failed to open ";
             error_message += filename;
             error_message += ".  Does it exist?";
@@ -502,7 +629,7 @@ void RuntimeManifestFile::CreateIfValid(std::string filename, std::vector<std::u
         Json::Value root_node = Json::nullValue;
         Json::Value runtime_root_node = Json::nullValue;
         JsonVersion file_version = {};
-        if (!reader.parse(json_stream, root_node, false) || root_node.isNull()) {
+        if (!reader.parse(json_file.Data(), json_file.Data() + json_file.Size(), root_node, false) || root_node.isNull()) {
             std::string error_message = "RuntimeManifestFile::CreateIfValid failed to parse ";
             error_message += filename;
             error_message += ".  Is it a valid runtime manifest file?";
@@ -592,6 +719,8 @@ void RuntimeManifestFile::CreateIfValid(std::string filename, std::vector<std::u
 
         Json::Value inst_exts = runtime_root_node["instance_extensions"];
         if (!inst_exts.isNull() && inst_exts.isArray()) {
+            // The list can only stand in for asking the runtime when every entry in it is usable.
+            bool all_parsed = true;
             for (Json::ValueIterator inst_ext_it = inst_exts.begin(); inst_ext_it != inst_exts.end(); ++inst_ext_it) {
                 Json::Value inst_ext = (*inst_ext_it);
                 Json::Value inst_ext_name = inst_ext["name"];
@@ -602,8 +731,18 @@ void RuntimeManifestFile::CreateIfValid(std::string filename, std::vector<std::u
                     ext.name = inst_ext_name.asString();
                     ext.spec_version = inst_ext_version.asUInt();
                     manifest_files.back()->_instance_extensions.push_back(ext);
+                } else {
+                    all_parsed = false;
                 }
             }
+            if (all_parsed) {
+                manifest_files.back()->_declares_instance_extensions = true;
+            } else {
+                std::string warning_message = "RuntimeManifestFile::CreateIfValid ";
+                warning_message += filename;
+                warning_message += " \"instance_extensions\" section contains invalid entries, the runtime will be asked instead.";
+                LoaderLogger::LogWarningMessage("", warning_message);
+            }
         }
 
         Json::Value funcs_renamed = runtime_root_node["functions"];
@@ -621,8 +760,9 @@ void RuntimeManifestFile::CreateIfValid(std::string filename, std::vector<std::u
                 manifest_files.back()->_functions_renamed.insert(std::make_pair(original_name, new_name));
             }
         }
+        manifest_files.back()->UpdateFootprint();
     } catch (...) {
-        LoaderLogger::LogErrorMessage("", "RuntimeManifestFile::CreateIfValid - unknown error occurred");
+        LoaderLogger::LogErrorMessage("", "RuntimeManifestFile::ParseIfValid - unknown error occurred");
         throw;
     }
 }
@@ -632,30 +772,46 @@ XrResult RuntimeManifestFile::FindManifestFiles(ManifestFileType type,
                                                 std::vector<std::unique_ptr<RuntimeManifestFile>> &manifest_files) {
     XrResult result = XR_SUCCESS;
     try {
+        LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_MANIFEST_DISCOVERY);
         if (MANIFEST_TYPE_RUNTIME != type) {
             LoaderLogger::LogErrorMessage("", "RuntimeManifestFile::FindManifestFiles - unknown manifest file requested");
             throw std::runtime_error("invalid manifest type");
         }
         bool override_active = false;
         std::vector<std::string> filenames;
-        ReadDataFilesInSearchPaths(type, OPENXR_RUNTIME_JSON_ENV_VAR, "", override_active, filenames);
-        if (!override_active) {
+        uint64_t environment_generation = LoaderEnvironment::Generation();
+        if (!ReadCachedRuntimeFilenames(environment_generation, override_active, filenames)) {
+            bool is_directory_list = true;
+            std::vector<std::string> search_paths;
+            GetDataFilesSearchPaths(type, OPENXR_RUNTIME_JSON_ENV_VAR, "", override_active, is_directory_list, search_paths);
+            AddFilesInPath(type, search_paths, is_directory_list, filenames);
+            if (!override_active) {
 #ifdef XR_OS_WINDOWS
-            ReadRuntimeDataFilesInRegistry(type, "", "ActiveRuntime", filenames);
-            if (filenames.size() == 0) {
-                LoaderLogger::LogErrorMessage(
-                    "", "RuntimeManifestFile::findManifestFiles - failed to find active runtime file in registry");
-                return XR_ERROR_FILE_ACCESS_ERROR;
-            }
-            if (filenames.size() > 1) {
-                LoaderLogger::LogWarningMessage(
-                    "", "RuntimeManifestFile::findManifestFiles - found too many default runtime files in registry");
-            }
+                ReadRuntimeDataFilesInRegistry(type, "", "ActiveRuntime", filenames);
+                if (filenames.size() == 0) {
+                    LoaderLogger::LogErrorMessage(
+                        "", "RuntimeManifestFile::findManifestFiles - failed to find active runtime file in registry");
+                    return XR_ERROR_FILE_ACCESS_ERROR;
+                }
+                if (filenames.size() > 1) {
+                    LoaderLogger::LogWarningMessage(
+                        "", "RuntimeManifestFile::findManifestFiles - found too many default runtime files in registry");
+                }
 #else
-            std::string global_rt_filename;
-            PlatformGetGlobalRuntimeFileName(XR_VERSION_MAJOR(XR_CURRENT_API_VERSION), global_rt_filename);
-            filenames.push_back(global_rt_filename);
+                std::string global_rt_filename;
+                PlatformGetGlobalRuntimeFileName(XR_VERSION_MAJOR(XR_CURRENT_API_VERSION), global_rt_filename);
+                filenames.push_back(global_rt_filename);
 #endif
+            }
+#ifdef XR_OS_WINDOWS
+            // Registry changes aren't tracked, so only a resolution made from the environment can be reused.
+            if (override_active)
+#endif
+            {
+                UpdateCachedRuntimeFilenames(environment_generation, override_active, search_paths, filenames);
+            }
+        }
+        if (!override_active) {
             std::string info_message = "RuntimeManifestFile::FindManifestFiles - using global runtime file ";
             info_message += filenames[0];
             LoaderLogger::LogInfoMessage("", info_message);
@@ -687,14 +843,24 @@ ApiLayerManifestFile::ApiLayerManifestFile(ManifestFileType type, const std::str
       _api_version(api_version),
       _layer_name(layer_name),
       _description(description),
-      _implementation_version(implementation_version) {}
+      _implementation_version(implementation_version),
+      _declares_intercepted_functions(false) {}
 
 ApiLayerManifestFile::~ApiLayerManifestFile() {}
 
 void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, std::string filename,
-                                         std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files) {
+                                         std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files,
+                                         std::vector<std::string> *environment_dependencies) {
     try {
-        std::ifstream json_stream = std::ifstream(filename, std::ifstream::in);
+        LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_MANIFEST_PARSING);
+        FileSysUtilsMappedFile json_file;
+        if (!json_file.Open(filename)) {
+            std::string error_message = "ApiLayerManifestFile::CreateIfValid failed to open ";
+            error_message += filename;
+            error_message += ".  Does it exist?";
+            LoaderLogger::LogErrorMessage("", error_message);
+            return;
+        }
         Json::Reader reader;
         Json::Value root_node = Json::nullValue;
         JsonVersion file_version = {};
@@ -702,7 +868,7 @@ void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, std::string file
         std::string layer_name = "";
         std::string library_path = "";
         std::string description = "";
-        if (!reader.parse(json_stream, root_node, false) || root_node.isNull()) {
+        if (!reader.parse(json_file.Data(), json_file.Data() + json_file.Size(), root_node, false) || root_node.isNull()) {
             std::string error_message = "ApiLayerManifestFile::CreateIfValid failed to parse ";
             error_message += filename;
             error_message += ".  Is it a valid layer manifest file?";
@@ -743,20 +909,22 @@ void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, std::string file
             }
             // Check if there's an enable environment variable provided
             if (!layer_root_node["enable_environment"].isNull() && layer_root_node["enable_environment"].isString()) {
-                char *enable_val = PlatformUtilsGetEnv(layer_root_node["enable_environment"].asString().c_str());
+                if (nullptr != environment_dependencies) {
+                    environment_dependencies->push_back(layer_root_node["enable_environment"].asString());
+                }
                 // If it's not set in the environment, disable the layer
-                if (NULL == enable_val) {
+                if (!LoaderEnvironment::IsSet(layer_root_node["enable_environment"].asString())) {
                     enabled = false;
                 }
-                PlatformUtilsFreeEnv(enable_val);
             }
             // Check for the disable environment variable, which must be provided in the JSON
-            char *disable_val = PlatformUtilsGetEnv(layer_root_node["disable_environment"].asString().c_str());
+            if (nullptr != environment_dependencies) {
+                environment_dependencies->push_back(layer_root_node["disable_environment"].asString());
+            }
             // If the envar is set, disable the layer. Disable envar overrides enable above
-            if (NULL != disable_val) {
+            if (LoaderEnvironment::IsSet(layer_root_node["disable_environment"].asString())) {
                 enabled = false;
             }
-            PlatformUtilsFreeEnv(disable_val);
 
             // Not enabled, so pretend like it isn't even there.
             if (!enabled) {
@@ -879,6 +1047,30 @@ void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, std::string file
                 manifest_files.back()->_functions_renamed.insert(std::make_pair(original_name, new_name));
             }
         }
+
+        // Commands the layer wants to be called for.  The loader routes every other command past it.
+        Json::Value intercepted_funcs = layer_root_node["intercepted_functions"];
+        if (!intercepted_funcs.isNull()) {
+            if (!intercepted_funcs.isArray()) {
+                std::string warning_message = "ApiLayerManifestFile::CreateIfValid ";
+                warning_message += filename;
+                warning_message += " \"intercepted_functions\" is not an array, assuming the layer intercepts everything.";
+                LoaderLogger::LogWarningMessage("", warning_message);
+            } else {
+                manifest_files.back()->_declares_intercepted_functions = true;
+                for (Json::ValueIterator func_it = intercepted_funcs.begin(); func_it != intercepted_funcs.end(); ++func_it) {
+                    if (!(*func_it).isString()) {
+                        std::string warning_message = "ApiLayerManifestFile::CreateIfValid ";
+                        warning_message += filename;
+                        warning_message += " \"intercepted_functions\" section contains non-string values.";
+                        LoaderLogger::LogWarningMessage("", warning_message);
+                        continue;
+                    }
+                    manifest_files.back()->_intercepted_functions.push_back(func_it->asString());
+                }
+            }
+        }
+        manifest_files.back()->UpdateFootprint();
     } catch (...) {
         LoaderLogger::LogErrorMessage("", "ApiLayerManifestFile::CreateIfValid - unknown error occurred");
         throw;
@@ -907,37 +1099,53 @@ XrApiLayerProperties ApiLayerManifestFile::GetApiLayerProperties() {
     }
 }
 
+// Determine the relative search path, override environment variable and registry location for an API layer manifest type.
+static bool GetApiLayerSearchLocation(ManifestFileType type, std::string &relative_path, std::string &override_env_var,
+                                      std::string &registry_location) {
+    // Add the appropriate top-level folders for the relative path.  These should be
+    // the string "openxr/" followed by the API major version as a string.
+    relative_path = OPENXR_RELATIVE_PATH;
+    relative_path += std::to_string(XR_VERSION_MAJOR(XR_CURRENT_API_VERSION));
+    registry_location = "";
+
+    switch (type) {
+        case MANIFEST_TYPE_IMPLICIT_API_LAYER:
+            relative_path += OPENXR_IMPLICIT_API_LAYER_RELATIVE_PATH;
+            override_env_var = "";
+#ifdef XR_OS_WINDOWS
+            registry_location = OPENXR_IMPLICIT_API_LAYER_REGISTRY_LOCATION;
+#endif
+            return true;
+        case MANIFEST_TYPE_EXPLICIT_API_LAYER:
+            relative_path += OPENXR_EXPLICIT_API_LAYER_RELATIVE_PATH;
+            override_env_var = OPENXR_API_LAYER_PATH_ENV_VAR;
+#ifdef XR_OS_WINDOWS
+            registry_location = OPENXR_EXPLICIT_API_LAYER_REGISTRY_LOCATION;
+#endif
+            return true;
+        default:
+            return false;
+    }
+}
+
 // Find all layer manifest files in the appropriate search paths/registries for the given type.
 XrResult ApiLayerManifestFile::FindManifestFiles(ManifestFileType type,
                                                  std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files) {
+    return FindManifestFiles(type, manifest_files, nullptr);
+}
+
+XrResult ApiLayerManifestFile::FindManifestFiles(ManifestFileType type,
+                                                 std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files,
+                                                 std::vector<std::string> *environment_dependencies) {
     try {
+        LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_MANIFEST_DISCOVERY);
         std::string relative_path;
         std::string override_env_var;
-        std::string registry_location = "";
+        std::string registry_location;
 
-        // Add the appropriate top-level folders for the relative path.  These should be
-        // the string "openxr/" followed by the API major version as a string.
-        relative_path = OPENXR_RELATIVE_PATH;
-        relative_path += std::to_string(XR_VERSION_MAJOR(XR_CURRENT_API_VERSION));
-
-        switch (type) {
-            case MANIFEST_TYPE_IMPLICIT_API_LAYER:
-                relative_path += OPENXR_IMPLICIT_API_LAYER_RELATIVE_PATH;
-                override_env_var = "";
-#ifdef XR_OS_WINDOWS
-                registry_location = OPENXR_IMPLICIT_API_LAYER_REGISTRY_LOCATION;
-#endif
-                break;
-            case MANIFEST_TYPE_EXPLICIT_API_LAYER:
-                relative_path += OPENXR_EXPLICIT_API_LAYER_RELATIVE_PATH;
-                override_env_var = OPENXR_API_LAYER_PATH_ENV_VAR;
-#ifdef XR_OS_WINDOWS
-                registry_location = OPENXR_EXPLICIT_API_LAYER_REGISTRY_LOCATION;
-#endif
-                break;
-            default:
-                LoaderLogger::LogErrorMessage("", "ApiLayerManifestFile::FindManifestFiles - unknown manifest file requested");
-                throw std::runtime_error("invalid manifest type");
+        if (!GetApiLayerSearchLocation(type, relative_path, override_env_var, registry_location)) {
+            LoaderLogger::LogErrorMessage("", "ApiLayerManifestFile::FindManifestFiles - unknown manifest file requested");
+            throw std::runtime_error("invalid manifest type");
         }
 
         bool override_active = false;
@@ -951,15 +1159,8 @@ XrResult ApiLayerManifestFile::FindManifestFiles(ManifestFileType type,
         }
 #endif
 
-        switch (type) {
-            case MANIFEST_TYPE_IMPLICIT_API_LAYER:
-            case MANIFEST_TYPE_EXPLICIT_API_LAYER:
-                for (std::string &cur_file : filenames) {
-                    ApiLayerManifestFile::CreateIfValid(type, cur_file, manifest_files);
-                }
-                break;
-            default:
-                break;
+        for (std::string &cur_file : filenames) {
+            ApiLayerManifestFile::CreateIfValid(type, cur_file, manifest_files, environment_dependencies);
         }
 
     } catch (std::bad_alloc &) {
@@ -971,3 +1172,177 @@ XrResult ApiLayerManifestFile::FindManifestFiles(ManifestFileType type,
     }
     return XR_SUCCESS;
 }
+
+// Resolve the individual paths that FindManifestFiles would search for the given type, without reading them.
+XrResult ApiLayerManifestFile::GetSearchPaths(ManifestFileType type, std::vector<std::string> &search_paths) {
+    try {
+        std::string relative_path;
+        std::string override_env_var;
+        std::string registry_location;
+
+        if (!GetApiLayerSearchLocation(type, relative_path, override_env_var, registry_location)) {
+            LoaderLogger::LogErrorMessage("", "ApiLayerManifestFile::GetSearchPaths - unknown manifest file requested");
+            return XR_ERROR_FILE_ACCESS_ERROR;
+        }
+
+        bool override_active = false;
+        bool is_directory_list = true;
+        std::vector<std::string> type_search_paths;
+        GetDataFilesSearchPaths(type, override_env_var, relative_path, override_active, is_directory_list, type_search_paths);
+        search_paths.insert(search_paths.end(), type_search_paths.begin(), type_search_paths.end());
+    } catch (std::bad_alloc &) {
+        LoaderLogger::LogErrorMessage("", "ApiLayerManifestFile::GetSearchPaths - memory allocation failed");
+        return XR_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("", "ApiLayerManifestFile::GetSearchPaths - unknown error occurred");
+        return XR_ERROR_FILE_ACCESS_ERROR;
+    }
+    return XR_SUCCESS;
+}
+
+ManifestFileWatcher::ManifestFileWatcher() : _inotify_fd(-1), _watching(false), _reported_unavailable(false) {}
+
+ManifestFileWatcher::~ManifestFileWatcher() { Reset(); }
+
+void ManifestFileWatcher::Reset() {
+#ifdef XR_OS_LINUX
+    if (_inotify_fd >= 0) {
+        close(_inotify_fd);
+        _inotify_fd = -1;
+    }
+#endif
+    _watching = false;
+}
+
+#ifdef XR_OS_LINUX
+
+bool ManifestFileWatcher::Watch(const std::vector<std::string> &search_paths) {
+    Reset();
+    try {
+        _inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (_inotify_fd < 0) {
+            if (!_reported_unavailable) {
+                std::string info_message = "ManifestFileWatcher::Watch - inotify unavailable (";
+                info_message += strerror(errno);
+                info_message += "), manifest files will be re-read every time";
+                LoaderLogger::LogInfoMessage("", info_message);
+                _reported_unavailable = true;
+            }
+            return false;
+        }
+        for (const std::string &search_path : search_paths) {
+            std::string watch_path = search_path;
+            uint32_t watch_mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO |
+                                  IN_DELETE_SELF | IN_MOVE_SELF;
+            // A search directory that doesn't exist yet may be created later, so watch the closest
+            // existing parent for anything being added to it.
+            while (!FileSysUtilsIsDirectory(watch_path)) {
+                while (watch_path.size() > 1 && watch_path.back() == DIRECTORY_SYMBOL) {
+                    watch_path.pop_back();
+                }
+                std::string::size_type last_separator = watch_path.find_last_of(DIRECTORY_SYMBOL);
+                if (last_separator == std::string::npos) {
+                    watch_path = ".";
+                    break;
+                }
+                watch_path = (last_separator == 0) ? std::string(1, DIRECTORY_SYMBOL) : watch_path.substr(0, last_separator);
+                watch_mask = IN_CREATE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+            }
+            if (!AddWatch(watch_path, watch_mask)) {
+                return false;
+            }
+            if (watch_path == search_path && !WatchLinkTargets(search_path)) {
+                return false;
+            }
+        }
+        _watching = true;
+    } catch (...) {
+        LoaderLogger::LogErrorMessage("", "ManifestFileWatcher::Watch - unknown error occurred");
+        Reset();
+    }
+    return _watching;
+}
+
+bool ManifestFileWatcher::AddWatch(const std::string &path, uint32_t mask) {
+    if (inotify_add_watch(_inotify_fd, path.c_str(), mask) >= 0) {
+        return true;
+    }
+    // Most likely fs.inotify.max_user_watches has been reached, give up on watching entirely.
+    if (!_reported_unavailable) {
+        std::string info_message = "ManifestFileWatcher::Watch - unable to watch ";
+        info_message += path;
+        info_message += " (";
+        info_message += strerror(errno);
+        info_message += "), manifest files will be re-read every time";
+        LoaderLogger::LogInfoMessage("", info_message);
+        _reported_unavailable = true;
+    }
+    Reset();
+    return false;
+}
+
+// A manifest can be a link to a file kept somewhere else, the usual layout for active_runtime.json, and
+// changes to that file don't show up in the search directory.  Watch the directory holding the final
+// target of every linked manifest as well.
+bool ManifestFileWatcher::WatchLinkTargets(const std::string &directory) {
+    std::vector<std::string> files;
+    if (!FileSysUtilsFindFilesInPath(directory, files)) {
+        return true;
+    }
+    for (const std::string &file : files) {
+        std::string full_path;
+        struct stat link_stat;
+        if (!StringEndsWith(file, ".json") || !FileSysUtilsCombinePaths(directory, file, full_path) ||
+            0 != lstat(full_path.c_str(), &link_stat) || !S_ISLNK(link_stat.st_mode)) {
+            continue;
+        }
+        // Nothing can be watched for a dangling link to be fixed, so don't watch at all.
+        char target_path[PATH_MAX];
+        std::string target_directory;
+        if (nullptr == realpath(full_path.c_str(), target_path) || !FileSysUtilsGetParentPath(target_path, target_directory)) {
+            Reset();
+            return false;
+        }
+        if (!AddWatch(target_directory, IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_FROM |
+                                            IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ManifestFileWatcher::HasChanged() {
+    if (!_watching) {
+        return true;
+    }
+    // We don't care what changed, only that something did, so just drain the queue.
+    alignas(struct inotify_event) char buffer[4096];
+    bool changed = false;
+    while (true) {
+        ssize_t length = read(_inotify_fd, buffer, sizeof(buffer));
+        if (length > 0) {
+            changed = true;
+            continue;
+        }
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            Reset();
+            return true;
+        }
+        break;
+    }
+    return changed;
+}
+
+#else  // !XR_OS_LINUX
+
+bool ManifestFileWatcher::Watch(const std::vector<std::string> &) {
+    Reset();
+    return false;
+}
+
+bool ManifestFileWatcher::HasChanged() { return true; }
+
+#endif  // XR_OS_LINUX
@@ -30,6 +30,8 @@
 
 #include <json/json.h>
 
+#include "loader_allocator.hpp"
+
 enum ManifestFileType {
     MANIFEST_TYPE_UNDEFINED = 0,
     MANIFEST_TYPE_RUNTIME,
@@ -63,17 +65,26 @@ class ManifestFile {
     ManifestFileType Type() { return _type; }
     std::string Filename() { return _filename; }
     std::string LibraryPath() { return _library_path; }
+    // Whether the manifest declared an "instance_extensions" list (which may be empty) with only valid entries
+    bool DeclaresInstanceExtensions() { return _declares_instance_extensions; }
     void GetInstanceExtensionProperties(std::vector<XrExtensionProperties> &props);
     void GetDeviceExtensionProperties(std::vector<XrExtensionProperties> &props);
     const std::string &GetFunctionName(const std::string &func_name);
 
    protected:
+    // Only used to hand out copies of cached manifests
+    ManifestFile(const ManifestFile &manifest_file) = default;
+    // Count what the parsed contents take up towards the loader's memory footprint
+    void UpdateFootprint();
+
     std::string _filename;
     ManifestFileType _type;
     std::string _library_path;
+    bool _declares_instance_extensions;
     std::vector<ExtensionListing> _instance_extensions;
     std::vector<ExtensionListing> _device_extensions;
     std::unordered_map<std::string, std::string> _functions_renamed;
+    LoaderMemoryFootprint _footprint;
 };
 
 // RuntimeManifestFile class -
@@ -89,6 +100,10 @@ class RuntimeManifestFile : public ManifestFile {
 
     // We don't want any copy constructors
     RuntimeManifestFile &operator=(const RuntimeManifestFile &manifest_file) = delete;
+
+   private:
+    RuntimeManifestFile(const RuntimeManifestFile &manifest_file) = default;
+    static void ParseIfValid(const std::string &filename, std::vector<std::unique_ptr<RuntimeManifestFile>> &manifest_files);
 };
 
 // ApiLayerManifestFile class -
@@ -97,23 +112,63 @@ class ApiLayerManifestFile : public ManifestFile {
    public:
     // Factory method
     static XrResult FindManifestFiles(ManifestFileType type, std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files);
+    // Factory method that also records the environment variables that enabled or disabled implicit layers
+    static XrResult FindManifestFiles(ManifestFileType type, std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files,
+                                      std::vector<std::string> *environment_dependencies);
+    static XrResult GetSearchPaths(ManifestFileType type, std::vector<std::string> &search_paths);
 
     ApiLayerManifestFile(ManifestFileType type, const std::string &filename, const std::string &layer_name,
                          const std::string &description, const JsonVersion &api_version, const uint32_t &implementation_version,
                          const std::string &library_path);
     virtual ~ApiLayerManifestFile();
     static void CreateIfValid(ManifestFileType type, std::string filename,
-                              std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files);
+                              std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files,
+                              std::vector<std::string> *environment_dependencies);
 
     // We don't want any copy constructors
     ApiLayerManifestFile &operator=(const ApiLayerManifestFile &manifest_file) = delete;
 
     std::string LayerName() { return _layer_name; }
     XrApiLayerProperties GetApiLayerProperties();
+    // Whether the manifest declared an "intercepted_functions" list.  Without one the layer intercepts everything.
+    bool DeclaresInterceptedFunctions() { return _declares_intercepted_functions; }
+    const std::vector<std::string> &InterceptedFunctions() { return _intercepted_functions; }
 
    private:
     JsonVersion _api_version;
     std::string _layer_name;
     std::string _description;
     uint32_t _implementation_version;
+    bool _declares_intercepted_functions;
+    std::vector<std::string> _intercepted_functions;
+};
+
+// ManifestFileWatcher class -
+// Watches manifest search paths, and the targets of any linked manifests in them, so callers can
+// tell whether anything in them may have changed since the watch was set up.  Only implemented on
+// Linux (inotify); everywhere else, and whenever the watch can't be established, every query
+// reports a change.
+class ManifestFileWatcher {
+   public:
+    ManifestFileWatcher();
+    ~ManifestFileWatcher();
+
+    // We don't want any copy constructors
+    ManifestFileWatcher(const ManifestFileWatcher &) = delete;
+    ManifestFileWatcher &operator=(const ManifestFileWatcher &) = delete;
+
+    // Replace any existing watches with ones covering the provided search paths
+    bool Watch(const std::vector<std::string> &search_paths);
+    // Consume pending notifications, returning true if the watched paths may have changed
+    bool HasChanged();
+    bool IsWatching() const { return _watching; }
+
+   private:
+    void Reset();
+    bool AddWatch(const std::string &path, uint32_t mask);
+    bool WatchLinkTargets(const std::string &directory);
+
+    int _inotify_fd;
+    bool _watching;
+    bool _reported_unavailable;
 };
@@ -16,30 +16,250 @@
 //
 // Author: Mark Young <marky@lunarg.com>
 //
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
+#include "filesystem_utils.hpp"
+#include "platform_utils.hpp"
+#include "loader_create_timings.hpp"
+#include "loader_environment.hpp"
+#include "loader_extension_properties.hpp"
 #include "manifest_file.hpp"
 #include "runtime_interface.hpp"
+#include "api_layer_interface.hpp"
 #include "xr_generated_loader.hpp"
 #include "loader_interfaces.h"
 #include "loader_logger.hpp"
 
+// Controls how long an unused runtime stays loaded: unset or "0" unloads it as soon as the last user
+// releases it, "pin" keeps it loaded for the rest of the process and any other number is a grace
+// period in milliseconds during which a new instance reuses the already negotiated runtime.  No thread
+// watches the grace period: an idle runtime is only unloaded by the next load that finds it expired.
+#define OPENXR_RUNTIME_KEEP_ALIVE_ENV_VAR "XR_LOADER_RUNTIME_KEEP_ALIVE"
+
 std::unique_ptr<RuntimeInterface> RuntimeInterface::_single_runtime_interface;
 uint32_t RuntimeInterface::_single_runtime_count = 0;
 
+// When a runtime only kept loaded by the keep-alive policy stops being reusable.
+static std::chrono::steady_clock::time_point g_idle_runtime_deadline;
+
+// Function local so that it's usable even while static initialization is still in progress, for example by a preload
+// started from another translation unit's initializer.
+std::recursive_mutex& RuntimeInterface::GetSingleRuntimeMutex() {
+    static std::recursive_mutex single_runtime_mutex;
+    return single_runtime_mutex;
+}
+
+enum RuntimeKeepAlivePolicy {
+    RUNTIME_KEEP_ALIVE_NONE = 0,
+    RUNTIME_KEEP_ALIVE_GRACE_PERIOD,
+    RUNTIME_KEEP_ALIVE_PIN,
+};
+
+static RuntimeKeepAlivePolicy GetRuntimeKeepAlivePolicy(std::chrono::milliseconds& grace_period) {
+    RuntimeKeepAlivePolicy policy = RUNTIME_KEEP_ALIVE_NONE;
+    grace_period = std::chrono::milliseconds(0);
+    std::string keep_alive;
+    if (LoaderEnvironment::Get(OPENXR_RUNTIME_KEEP_ALIVE_ENV_VAR, keep_alive)) {
+        if (keep_alive == "pin") {
+            policy = RUNTIME_KEEP_ALIVE_PIN;
+        } else {
+            long milliseconds = strtol(keep_alive.c_str(), nullptr, 10);
+            if (milliseconds > 0) {
+                policy = RUNTIME_KEEP_ALIVE_GRACE_PERIOD;
+                grace_period = std::chrono::milliseconds(milliseconds);
+            }
+        }
+    }
+    return policy;
+}
+
+// Merge a runtime's extensions into those already reported by the API layers.
+static void MergeRuntimeExtensionProperties(const std::vector<XrExtensionProperties>& runtime_extension_properties,
+                                            std::vector<XrExtensionProperties>& extension_properties) {
+    ExtensionPropertiesMerge merge(extension_properties);
+    merge.Add(runtime_extension_properties);
+}
+
+#if defined(XR_LOADER_STATIC_RUNTIME_NEGOTIATE)
+// Negotiate function of the one runtime linked into the loader, see LOADER_STATIC_RUNTIME in CMakeLists.txt.
+extern "C" XRAPI_ATTR XrResult XRAPI_CALL XR_LOADER_STATIC_RUNTIME_NEGOTIATE(const XrNegotiateLoaderInfo* loaderInfo,
+                                                                             XrNegotiateRuntimeRequest* runtimeRequest);
+#else
+// Instance extensions reported by the last runtime actually loaded, along with what's needed to tell
+// whether that runtime may have changed since.
+struct RuntimeExtensionCache {
+    bool valid = false;
+    std::string manifest_filename;
+    FileSysUtilsFileStamp manifest_stamp = {};
+    std::string library_path;
+    bool has_library_stamp = false;
+    FileSysUtilsFileStamp library_stamp = {};
+    std::vector<XrExtensionProperties> properties;
+};
+static RuntimeExtensionCache& GetRuntimeExtensionCache() {
+    static RuntimeExtensionCache runtime_extension_cache;
+    return runtime_extension_cache;
+}
+static std::mutex g_runtime_extension_cache_mutex;
+
+static void UpdateRuntimeExtensionCache(const std::string& manifest_filename, const std::string& library_path,
+                                        const std::vector<XrExtensionProperties>& runtime_extension_properties) {
+    std::unique_lock<std::mutex> cache_lock(g_runtime_extension_cache_mutex);
+    RuntimeExtensionCache& cache = GetRuntimeExtensionCache();
+    cache.valid = FileSysUtilsGetFileStamp(manifest_filename, cache.manifest_stamp);
+    cache.manifest_filename = manifest_filename;
+    cache.library_path = library_path;
+    // Libraries given as a bare file name are found through the system search path, so they can't be checked.
+    cache.has_library_stamp = FileSysUtilsGetFileStamp(library_path, cache.library_stamp);
+    cache.properties = runtime_extension_properties;
+}
+
+static bool ReadRuntimeExtensionCache(const std::string& manifest_filename, const std::string& library_path,
+                                      std::vector<XrExtensionProperties>& runtime_extension_properties) {
+    std::unique_lock<std::mutex> cache_lock(g_runtime_extension_cache_mutex);
+    RuntimeExtensionCache& cache = GetRuntimeExtensionCache();
+    if (!cache.valid || cache.manifest_filename != manifest_filename || cache.library_path != library_path) {
+        return false;
+    }
+    FileSysUtilsFileStamp current_stamp = {};
+    if (!FileSysUtilsGetFileStamp(manifest_filename, current_stamp) || current_stamp != cache.manifest_stamp) {
+        return false;
+    }
+    if (cache.has_library_stamp &&
+        (!FileSysUtilsGetFileStamp(library_path, current_stamp) || current_stamp != cache.library_stamp)) {
+        return false;
+    }
+    runtime_extension_properties = cache.properties;
+    return true;
+}
+#endif  // XR_LOADER_STATIC_RUNTIME_NEGOTIATE
+
+// Negotiate an interface with a runtime and check that what it returned is usable.  runtime_name
+// only describes the runtime in log messages.
+static XrResult NegotiateRuntime(const std::string& openxr_command, const std::string& runtime_name,
+                                 PFN_xrNegotiateLoaderRuntimeInterface negotiate, XrNegotiateRuntimeRequest& runtime_info) {
+    if (nullptr == negotiate) {
+        std::string error_message = "RuntimeInterface::LoadRuntime skipping ";
+        error_message += runtime_name;
+        error_message += ", failed to find negotiate function";
+        LoaderLogger::LogErrorMessage(openxr_command, error_message);
+        return XR_ERROR_FILE_CONTENTS_INVALID;
+    }
+
+    // Loader info for negotiation
+    XrNegotiateLoaderInfo loader_info = {};
+    loader_info.structType = XR_LOADER_INTERFACE_STRUCT_LOADER_INFO;
+    loader_info.structVersion = XR_LOADER_INFO_STRUCT_VERSION;
+    loader_info.structSize = sizeof(XrNegotiateLoaderInfo);
+    loader_info.minInterfaceVersion = 1;
+    loader_info.maxInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+    loader_info.minXrVersion = XR_MAKE_VERSION(0, 1, 0);
+    loader_info.maxXrVersion = XR_MAKE_VERSION(1, 0, 0);
+
+    // Set up the runtime return structure
+    runtime_info = {};
+    runtime_info.structType = XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST;
+    runtime_info.structVersion = XR_RUNTIME_INFO_STRUCT_VERSION;
+    runtime_info.structSize = sizeof(XrNegotiateRuntimeRequest);
+
+    XrResult res;
+    {
+        LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_NEGOTIATION);
+        res = negotiate(&loader_info, &runtime_info);
+    }
+    // If we supposedly succeeded, but got a nullptr for GetInstanceProcAddr
+    // then something still went wrong, so return with an error.
+    if (XR_SUCCESS == res) {
+        uint32_t runtime_major = XR_VERSION_MAJOR(runtime_info.runtimeXrVersion);
+        uint32_t runtime_minor = XR_VERSION_MINOR(runtime_info.runtimeXrVersion);
+        uint32_t loader_major = XR_VERSION_MAJOR(XR_CURRENT_API_VERSION);
+        if (nullptr == runtime_info.getInstanceProcAddr) {
+            std::string error_message = "RuntimeInterface::LoadRuntime skipping ";
+            error_message += runtime_name;
+            error_message += ", negotiation succeeded but returned NULL getInstanceProcAddr";
+            LoaderLogger::LogErrorMessage(openxr_command, error_message);
+            res = XR_ERROR_FILE_CONTENTS_INVALID;
+        } else if (0 >= runtime_info.runtimeInterfaceVersion ||
+                   XR_CURRENT_LOADER_RUNTIME_VERSION < runtime_info.runtimeInterfaceVersion) {
+            std::string error_message = "RuntimeInterface::LoadRuntime skipping ";
+            error_message += runtime_name;
+            error_message += ", negotiation succeeded but returned invalid interface version";
+            LoaderLogger::LogErrorMessage(openxr_command, error_message);
+            res = XR_ERROR_FILE_CONTENTS_INVALID;
+        } else if (runtime_major != loader_major || (runtime_major == 0 && runtime_minor == 0)) {
+            std::string error_message = "RuntimeInterface::LoadRuntime skipping ";
+            error_message += runtime_name;
+            error_message += ", OpenXR version returned not compatible with this loader";
+            LoaderLogger::LogErrorMessage(openxr_command, error_message);
+            res = XR_ERROR_FILE_CONTENTS_INVALID;
+        }
+    }
+    if (XR_SUCCESS != res) {
+        std::string warning_message = "RuntimeInterface::LoadRuntime skipping ";
+        warning_message += runtime_name;
+        warning_message += ", negotiation failed with error ";
+        warning_message += std::to_string(res);
+        LoaderLogger::LogErrorMessage(openxr_command, warning_message);
+        return res;
+    }
+
+    std::string info_message = "RuntimeInterface::LoadRuntime succeeded loading runtime defined in ";
+    info_message += runtime_name;
+    info_message += " using interface version ";
+    info_message += std::to_string(runtime_info.runtimeInterfaceVersion);
+    info_message += " and OpenXR API version ";
+    info_message += std::to_string(XR_VERSION_MAJOR(runtime_info.runtimeXrVersion));
+    info_message += ".";
+    info_message += std::to_string(XR_VERSION_MINOR(runtime_info.runtimeXrVersion));
+    LoaderLogger::LogInfoMessage(openxr_command, info_message);
+    return XR_SUCCESS;
+}
+
+void RuntimeInterface::UseRuntime(LoaderPlatformLibraryHandle runtime_library, PFN_xrGetInstanceProcAddr get_instant_proc_addr,
+                                  std::vector<XrExtensionProperties>& extension_properties) {
+    _single_runtime_interface.reset(new RuntimeInterface(runtime_library, get_instant_proc_addr));
+    _single_runtime_count++;
+
+    // Grab the list of extensions this runtime supports for easy filtering after the
+    // xrCreateInstance call
+    std::vector<std::string> supported_extensions;
+    _single_runtime_interface->GetInstanceExtensionProperties(extension_properties);
+    for (XrExtensionProperties ext_prop : extension_properties) {
+        supported_extensions.push_back(ext_prop.extensionName);
+    }
+    _single_runtime_interface->SetSupportedExtensions(supported_extensions);
+}
+
 XrResult RuntimeInterface::LoadRuntime(const std::string& openxr_command) {
     XrResult last_error = XR_SUCCESS;
     bool any_loaded = false;
     try {
-        // If something's already loaded, we're done here.
-        if (_single_runtime_interface != nullptr) {
-            _single_runtime_count++;
+        std::unique_lock<std::recursive_mutex> runtime_lock(GetSingleRuntimeMutex());
+
+        // If something's already loaded, we're done here.  This includes a runtime only kept alive by the
+        // keep-alive policy, whose negotiation results are simply reused.
+        if (_single_runtime_interface != nullptr && (_single_runtime_count > 0 || ReuseIdleRuntime(openxr_command))) {
+            if (0 == _single_runtime_count++) {
+                LoaderLogger::LogInfoMessage(openxr_command, "RuntimeInterface::LoadRuntime - reusing runtime kept alive");
+            }
             return XR_SUCCESS;
         }
 
+#if defined(XR_LOADER_STATIC_RUNTIME_NEGOTIATE)
+        // The runtime is linked into the loader, so there's no manifest to find and no library to open.
+        XrNegotiateRuntimeRequest runtime_info = {};
+        last_error = NegotiateRuntime(openxr_command, "statically linked runtime", XR_LOADER_STATIC_RUNTIME_NEGOTIATE, runtime_info);
+        if (XR_SUCCESS == last_error) {
+            std::vector<XrExtensionProperties> extension_properties;
+            UseRuntime(nullptr, runtime_info.getInstanceProcAddr, extension_properties);
+            any_loaded = true;
+        }
+#else
         std::vector<std::unique_ptr<RuntimeManifestFile>> runtime_manifest_files = {};
 
         // Find the available runtimes which we may need to report information for.
@@ -49,7 +269,11 @@ XrResult RuntimeInterface::LoadRuntime(const std::string& openxr_command) {
             last_error = XR_ERROR_FILE_ACCESS_ERROR;
         } else {
             for (std::unique_ptr<RuntimeManifestFile>& manifest_file : runtime_manifest_files) {
-                LoaderPlatformLibraryHandle runtime_library = LoaderPlatformLibraryOpen(manifest_file->LibraryPath());
+                LoaderPlatformLibraryHandle runtime_library;
+                {
+                    LoaderCreatePhaseTimer phase_timer(LOADER_CREATE_PHASE_LIBRARY_LOADING);
+                    runtime_library = LoaderPlatformLibraryOpen(manifest_file->LibraryPath());
+                }
                 if (nullptr == runtime_library) {
                     if (!any_loaded) {
                         last_error = XR_ERROR_INSTANCE_LOST;
@@ -69,86 +293,24 @@ XrResult RuntimeInterface::LoadRuntime(const std::string& openxr_command) {
                 PFN_xrNegotiateLoaderRuntimeInterface negotiate = reinterpret_cast<PFN_xrNegotiateLoaderRuntimeInterface>(
                     LoaderPlatformLibraryGetProcAddr(runtime_library, function_name));
 
-                // Loader info for negotiation
-                XrNegotiateLoaderInfo loader_info = {};
-                loader_info.structType = XR_LOADER_INTERFACE_STRUCT_LOADER_INFO;
-                loader_info.structVersion = XR_LOADER_INFO_STRUCT_VERSION;
-                loader_info.structSize = sizeof(XrNegotiateLoaderInfo);
-                loader_info.minInterfaceVersion = 1;
-                loader_info.maxInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
-                loader_info.minXrVersion = XR_MAKE_VERSION(0, 1, 0);
-                loader_info.maxXrVersion = XR_MAKE_VERSION(1, 0, 0);
-
-                // Set up the runtime return structure
                 XrNegotiateRuntimeRequest runtime_info = {};
-                runtime_info.structType = XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST;
-                runtime_info.structVersion = XR_RUNTIME_INFO_STRUCT_VERSION;
-                runtime_info.structSize = sizeof(XrNegotiateRuntimeRequest);
-
-                XrResult res = negotiate(&loader_info, &runtime_info);
-                // If we supposedly succeeded, but got a nullptr for GetInstanceProcAddr
-                // then something still went wrong, so return with an error.
-                if (XR_SUCCESS == res) {
-                    uint32_t runtime_major = XR_VERSION_MAJOR(runtime_info.runtimeXrVersion);
-                    uint32_t runtime_minor = XR_VERSION_MINOR(runtime_info.runtimeXrVersion);
-                    uint32_t loader_major = XR_VERSION_MAJOR(XR_CURRENT_API_VERSION);
-                    if (nullptr == runtime_info.getInstanceProcAddr) {
-                        std::string error_message = "RuntimeInterface::LoadRuntime skipping manifest file ";
-                        error_message += manifest_file->Filename();
-                        error_message += ", negotiation succeeded but returned NULL getInstanceProcAddr";
-                        LoaderLogger::LogErrorMessage(openxr_command, error_message);
-                        res = XR_ERROR_FILE_CONTENTS_INVALID;
-                    } else if (0 >= runtime_info.runtimeInterfaceVersion ||
-                               XR_CURRENT_LOADER_RUNTIME_VERSION < runtime_info.runtimeInterfaceVersion) {
-                        std::string error_message = "RuntimeInterface::LoadRuntime skipping manifest file ";
-                        error_message += manifest_file->Filename();
-                        error_message += ", negotiation succeeded but returned invalid interface version";
-                        LoaderLogger::LogErrorMessage(openxr_command, error_message);
-                        res = XR_ERROR_FILE_CONTENTS_INVALID;
-                    } else if (runtime_major != loader_major || (runtime_major == 0 && runtime_minor == 0)) {
-                        std::string error_message = "RuntimeInterface::LoadRuntime skipping manifest file ";
-                        error_message += manifest_file->Filename();
-                        error_message += ", OpenXR version returned not compatible with this loader";
-                        LoaderLogger::LogErrorMessage(openxr_command, error_message);
-                        res = XR_ERROR_FILE_CONTENTS_INVALID;
-                    }
-                }
+                XrResult res = NegotiateRuntime(openxr_command, "manifest file " + manifest_file->Filename(), negotiate, runtime_info);
                 if (XR_SUCCESS != res) {
                     if (!any_loaded) {
                         last_error = res;
                     }
-                    std::string warning_message = "RuntimeInterface::LoadRuntime skipping manifest file ";
-                    warning_message += manifest_file->Filename();
-                    warning_message += ", negotiation failed with error ";
-                    warning_message += std::to_string(res);
-                    LoaderLogger::LogErrorMessage(openxr_command, warning_message);
                     LoaderPlatformLibraryClose(runtime_library);
                     continue;
                 }
 
-                std::string info_message = "RuntimeInterface::LoadRuntime succeeded loading runtime defined in manifest file ";
-                info_message += manifest_file->Filename();
-                info_message += " using interface version ";
-                info_message += std::to_string(runtime_info.runtimeInterfaceVersion);
-                info_message += " and OpenXR API version ";
-                info_message += std::to_string(XR_VERSION_MAJOR(runtime_info.runtimeXrVersion));
-                info_message += ".";
-                info_message += std::to_string(XR_VERSION_MINOR(runtime_info.runtimeXrVersion));
-                LoaderLogger::LogInfoMessage(openxr_command, info_message);
-
                 // Use this runtime
-                _single_runtime_interface.reset(new RuntimeInterface(runtime_library, runtime_info.getInstanceProcAddr));
-                _single_runtime_count++;
-
-                // Grab the list of extensions this runtime supports for easy filtering after the
-                // xrCreateInstance call
-                std::vector<std::string> supported_extensions;
                 std::vector<XrExtensionProperties> extension_properties;
-                _single_runtime_interface->GetInstanceExtensionProperties(extension_properties);
-                for (XrExtensionProperties ext_prop : extension_properties) {
-                    supported_extensions.push_back(ext_prop.extensionName);
-                }
-                _single_runtime_interface->SetSupportedExtensions(supported_extensions);
+                UseRuntime(runtime_library, runtime_info.getInstanceProcAddr, extension_properties);
+
+                // Remember them so they can be enumerated later without loading the runtime again.
+                UpdateRuntimeExtensionCache(manifest_file->Filename(), manifest_file->LibraryPath(), extension_properties);
+                _single_runtime_interface->_manifest_filename = manifest_file->Filename();
+                _single_runtime_interface->_library_path = manifest_file->LibraryPath();
 
                 // If we load one, clear all errors.
                 any_loaded = true;
@@ -159,6 +321,7 @@ XrResult RuntimeInterface::LoadRuntime(const std::string& openxr_command) {
 
         // Always clear the manifest file list.  Either we use them or we don't.
         runtime_manifest_files.clear();
+#endif
     } catch (std::bad_alloc&) {
         LoaderLogger::LogErrorMessage(openxr_command, "RuntimeInterface::LoadRuntimes - failed to allocate memory");
         last_error = XR_ERROR_OUT_OF_MEMORY;
@@ -176,16 +339,107 @@ XrResult RuntimeInterface::LoadRuntime(const std::string& openxr_command) {
     return last_error;
 }
 
+XrResult RuntimeInterface::EnumerateInstanceExtensionProperties(const std::string& openxr_command,
+                                                                std::vector<XrExtensionProperties>& extension_properties) {
+    try {
+        std::unique_lock<std::recursive_mutex> runtime_lock(GetSingleRuntimeMutex());
+
+        // A runtime that's already loaded can simply be asked.
+        if (_single_runtime_interface != nullptr && (_single_runtime_count > 0 || ReuseIdleRuntime(openxr_command))) {
+            _single_runtime_interface->GetInstanceExtensionProperties(extension_properties);
+            return XR_SUCCESS;
+        }
+
+#if defined(XR_LOADER_STATIC_RUNTIME_NEGOTIATE)
+        // A linked in runtime has no manifest, and loading it costs no more than asking it directly.
+        XrResult result = XR_SUCCESS;
+#else
+        std::vector<std::unique_ptr<RuntimeManifestFile>> runtime_manifest_files;
+        XrResult result = RuntimeManifestFile::FindManifestFiles(MANIFEST_TYPE_RUNTIME, runtime_manifest_files);
+        if (XR_SUCCESS == result && !runtime_manifest_files.empty()) {
+            // The runtime that LoadRuntime would try first is the one whose extensions get reported.
+            RuntimeManifestFile& manifest_file = *runtime_manifest_files[0];
+            std::vector<XrExtensionProperties> runtime_extension_properties;
+            if (manifest_file.DeclaresInstanceExtensions()) {
+                manifest_file.GetInstanceExtensionProperties(runtime_extension_properties);
+                MergeRuntimeExtensionProperties(runtime_extension_properties, extension_properties);
+                LoaderLogger::LogVerboseMessage(
+                    openxr_command, "RuntimeInterface::EnumerateInstanceExtensionProperties - using runtime manifest extensions");
+                return XR_SUCCESS;
+            }
+            if (ReadRuntimeExtensionCache(manifest_file.Filename(), manifest_file.LibraryPath(), runtime_extension_properties)) {
+                MergeRuntimeExtensionProperties(runtime_extension_properties, extension_properties);
+                LoaderLogger::LogVerboseMessage(
+                    openxr_command, "RuntimeInterface::EnumerateInstanceExtensionProperties - using cached runtime extensions");
+                return XR_SUCCESS;
+            }
+        }
+#endif
+
+        // Nothing usable without asking the runtime itself.
+        result = LoadRuntime(openxr_command);
+        if (XR_SUCCESS != result) {
+            return result;
+        }
+        _single_runtime_interface->GetInstanceExtensionProperties(extension_properties);
+        UnloadRuntime(openxr_command);
+        return XR_SUCCESS;
+    } catch (std::bad_alloc&) {
+        LoaderLogger::LogErrorMessage(openxr_command,
+                                      "RuntimeInterface::EnumerateInstanceExtensionProperties - failed to allocate memory");
+        return XR_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        LoaderLogger::LogErrorMessage(openxr_command, "RuntimeInterface::EnumerateInstanceExtensionProperties - unknown error");
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+}
+
 void RuntimeInterface::UnloadRuntime(const std::string& openxr_command) {
+    std::unique_lock<std::recursive_mutex> runtime_lock(GetSingleRuntimeMutex());
     if (_single_runtime_count == 1) {
         _single_runtime_count = 0;
-        _single_runtime_interface.reset();
+        std::chrono::milliseconds grace_period;
+        switch (GetRuntimeKeepAlivePolicy(grace_period)) {
+            case RUNTIME_KEEP_ALIVE_PIN:
+                g_idle_runtime_deadline = std::chrono::steady_clock::time_point::max();
+                LoaderLogger::LogInfoMessage(openxr_command, "RuntimeInterface kept loaded, pinned for the process lifetime.");
+                return;
+            case RUNTIME_KEEP_ALIVE_GRACE_PERIOD:
+                g_idle_runtime_deadline = std::chrono::steady_clock::now() + grace_period;
+                LoaderLogger::LogInfoMessage(openxr_command, "RuntimeInterface kept loaded for the keep-alive grace period.");
+                return;
+            default:
+                _single_runtime_interface.reset();
+                ApiLayerInterface::ReleaseUnusedApiLayers();
+                break;
+        }
     } else if (_single_runtime_count > 0) {
         --_single_runtime_count;
     }
     LoaderLogger::LogInfoMessage(openxr_command, "RuntimeInterface being unloaded.");
 }
 
+bool RuntimeInterface::ReuseIdleRuntime(const std::string& openxr_command) {
+    bool reusable = std::chrono::steady_clock::now() < g_idle_runtime_deadline;
+#if !defined(XR_LOADER_STATIC_RUNTIME_NEGOTIATE)
+    // The active runtime may have been switched while this one sat idle.
+    if (reusable) {
+        std::vector<std::unique_ptr<RuntimeManifestFile>> runtime_manifest_files;
+        reusable = XR_SUCCESS == RuntimeManifestFile::FindManifestFiles(MANIFEST_TYPE_RUNTIME, runtime_manifest_files) &&
+                   !runtime_manifest_files.empty() &&
+                   runtime_manifest_files[0]->Filename() == _single_runtime_interface->_manifest_filename &&
+                   runtime_manifest_files[0]->LibraryPath() == _single_runtime_interface->_library_path;
+    }
+#endif
+    if (!reusable) {
+        _single_runtime_interface.reset();
+        ApiLayerInterface::ReleaseUnusedApiLayers();
+        LoaderLogger::LogInfoMessage(openxr_command,
+                                     "RuntimeInterface unloaded, kept alive past its grace period or no longer active.");
+    }
+    return reusable;
+}
+
 XrResult RuntimeInterface::GetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
     return _single_runtime_interface->_get_instant_proc_addr(instance, name, function);
 }
@@ -193,7 +447,7 @@ XrResult RuntimeInterface::GetInstanceProcAddr(XrInstance instance, const char*
 const XrGeneratedDispatchTable* RuntimeInterface::GetDispatchTable(XrInstance instance) {
     XrGeneratedDispatchTable* table = nullptr;
     std::unique_lock<std::mutex> mlock(_single_runtime_interface->_dispatch_table_mutex);
-    table = _single_runtime_interface->_dispatch_table_map[instance];
+    table = _single_runtime_interface->_dispatch_table_map[instance].get();
     return table;
 }
 
@@ -215,12 +469,12 @@ RuntimeInterface::~RuntimeInterface() {
     std::string info_message = "RuntimeInterface being destroyed.";
     LoaderLogger::LogInfoMessage("", info_message);
     std::unique_lock<std::mutex> mlock(_dispatch_table_mutex);
-    for (auto it = _dispatch_table_map.begin(); it != _dispatch_table_map.end();) {
-        delete it->second;
-        _dispatch_table_map.erase(it++);
-    }
+    _dispatch_table_map.clear();
     mlock.unlock();
-    LoaderPlatformLibraryClose(_runtime_library);
+    // A statically linked runtime has no library to close
+    if (nullptr != _runtime_library) {
+        LoaderPlatformLibraryClose(_runtime_library);
+    }
 }
 
 void RuntimeInterface::GetInstanceExtensionProperties(std::vector<XrExtensionProperties>& extension_properties) {
@@ -242,25 +496,7 @@ void RuntimeInterface::GetInstanceExtensionProperties(std::vector<XrExtensionPro
             }
             rt_xrEnumerateInstanceExtensionProperties(nullptr, count, &count_output, runtime_extension_properties.data());
         }
-        size_t ext_count = runtime_extension_properties.size();
-        size_t props_count = extension_properties.size();
-        for (size_t ext = 0; ext < ext_count; ++ext) {
-            bool found = false;
-            for (size_t prop = 0; prop < props_count; ++prop) {
-                // If we find it, then make sure the spec version matches that of the runtime instead of the
-                // layer.
-                if (!strcmp(extension_properties[prop].extensionName, runtime_extension_properties[ext].extensionName)) {
-                    // Make sure the spec version used is the runtime's
-                    extension_properties[prop].specVersion = runtime_extension_properties[ext].specVersion;
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                extension_properties.push_back(runtime_extension_properties[ext]);
-            }
-        }
-
+        MergeRuntimeExtensionProperties(runtime_extension_properties, extension_properties);
     } catch (...) {
         LoaderLogger::LogErrorMessage("xrEnumerateInstanceExtensionProperties",
                                       "RuntimeInterface::GetInstanceExtensionProperties - unknown error");
@@ -277,10 +513,11 @@ XrResult RuntimeInterface::CreateInstance(const XrInstanceCreateInfo* info, XrIn
         res = rt_xrCreateInstance(info, instance);
         if (XR_SUCCESS == res) {
             create_succeeded = true;
-            XrGeneratedDispatchTable* dispatch_table = new XrGeneratedDispatchTable();
-            GeneratedXrPopulateDispatchTable(dispatch_table, *instance, _get_instant_proc_addr);
+            LoaderUniquePtr<XrGeneratedDispatchTable> dispatch_table =
+                LoaderMakeUnique<XrGeneratedDispatchTable>(LOADER_MEMORY_CATEGORY_DISPATCH_TABLE);
+            GeneratedXrPopulateDispatchTable(dispatch_table.get(), *instance, _get_instant_proc_addr);
             std::unique_lock<std::mutex> mlock(_dispatch_table_mutex);
-            _dispatch_table_map[*instance] = dispatch_table;
+            _dispatch_table_map[*instance] = std::move(dispatch_table);
         }
     } catch (std::bad_alloc&) {
         LoaderLogger::LogErrorMessage("xrCreateInstance", "RuntimeInterface::CreateInstance - failed to allocate memory");
@@ -306,13 +543,13 @@ XrResult RuntimeInterface::DestroyInstance(XrInstance instance) {
         if (XR_NULL_HANDLE != instance) {
             // Destroy the dispatch table for this instance first
             std::unique_lock<std::mutex> mlock(_dispatch_table_mutex);
-            XrGeneratedDispatchTable* table = _dispatch_table_map[instance];
             _dispatch_table_map.erase(instance);
+            // Hand back the buckets too, they may have come from allocation callbacks about to be released
+            if (_dispatch_table_map.empty()) {
+                decltype(_dispatch_table_map)().swap(_dispatch_table_map);
+            }
             mlock.unlock();
 
-            if (nullptr != table) {
-                delete table;
-            }
             // Now delete the instance
             PFN_xrDestroyInstance rt_xrDestroyInstance;
             _get_instant_proc_addr(instance, "xrDestroyInstance", reinterpret_cast<PFN_xrVoidFunction*>(&rt_xrDestroyInstance));
@@ -339,22 +576,23 @@ void RuntimeInterface::ForgetDebugMessenger(XrDebugUtilsMessengerEXT messenger)
     if (XR_NULL_HANDLE != messenger) {
         std::unique_lock<std::mutex> mlock(_messenger_to_instance_mutex);
         _messenger_to_instance_map.erase(messenger);
+        if (_messenger_to_instance_map.empty()) {
+            decltype(_messenger_to_instance_map)().swap(_messenger_to_instance_map);
+        }
     }
 }
 
 void RuntimeInterface::SetSupportedExtensions(std::vector<std::string>& supported_extensions) {
-    _supported_extensions = supported_extensions;
+    _supported_extensions = ExtensionSet();
+    for (const std::string& supported_extension : supported_extensions) {
+        _supported_extensions.Add(supported_extension);
+    }
 }
 
 bool RuntimeInterface::SupportsExtension(const std::string& extension_name) {
     bool found_prop = false;
     try {
-        for (std::string supported_extension : _supported_extensions) {
-            if (supported_extension == extension_name) {
-                found_prop = true;
-                break;
-            }
-        }
+        found_prop = _supported_extensions.Contains(extension_name);
     } catch (...) {
     }
     return found_prop;
@@ -25,6 +25,8 @@
 #include <mutex>
 
 #include "loader_platform.hpp"
+#include "loader_allocator.hpp"
+#include "loader_extension_set.hpp"
 #include "xr_generated_dispatch_table.h"
 
 class RuntimeInterface {
@@ -38,6 +40,10 @@ class RuntimeInterface {
     static XrResult GetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
     static const XrGeneratedDispatchTable* GetDispatchTable(XrInstance instance);
     static const XrGeneratedDispatchTable* GetDebugUtilsMessengerDispatchTable(XrDebugUtilsMessengerEXT messenger);
+    // Add the active runtime's instance extensions, only loading the runtime when neither its manifest
+    // nor a previous load can answer
+    static XrResult EnumerateInstanceExtensionProperties(const std::string& openxr_command,
+                                                         std::vector<XrExtensionProperties>& extension_properties);
 
     void GetInstanceExtensionProperties(std::vector<XrExtensionProperties>& props);
     bool SupportsExtension(const std::string& extension_name);
@@ -52,14 +58,23 @@ class RuntimeInterface {
     RuntimeInterface(LoaderPlatformLibraryHandle runtime_library, PFN_xrGetInstanceProcAddr get_instant_proc_addr);
     RuntimeInterface& operator=(const RuntimeInterface&) = delete;
     void SetSupportedExtensions(std::vector<std::string>& supported_extensions);
+    // Make a successfully negotiated runtime the single runtime, returning its instance extensions
+    static void UseRuntime(LoaderPlatformLibraryHandle runtime_library, PFN_xrGetInstanceProcAddr get_instant_proc_addr,
+                           std::vector<XrExtensionProperties>& extension_properties);
+    static std::recursive_mutex& GetSingleRuntimeMutex();
+    // Whether a runtime only kept loaded by the keep-alive policy may be used again, unloading it if not
+    static bool ReuseIdleRuntime(const std::string& openxr_command);
 
     static std::unique_ptr<RuntimeInterface> _single_runtime_interface;
     static uint32_t _single_runtime_count;
     LoaderPlatformLibraryHandle _runtime_library;
     PFN_xrGetInstanceProcAddr _get_instant_proc_addr;
-    std::unordered_map<XrInstance, XrGeneratedDispatchTable*> _dispatch_table_map;
+    // The manifest the runtime was loaded from, to tell whether it's still the active one
+    std::string _manifest_filename;
+    std::string _library_path;
+    LoaderUnorderedMap<XrInstance, LoaderUniquePtr<XrGeneratedDispatchTable>> _dispatch_table_map;
     std::mutex _dispatch_table_mutex;
-    std::unordered_map<XrDebugUtilsMessengerEXT, XrInstance> _messenger_to_instance_map;
+    LoaderUnorderedMap<XrDebugUtilsMessengerEXT, XrInstance> _messenger_to_instance_map;
     std::mutex _messenger_to_instance_mutex;
-    std::vector<std::string> _supported_extensions;
+    ExtensionSet _supported_extensions;
 };
@@ -79,6 +79,7 @@ def main(argv):
     api_version = ''
     implementation_version = ''
     description = ''
+    intercepted_functions = []
     generate_badjson_jsons = False
 
     usage =  '\ngenerate_api_layer_manifest.py <ARGS>\n'
@@ -88,10 +89,11 @@ def main(argv):
     usage += '    -a/--api <OpenXR API version>\n'
     usage += '    -v/--ver <layer implementation version>\n'
     usage += '    -d/--desc <Description>\n'
+    usage += '    -i/--intercept <comma separated functions the layer intercepts>\n'
     usage += '    -b/--bad\n'
 
     try:
-        opts, _ = getopt.getopt(argv,"hbf:n:l:a:v:d:",["bad","file=","name=","lib=","api=","ver=","desc="])
+        opts, _ = getopt.getopt(argv,"hbf:n:l:a:v:d:i:",["bad","file=","name=","lib=","api=","ver=","desc=","intercept="])
     except getopt.GetoptError:
         print(usage)
         sys.exit(2)
@@ -111,6 +113,8 @@ def main(argv):
             implementation_version = arg.strip()
         elif opt in ("-d", "--desc"):
             description = arg.strip()
+        elif opt in ("-i", "--intercept"):
+            intercepted_functions = [func.strip() for func in arg.split(',') if func.strip()]
         elif opt in ("-b", "--bad"):
             generate_badjson_jsons = True
 
@@ -123,6 +127,14 @@ def main(argv):
     file_text += '        "implementation_version": "%s",\n' % implementation_version
     file_text += '        "description": "%s"' % description
 
+    # Only layers limited to some functions list them, the loader calls the others for everything
+    if intercepted_functions:
+        file_text += ',\n'
+        file_text += '        "intercepted_functions": [\n'
+        file_text += ',\n'.join('            "%s"' % func for func in intercepted_functions)
+        file_text += '\n'
+        file_text += '        ]'
+
     # If testing bad JSONs, then add in a fake extension
     if generate_badjson_jsons:
         file_text += ',\n'
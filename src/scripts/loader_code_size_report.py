@@ -0,0 +1,159 @@
+#!/usr/bin/python3
+#
+# Copyright (c) 2019 The Khronos Group Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Report the code size of every function in the loader library, read from its symbol table with
+# nm, along with the size of its .text section, read with objdump.  Functions are grouped into the
+# exported xr* entry points, the generated terminators, the out-of-line error logging helpers and
+# everything else.  Parts of functions the compiler moved out of line as cold (the .cold symbols
+# GCC emits) are counted on their own rather than with the function they came from, since they
+# don't take up instruction cache when the function runs normally.
+#
+# The full report is written as JSON, a summary goes to stdout, and with a history file one line of
+# totals is appended to it per run, so that sizes can be followed from build to build.
+
+import argparse
+import datetime
+import json
+import os
+import re
+import subprocess
+import sys
+
+# Symbol types nm gives code
+TEXT_SYMBOL_TYPES = 'tTwW'
+
+# Sections holding code, rather than the per-function sections some toolchains leave in place
+TEXT_SECTIONS = ('.text', '.text.hot', '.text.unlikely', '.text.startup', '.text.exit')
+
+# Suffixes of symbols for function parts GCC split off into cold code
+COLD_PART_PATTERN = re.compile(r'\.cold(\.\d+)?$')
+
+
+# Group a function by its name.
+#   name            the demangled function name
+def functionGroup(name):
+    if COLD_PART_PATTERN.search(name):
+        return 'cold_parts'
+    if name.startswith('LoaderGenTermXr'):
+        return 'terminators'
+    if name.startswith('LoaderGenLog'):
+        return 'cold_helpers'
+    if re.match(r'xr[A-Z]', name):
+        return 'entry_points'
+    return 'other'
+
+
+# Read the size of every function in the library.
+#   nm              the nm executable
+#   library         the library to read
+def readFunctions(nm, library):
+    output = subprocess.check_output([nm, '--print-size', '--size-sort', '--demangle', library],
+                                     universal_newlines=True)
+    functions = []
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) != 4 or fields[2] not in TEXT_SYMBOL_TYPES:
+            continue
+        functions.append({'name': fields[3], 'size': int(fields[1], 16), 'group': functionGroup(fields[3])})
+    functions.sort(key=lambda function: (-function['size'], function['name']))
+    return functions
+
+
+# Read the size of each code section in the library, summed over every object in it when the
+# library is a static archive.
+#   objdump         the objdump executable
+#   library         the library to read
+def readSections(objdump, library):
+    output = subprocess.check_output([objdump, '--section-headers', library], universal_newlines=True)
+    sections = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 3 and fields[0].isdigit() and fields[1] in TEXT_SECTIONS:
+            sections[fields[1]] = sections.get(fields[1], 0) + int(fields[2], 16)
+    return sections
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Report per-function code size of the loader library')
+    parser.add_argument('library', help='Loader library to report on')
+    parser.add_argument('-nm', default='nm', help='nm executable')
+    parser.add_argument('-objdump', default='objdump', help='objdump executable')
+    parser.add_argument('-o', dest='output', help='Write the full report as JSON to this file')
+    parser.add_argument('-history', help='Append one line of totals as JSON to this file')
+    parser.add_argument('-label', default='', help='Label recorded with this run in the history, such as the build options')
+    parser.add_argument('-top', type=int, default=20, help='Number of largest entry points to print')
+    args = parser.parse_args()
+
+    try:
+        functions = readFunctions(args.nm, args.library)
+        sections = readSections(args.objdump, args.library)
+    except (OSError, subprocess.CalledProcessError) as error:
+        print('loader_code_size_report: unable to read %s: %s' % (args.library, error), file=sys.stderr)
+        return 1
+
+    groups = {}
+    for function in functions:
+        group = groups.setdefault(function['group'], {'count': 0, 'size': 0})
+        group['count'] += 1
+        group['size'] += function['size']
+
+    totals = {
+        'time': datetime.datetime.now().replace(microsecond=0).isoformat(),
+        'label': args.label,
+        'library': os.path.basename(args.library),
+        'library_size': os.path.getsize(args.library),
+        'sections': sections,
+        'groups': groups,
+    }
+
+    if args.output:
+        with open(args.output, 'w') as report_file:
+            json.dump(dict(totals, functions=functions), report_file, indent=4)
+            report_file.write('\n')
+
+    previous = None
+    if args.history:
+        if os.path.exists(args.history):
+            with open(args.history) as history_file:
+                lines = [line for line in history_file.read().splitlines() if line.strip()]
+            if lines:
+                previous = json.loads(lines[-1])
+        with open(args.history, 'a') as history_file:
+            history_file.write(json.dumps(totals, sort_keys=True) + '\n')
+
+    # Show how much each total moved since the last run recorded in the history
+    def change(current, before):
+        if before is None:
+            return ''
+        return ' (%+d)' % (current - before)
+
+    for name, size in sorted(sections.items()):
+        before = previous['sections'].get(name) if previous else None
+        print('%-16s %10d bytes%s' % (name, size, change(size, before)))
+    for name in ('entry_points', 'terminators', 'cold_helpers', 'cold_parts', 'other'):
+        group = groups.get(name, {'count': 0, 'size': 0})
+        before = previous['groups'].get(name, {'size': 0})['size'] if previous else None
+        print('%-16s %10d bytes in %d functions%s' % (name, group['size'], group['count'], change(group['size'], before)))
+    entry_points = [function for function in functions if function['group'] == 'entry_points']
+    if entry_points and args.top > 0:
+        print('Largest entry points:')
+        for function in entry_points[:args.top]:
+            print('    %-56s %6d' % (function['name'], function['size']))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
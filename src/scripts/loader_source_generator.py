@@ -110,7 +110,9 @@ class LoaderSourceGeneratorOptions(AutomaticSourceGeneratorOptions):
                  indentFuncProto=True,
                  indentFuncPointer=False,
                  alignFuncParam=0,
-                 genEnumBeginEndRange=False):
+                 genEnumBeginEndRange=False,
+                 loaderStatistics=False,
+                 coldDiagnostics=False):
         AutomaticSourceGeneratorOptions.__init__(self, filename, directory, apiname, profile,
                                                  versions, emitversions, defaultExtensions,
                                                  addExtensions, removeExtensions,
@@ -129,6 +131,10 @@ class LoaderSourceGeneratorOptions(AutomaticSourceGeneratorOptions):
         self.indentFuncPointer = indentFuncPointer
         self.alignFuncParam = alignFuncParam
         self.genEnumBeginEndRange = genEnumBeginEndRange
+        # Compile per-command call statistics into the trampolines
+        self.loaderStatistics = loaderStatistics
+        # Move diagnostic construction out of the trampolines into shared cold helpers
+        self.coldDiagnostics = coldDiagnostics
 
 # LoaderSourceOutputGenerator - subclass of AutomaticSourceOutputGenerator.
 
@@ -142,6 +148,7 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                  diagFile=sys.stdout):
         AutomaticSourceOutputGenerator.__init__(
             self, errFile, warnFile, diagFile)
+        self.registry_extension_names = []
 
     # Override the base class header warning so the comment indicates this file.
     #   self            the LoaderSourceOutputGenerator object
@@ -161,10 +168,16 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
 
         if self.genOpts.filename == 'xr_generated_loader.hpp':
             preamble += '#pragma once\n'
+            preamble += '#include <bitset>\n'
             preamble += '#include <unordered_map>\n'
             preamble += '#include <thread>\n'
-            preamble += '#include <mutex>\n\n'
-            preamble += '#include "loader_interfaces.h"\n\n'
+            preamble += '#include <mutex>\n'
+            if self.genOpts.loaderStatistics:
+                preamble += '#include <utility>\n'
+                preamble += '#include <vector>\n'
+            preamble += '\n'
+            preamble += '#include "loader_interfaces.h"\n'
+            preamble += '#include "loader_allocator.hpp"\n\n'
 
         elif self.genOpts.filename == 'xr_generated_loader.cpp':
             preamble += '#include <ios>\n'
@@ -180,9 +193,24 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
             preamble += '#include "xr_generated_dispatch_table.h"\n'
             preamble += '#include "xr_generated_utilities.h"\n'
             preamble += '#include "api_layer_interface.hpp"\n'
+            if self.genOpts.loaderStatistics:
+                preamble += '#include "loader_statistics.hpp"\n'
+            if self.genOpts.coldDiagnostics:
+                preamble += '#include "loader_platform.hpp"\n'
 
         write(preamble, file=self.outFile)
 
+    # Record every extension in the registry, in registry order, so each one can be given a
+    # fixed id.  This includes the extensions the base class leaves out of self.extensions.
+    #   self            the LoaderSourceOutputGenerator object
+    #   interface       element for the <version> / <extension> to generate
+    #   emit            actually write to the header only when True
+    def beginFeature(self, interface, emit):
+        AutomaticSourceOutputGenerator.beginFeature(self, interface, emit)
+        if (not self.isCoreExtensionName(self.currentExtension) and
+                self.currentExtension not in self.registry_extension_names):
+            self.registry_extension_names.append(self.currentExtension)
+
     # Write out all the information for the appropriate file,
     # and then call down to the base class to wrap everything up.
     #   self            the LoaderSourceOutputGenerator object
@@ -190,6 +218,9 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
         file_data = ''
 
         if self.genOpts.filename == 'xr_generated_loader.hpp':
+            file_data += self.outputLoaderExtensionIds()
+            if self.genOpts.loaderStatistics:
+                file_data += self.outputLoaderCommandIds()
             file_data += '#ifdef __cplusplus\n'
             file_data += 'extern "C" { \n'
             file_data += '#endif\n'
@@ -201,11 +232,19 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
             file_data += self.outputLoaderMapExterns()
 
         elif self.genOpts.filename == 'xr_generated_loader.cpp':
+            file_data += self.outputLoaderExtensionNames()
+            if self.genOpts.loaderStatistics:
+                file_data += self.outputLoaderCommandNames()
             file_data += self.outputLoaderMapDefines()
+            if self.genOpts.loaderStatistics:
+                file_data += self.outputLoaderHandleMapSizes()
+            generated_funcs = self.outputLoaderGeneratedFuncs()
+            if self.genOpts.coldDiagnostics:
+                file_data += self.outputLoaderColdDiagnostics(generated_funcs)
             file_data += '#ifdef __cplusplus\n'
             file_data += 'extern "C" { \n'
             file_data += '#endif\n'
-            file_data += self.outputLoaderGeneratedFuncs()
+            file_data += generated_funcs
             file_data += self.outputLoaderExportFuncs()
             file_data += '#ifdef __cplusplus\n'
             file_data += '} // extern "C"\n'
@@ -216,6 +255,88 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
         # Finish processing in superclass
         AutomaticSourceOutputGenerator.endFile(self)
 
+    # Output an id for every extension in the registry, along with the bitset type holding
+    # one bit per id.
+    #   self            the LoaderSourceOutputGenerator object
+    def outputLoaderExtensionIds(self):
+        extension_ids = '\n// Every extension defined in the registry, each one the index of its bit in a LoaderRegistryExtensionBits\n'
+        extension_ids += 'enum LoaderExtensionId {\n'
+        for ext_name in self.registry_extension_names:
+            extension_ids += '    LOADER_EXTENSION_ID_%s,\n' % ext_name
+        extension_ids += '    LOADER_EXTENSION_ID_REGISTRY_COUNT\n'
+        extension_ids += '};\n\n'
+        extension_ids += 'typedef std::bitset<LOADER_EXTENSION_ID_REGISTRY_COUNT> LoaderRegistryExtensionBits;\n\n'
+        extension_ids += '// Names of the registry extensions, indexed by LoaderExtensionId\n'
+        extension_ids += 'extern const char* const g_loader_registry_extension_names[LOADER_EXTENSION_ID_REGISTRY_COUNT];\n\n'
+        return extension_ids
+
+    # Output the names of the registry extensions in the order of their ids.
+    #   self            the LoaderSourceOutputGenerator object
+    def outputLoaderExtensionNames(self):
+        extension_names = '// Names of the registry extensions, indexed by LoaderExtensionId\n'
+        extension_names += 'const char* const g_loader_registry_extension_names[LOADER_EXTENSION_ID_REGISTRY_COUNT] = {\n'
+        for ext_name in self.registry_extension_names:
+            extension_names += '    "%s",\n' % ext_name
+        extension_names += '};\n\n'
+        return extension_names
+
+    # The commands given a generated trampoline, which are the ones statistics are kept for.
+    #   self            the LoaderSourceOutputGenerator object
+    def statisticsCommandNames(self):
+        command_names = []
+        for cur_cmd in self.core_commands + self.ext_commands:
+            if cur_cmd.name in MANUAL_LOADER_INSTANCE_FUNCS or cur_cmd.name in MANUAL_LOADER_NONINSTANCE_FUNCS:
+                continue
+            command_names.append(cur_cmd.name)
+        return command_names
+
+    # Output an id for every command with a generated trampoline, indexing its statistics
+    # counters, along with the handle map query.
+    #   self            the LoaderSourceOutputGenerator object
+    def outputLoaderCommandIds(self):
+        command_ids = '// Per-command statistics are compiled into the trampolines\n'
+        command_ids += '#define LOADER_STATISTICS 1\n\n'
+        command_ids += '// Every command with a generated trampoline, each one the index of its statistics\n'
+        command_ids += 'enum LoaderCommandId {\n'
+        for command_name in self.statisticsCommandNames():
+            command_ids += '    LOADER_COMMAND_ID_%s,\n' % command_name
+        command_ids += '    LOADER_COMMAND_ID_COUNT\n'
+        command_ids += '};\n\n'
+        command_ids += '// Names of the commands, indexed by LoaderCommandId\n'
+        command_ids += 'extern const char* const g_loader_command_names[LOADER_COMMAND_ID_COUNT];\n\n'
+        command_ids += '// Number of entries currently in each handle map\n'
+        command_ids += 'void LoaderGetHandleMapSizes(std::vector<std::pair<XrObjectType, size_t>>& map_sizes);\n\n'
+        return command_ids
+
+    # Output the names of the commands in the order of their ids.
+    #   self            the LoaderSourceOutputGenerator object
+    def outputLoaderCommandNames(self):
+        command_names = '// Names of the commands, indexed by LoaderCommandId\n'
+        command_names += 'const char* const g_loader_command_names[LOADER_COMMAND_ID_COUNT] = {\n'
+        for command_name in self.statisticsCommandNames():
+            command_names += '    "%s",\n' % command_name
+        command_names += '};\n\n'
+        return command_names
+
+    # Output the query for the size of every handle map.
+    #   self            the LoaderSourceOutputGenerator object
+    def outputLoaderHandleMapSizes(self):
+        map_sizes = '// Number of entries currently in each handle map\n'
+        map_sizes += 'void LoaderGetHandleMapSizes(std::vector<std::pair<XrObjectType, size_t>>& map_sizes) {\n'
+        for handle in self.api_handles:
+            if handle.protect_value:
+                map_sizes += '#if %s\n' % handle.protect_string
+            base_handle_name = undecorate(handle.name)
+            map_sizes += '    {\n'
+            map_sizes += '        std::unique_lock<std::mutex> lock(g_%s_mutex);\n' % base_handle_name
+            map_sizes += '        map_sizes.emplace_back(%s, g_%s_map.size());\n' % (
+                self.genXrObjectType(handle.name), base_handle_name)
+            map_sizes += '    }\n'
+            if handle.protect_value:
+                map_sizes += '#endif // %s\n' % handle.protect_string
+        map_sizes += '}\n\n'
+        return map_sizes
+
     # Create prototypes for the loader's manually generated functions
     # so the generated code can call them.
     #   self            the LoaderSourceOutputGenerator object
@@ -292,7 +413,7 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
 
         generated_protos += '// Instance Init Dispatch Table (put all terminators in first)\n'
         generated_protos += 'void LoaderGenInitInstanceDispatchTable(XrInstance runtime_instance,\n'
-        generated_protos += '                                        std::unique_ptr<XrGeneratedDispatchTable>& table);\n\n'
+        generated_protos += '                                        LoaderUniquePtr<XrGeneratedDispatchTable>& table);\n\n'
         return generated_protos
 
     # Output global externs of unordered_maps and mutexes for each handle type.
@@ -303,7 +424,7 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
             if handle.protect_value:
                 map_externs += '#if %s\n' % handle.protect_string
             base_handle_name = undecorate(handle.name)
-            map_externs += 'extern std::unordered_map<%s, class LoaderInstance*> g_%s_map;\n' % (
+            map_externs += 'extern LoaderUnorderedMap<%s, class LoaderInstance*> g_%s_map;\n' % (
                 handle.name, base_handle_name)
             map_externs += 'extern std::mutex g_%s_mutex;\n' % base_handle_name
             if handle.protect_value:
@@ -373,7 +494,7 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
             base_handle_name = undecorate(handle.name)
             if handle.protect_value:
                 map_defines += '#if %s\n' % handle.protect_string
-            map_defines += 'std::unordered_map<%s, class LoaderInstance*> g_%s_map;\n' % (
+            map_defines += 'LoaderUnorderedMap<%s, class LoaderInstance*> g_%s_map;\n' % (
                 handle.name, base_handle_name)
             map_defines += 'std::mutex g_%s_mutex;\n' % base_handle_name
             if handle.protect_value:
@@ -391,6 +512,10 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
         map_defines += '                ++it;\n'
         map_defines += '            }\n'
         map_defines += '        }\n'
+        map_defines += '        // Hand back the buckets too, so nothing stays allocated through the application\'s callbacks\n'
+        map_defines += '        if (search_map.empty()) {\n'
+        map_defines += '            MapType().swap(search_map);\n'
+        map_defines += '        }\n'
         map_defines += '    } catch (...) {\n'
         map_defines += '        // Log a message, but don\'t throw an exception outside of this so we continue to erase the\n'
         map_defines += '        // remaining items in the remaining maps.\n'
@@ -405,7 +530,7 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
             if handle.protect_value:
                 map_defines += '#if %s\n' % handle.protect_string
             base_handle_name = undecorate(handle.name)
-            map_defines += '    EraseAllInstanceMapElements<std::unordered_map<%s, class LoaderInstance*>>' % handle.name
+            map_defines += '    EraseAllInstanceMapElements<LoaderUnorderedMap<%s, class LoaderInstance*>>' % handle.name
             map_defines += '(g_%s_map, g_%s_mutex, instance);\n' % (
                 base_handle_name, base_handle_name)
             if handle.protect_value:
@@ -433,6 +558,59 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
 
         return map_defines
 
+    # Output the out-of-line helpers the trampolines call to log errors when cold diagnostics are
+    # enabled.  Only the helpers the generated functions actually use are written, so none of them
+    # end up unused.
+    #   self            the LoaderSourceOutputGenerator object
+    #   generated_funcs the already generated trampolines and terminators
+    def outputLoaderColdDiagnostics(self, generated_funcs):
+        helpers = [
+            ('LoaderGenLogValidationError',
+             'LOADER_COLD static void LoaderGenLogValidationError(const char *vuid, const char *command_name, const char *message) {\n'
+             '    LoaderLogger::LogValidationErrorMessage(vuid, command_name, message);\n'
+             '}\n'),
+            ('LoaderGenLogInvalidHandle',
+             'LOADER_COLD static void LoaderGenLogInvalidHandle(const char *vuid, const char *command_name, const char *message,\n'
+             '                                                  XrObjectType object_type, uint64_t handle) {\n'
+             '    XrLoaderLogObjectInfo bad_object = {};\n'
+             '    bad_object.type = object_type;\n'
+             '    bad_object.handle = handle;\n'
+             '    std::vector<XrLoaderLogObjectInfo> loader_objects;\n'
+             '    loader_objects.push_back(bad_object);\n'
+             '    LoaderLogger::LogValidationErrorMessage(vuid, command_name, message, loader_objects);\n'
+             '}\n'),
+            ('LoaderGenLogInvalidArrayHandle',
+             'LOADER_COLD static void LoaderGenLogInvalidArrayHandle(const char *vuid, const char *command_name, const char *array_name,\n'
+             '                                                       uint32_t index, const char *problem, XrObjectType object_type,\n'
+             '                                                       uint64_t handle) {\n'
+             '    std::string message = array_name;\n'
+             '    message += "[" + std::to_string(index) + "]";\n'
+             '    message += problem;\n'
+             '    LoaderGenLogInvalidHandle(vuid, command_name, message.c_str(), object_type, handle);\n'
+             '}\n'),
+            ('LoaderGenLogError',
+             'LOADER_COLD static void LoaderGenLogError(const char *command_name, const char *message) {\n'
+             '    LoaderLogger::LogErrorMessage(command_name, message);\n'
+             '}\n'),
+            ('LoaderGenLogInstanceError',
+             'LOADER_COLD static void LoaderGenLogInstanceError(const char *command_name, XrInstance instance) {\n'
+             '    std::string error_message = command_name;\n'
+             '    error_message += " trampoline encountered an unknown error.  Likely XrInstance 0x";\n'
+             '    std::ostringstream oss;\n'
+             '    oss << std::hex << reinterpret_cast<const void*>(instance);\n'
+             '    error_message += oss.str();\n'
+             '    error_message += " is invalid";\n'
+             '    LoaderLogger::LogErrorMessage(command_name, error_message);\n'
+             '}\n'),
+        ]
+        cold_diagnostics = '\n// Error logging shared by the trampolines and terminators below, kept out of line so that\n'
+        cold_diagnostics += '// building messages and object lists doesn\'t take up space in the commands themselves.\n'
+        for name, helper in helpers:
+            if (name + '(') in generated_funcs:
+                cold_diagnostics += helper
+                cold_diagnostics += '\n'
+        return cold_diagnostics
+
     # Output loader generated functions.  This has special cases for create and destroy commands
     # since we have to associate the created objects with the original instance during the create,
     # and then remove that association in the delete.
@@ -440,6 +618,7 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
     def outputLoaderGeneratedFuncs(self):
         cur_extension_name = ''
         generated_funcs = '\n// Automatically generated instance trampolines and terminators\n'
+        log_error = 'LoaderGenLogError' if self.genOpts.coldDiagnostics else 'LoaderLogger::LogErrorMessage'
         count = 0
         for x in range(0, 2):
             if x == 0:
@@ -503,16 +682,22 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                                 if not param.is_optional:
                                     # Check we have at least 1 in the array.
                                     tramp_variable_defines += '        if (0 == %s) {\n' % param.pointer_count_var
-                                    tramp_variable_defines += '            XrLoaderLogObjectInfo bad_object = {};\n'
-                                    tramp_variable_defines += '            bad_object.type = %s;\n' % self.genXrObjectType(
-                                        param.type)
-                                    tramp_variable_defines += '            bad_object.handle = reinterpret_cast<uint64_t const&>(%s);\n' % first_handle_name
-                                    tramp_variable_defines += '            std::vector<XrLoaderLogObjectInfo> loader_objects;\n'
-                                    tramp_variable_defines += '            loader_objects.push_back(bad_object);\n'
-                                    tramp_variable_defines += '            LoaderLogger::LogValidationErrorMessage("VUID-%s-%s-parameter", "%s",\n' % (
-                                        cur_cmd.name, param.pointer_count_var, cur_cmd.name)
-                                    tramp_variable_defines += '                                                    "%s is 0, but %s is not optional", std::vector<XrLoaderLogObjectInfo>{});\n' % (
-                                        param.pointer_count_var, param.name)
+                                    if self.genOpts.coldDiagnostics:
+                                        tramp_variable_defines += '            LoaderGenLogValidationError("VUID-%s-%s-parameter", "%s",\n' % (
+                                            cur_cmd.name, param.pointer_count_var, cur_cmd.name)
+                                        tramp_variable_defines += '                                        "%s is 0, but %s is not optional");\n' % (
+                                            param.pointer_count_var, param.name)
+                                    else:
+                                        tramp_variable_defines += '            XrLoaderLogObjectInfo bad_object = {};\n'
+                                        tramp_variable_defines += '            bad_object.type = %s;\n' % self.genXrObjectType(
+                                            param.type)
+                                        tramp_variable_defines += '            bad_object.handle = reinterpret_cast<uint64_t const&>(%s);\n' % first_handle_name
+                                        tramp_variable_defines += '            std::vector<XrLoaderLogObjectInfo> loader_objects;\n'
+                                        tramp_variable_defines += '            loader_objects.push_back(bad_object);\n'
+                                        tramp_variable_defines += '            LoaderLogger::LogValidationErrorMessage("VUID-%s-%s-parameter", "%s",\n' % (
+                                            cur_cmd.name, param.pointer_count_var, cur_cmd.name)
+                                        tramp_variable_defines += '                                                    "%s is 0, but %s is not optional", std::vector<XrLoaderLogObjectInfo>{});\n' % (
+                                            param.pointer_count_var, param.name)
                                     tramp_variable_defines += '        }\n'
                             secondary_mutex_name = 'g_%s_mutex' % base_handle_name
                             tramp_variable_defines += '        std::unique_lock<std::mutex> secondary_lock(%s);\n' % secondary_mutex_name
@@ -532,39 +717,53 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                                 tramp_variable_defines += '            LoaderInstance *elt_loader_instance = g_%s_map[%s[i]];\n' % (
                                     base_handle_name, param.name)
                                 tramp_variable_defines += '            if (elt_loader_instance == nullptr || elt_loader_instance != loader_instance) {\n'
-                                tramp_variable_defines += '                XrLoaderLogObjectInfo bad_object = {};\n'
-                                tramp_variable_defines += '                bad_object.type = %s;\n' % self.genXrObjectType(
-                                    param.type)
-                                tramp_variable_defines += '                bad_object.handle = reinterpret_cast<uint64_t const&>(%s[i]);\n' % param.name
-                                tramp_variable_defines += '                std::vector<XrLoaderLogObjectInfo> loader_objects;\n'
-                                tramp_variable_defines += '                loader_objects.push_back(bad_object);\n'
-                                tramp_variable_defines += '                if (elt_loader_instance == nullptr) {\n'
-                                tramp_variable_defines += '                    LoaderLogger::LogValidationErrorMessage("VUID-%s-%s-parameter", "%s",\n' % (
-                                    cur_cmd.name, param.name, cur_cmd.name)
-                                tramp_variable_defines += '                                                    "%s[" + std::to_string(i) + "] is not a valid %s", loader_objects);\n' % (
-                                    param.name, param.type)
-                                tramp_variable_defines += '                } else {\n'
-                                tramp_variable_defines += '                    LoaderLogger::LogValidationErrorMessage("VUID-%s-%s-parameter", "%s",\n' % (
-                                    cur_cmd.name, param.name, cur_cmd.name)
-                                tramp_variable_defines += '                                                            "%s[" + std::to_string(i) + "] belongs to a different instance than %s[0]", loader_objects);\n' % (
-                                    param.name, param.name)
-                                tramp_variable_defines += '                }\n'
+                                if self.genOpts.coldDiagnostics:
+                                    tramp_variable_defines += '                LoaderGenLogInvalidArrayHandle("VUID-%s-%s-parameter", "%s", "%s", i,\n' % (
+                                        cur_cmd.name, param.name, cur_cmd.name, param.name)
+                                    tramp_variable_defines += '                                               elt_loader_instance == nullptr ? " is not a valid %s"\n' % param.type
+                                    tramp_variable_defines += '                                                                              : " belongs to a different instance than %s[0]",\n' % param.name
+                                    tramp_variable_defines += '                                               %s, reinterpret_cast<uint64_t const&>(%s[i]));\n' % (
+                                        self.genXrObjectType(param.type), param.name)
+                                else:
+                                    tramp_variable_defines += '                XrLoaderLogObjectInfo bad_object = {};\n'
+                                    tramp_variable_defines += '                bad_object.type = %s;\n' % self.genXrObjectType(
+                                        param.type)
+                                    tramp_variable_defines += '                bad_object.handle = reinterpret_cast<uint64_t const&>(%s[i]);\n' % param.name
+                                    tramp_variable_defines += '                std::vector<XrLoaderLogObjectInfo> loader_objects;\n'
+                                    tramp_variable_defines += '                loader_objects.push_back(bad_object);\n'
+                                    tramp_variable_defines += '                if (elt_loader_instance == nullptr) {\n'
+                                    tramp_variable_defines += '                    LoaderLogger::LogValidationErrorMessage("VUID-%s-%s-parameter", "%s",\n' % (
+                                        cur_cmd.name, param.name, cur_cmd.name)
+                                    tramp_variable_defines += '                                                    "%s[" + std::to_string(i) + "] is not a valid %s", loader_objects);\n' % (
+                                        param.name, param.type)
+                                    tramp_variable_defines += '                } else {\n'
+                                    tramp_variable_defines += '                    LoaderLogger::LogValidationErrorMessage("VUID-%s-%s-parameter", "%s",\n' % (
+                                        cur_cmd.name, param.name, cur_cmd.name)
+                                    tramp_variable_defines += '                                                            "%s[" + std::to_string(i) + "] belongs to a different instance than %s[0]", loader_objects);\n' % (
+                                        param.name, param.name)
+                                    tramp_variable_defines += '                }\n'
                                 if has_return:
                                     tramp_variable_defines += '                return XR_ERROR_HANDLE_INVALID;\n'
                                 tramp_variable_defines += '            }\n'
                                 tramp_variable_defines += '        }\n'
                             tramp_variable_defines += '        secondary_lock.unlock();\n'
                             tramp_variable_defines += '        if (nullptr == loader_instance) {\n'
-                            tramp_variable_defines += '            XrLoaderLogObjectInfo bad_object = {};\n'
-                            tramp_variable_defines += '            bad_object.type = %s;\n' % self.genXrObjectType(
-                                param.type)
-                            tramp_variable_defines += '            bad_object.handle = reinterpret_cast<uint64_t const&>(%s);\n' % first_handle_name
-                            tramp_variable_defines += '            std::vector<XrLoaderLogObjectInfo> loader_objects;\n'
-                            tramp_variable_defines += '            loader_objects.push_back(bad_object);\n'
-                            tramp_variable_defines += '            LoaderLogger::LogValidationErrorMessage("VUID-%s-%s-parameter", "%s",\n' % (
-                                cur_cmd.name, param.name, cur_cmd.name)
-                            tramp_variable_defines += '                                                    "%s is not a valid %s", loader_objects);\n' % (
-                                first_handle_name, param.type)
+                            if self.genOpts.coldDiagnostics:
+                                tramp_variable_defines += '            LoaderGenLogInvalidHandle("VUID-%s-%s-parameter", "%s", "%s is not a valid %s",\n' % (
+                                    cur_cmd.name, param.name, cur_cmd.name, first_handle_name, param.type)
+                                tramp_variable_defines += '                                      %s, reinterpret_cast<uint64_t const&>(%s));\n' % (
+                                    self.genXrObjectType(param.type), first_handle_name)
+                            else:
+                                tramp_variable_defines += '            XrLoaderLogObjectInfo bad_object = {};\n'
+                                tramp_variable_defines += '            bad_object.type = %s;\n' % self.genXrObjectType(
+                                    param.type)
+                                tramp_variable_defines += '            bad_object.handle = reinterpret_cast<uint64_t const&>(%s);\n' % first_handle_name
+                                tramp_variable_defines += '            std::vector<XrLoaderLogObjectInfo> loader_objects;\n'
+                                tramp_variable_defines += '            loader_objects.push_back(bad_object);\n'
+                                tramp_variable_defines += '            LoaderLogger::LogValidationErrorMessage("VUID-%s-%s-parameter", "%s",\n' % (
+                                    cur_cmd.name, param.name, cur_cmd.name)
+                                tramp_variable_defines += '                                                    "%s is not a valid %s", loader_objects);\n' % (
+                                    first_handle_name, param.type)
                             if has_return:
                                 tramp_variable_defines += '            return XR_ERROR_HANDLE_INVALID;\n'
                             tramp_variable_defines += '        }\n'
@@ -572,7 +771,7 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                             tramp_variable_defines += self.printCodeGenErrorMessage(
                                 'Command %s does not have an OpenXR Object handle as the first parameter.' % cur_cmd.name)
 
-                        tramp_variable_defines += '        const std::unique_ptr<XrGeneratedDispatchTable>& dispatch_table = loader_instance->DispatchTable();\n'
+                        tramp_variable_defines += '        const LoaderUniquePtr<XrGeneratedDispatchTable>& dispatch_table = loader_instance->DispatchTable();\n'
 
                     tramp_param_replace.append(
                         self.MemberOrParam(type=param.type,
@@ -629,10 +828,14 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
 
                 # If this is not core, but an extension, check to make sure the extension is enabled.
                 if x == 1:
-                    generated_funcs += '        if (!loader_instance->ExtensionIsEnabled("%s")) {\n' % (
+                    generated_funcs += '        if (!loader_instance->ExtensionIsEnabled(LOADER_EXTENSION_ID_%s)) {\n' % (
                         cur_cmd.ext_name)
-                    generated_funcs += '            LoaderLogger::LogValidationErrorMessage("VUID-%s-extension-notenabled",\n' % cur_cmd.name
-                    generated_funcs += '                                                    "%s",\n' % cur_cmd.name
+                    if self.genOpts.coldDiagnostics:
+                        generated_funcs += '            LoaderGenLogValidationError("VUID-%s-extension-notenabled", "%s",\n' % (
+                            cur_cmd.name, cur_cmd.name)
+                    else:
+                        generated_funcs += '            LoaderLogger::LogValidationErrorMessage("VUID-%s-extension-notenabled",\n' % cur_cmd.name
+                        generated_funcs += '                                                    "%s",\n' % cur_cmd.name
                     generated_funcs += '                                                    "The %s extension has not been enabled prior to calling %s");\n' % (
                         cur_cmd.ext_name, cur_cmd.name)
                     if has_return:
@@ -641,6 +844,10 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                         generated_funcs += '            return;\n'
                     generated_funcs += '        }\n\n'
 
+                # Times the call down the chain, up to the end of the scope
+                if self.genOpts.loaderStatistics:
+                    generated_funcs += '        LoaderCommandTimer command_timer(LOADER_COMMAND_ID_%s);\n' % cur_cmd.name
+
                 if has_return:
                     if just_return_call:
                         generated_funcs += '        return '
@@ -666,13 +873,19 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                     generated_funcs += '        return result;\n'
                 if cur_cmd.is_create_connect:
                     generated_funcs += '    } catch (std::bad_alloc &) {\n'
-                    generated_funcs += '        LoaderLogger::LogErrorMessage("%s", "%s trampoline failed allocating memory");\n' % (
-                        cur_cmd.name, cur_cmd.name)
+                    generated_funcs += '        %s("%s", "%s trampoline failed allocating memory");\n' % (
+                        log_error, cur_cmd.name, cur_cmd.name)
                     generated_funcs += '        return XR_ERROR_OUT_OF_MEMORY;\n'
                     generated_funcs += '    } catch (...) {\n'
-                    generated_funcs += '        LoaderLogger::LogErrorMessage("%s", "%s trampoline encountered an unknown error");\n' % (
-                        cur_cmd.name, cur_cmd.name)
+                    generated_funcs += '        %s("%s", "%s trampoline encountered an unknown error");\n' % (
+                        log_error, cur_cmd.name, cur_cmd.name)
                     generated_funcs += '        return XR_ERROR_INITIALIZATION_FAILED;\n'
+                elif cur_cmd.params[0].type == 'XrInstance' and self.genOpts.coldDiagnostics:
+                    generated_funcs += '    } catch (...) {\n'
+                    generated_funcs += '        LoaderGenLogInstanceError("%s", %s);\n' % (
+                        cur_cmd.name, cur_cmd.params[0].name)
+                    if has_return:
+                        generated_funcs += '        return XR_ERROR_HANDLE_INVALID;\n'
                 elif cur_cmd.params[0].type == 'XrInstance':
                     generated_funcs += '    } catch (...) {\n'
                     generated_funcs += '        std::string error_message = "%s trampoline encountered an unknown error.  Likely XrInstance 0x";\n' % cur_cmd.name
@@ -686,8 +899,8 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                         generated_funcs += '        return XR_ERROR_HANDLE_INVALID;\n'
                 elif has_return:
                     generated_funcs += '    } catch (...) {\n'
-                    generated_funcs += '        LoaderLogger::LogErrorMessage("%s", "%s trampoline encountered an unknown error");\n' % (
-                        cur_cmd.name, cur_cmd.name)
+                    generated_funcs += '        %s("%s", "%s trampoline encountered an unknown error");\n' % (
+                        log_error, cur_cmd.name, cur_cmd.name)
                     generated_funcs += '        // NOTE: Most calls only allow XR_SUCCESS as a return code\n'
                     generated_funcs += '        return XR_SUCCESS;\n'
 
@@ -744,8 +957,8 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                     if has_return and not just_return_call:
                         generated_funcs += '        return result;\n'
                     generated_funcs += '    } catch (...) {\n'
-                    generated_funcs += '        LoaderLogger::LogErrorMessage("%s", "%s terminator encountered an unknown error");\n' % (
-                        cur_cmd.name, cur_cmd.name)
+                    generated_funcs += '        %s("%s", "%s terminator encountered an unknown error");\n' % (
+                        log_error, cur_cmd.name, cur_cmd.name)
                     if has_return:
                         generated_funcs += '        // NOTE: Most calls only allow XR_SUCCESS as a return code\n'
                         generated_funcs += '        return XR_SUCCESS;\n'
@@ -869,7 +1082,7 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                             base_name)
                 else:
                     export_funcs += self.writeIndent(indent)
-                    export_funcs += 'if (loader_instance->ExtensionIsEnabled("%s")) {\n' % (
+                    export_funcs += 'if (loader_instance->ExtensionIsEnabled(LOADER_EXTENSION_ID_%s)) {\n' % (
                         cur_cmd.ext_name)
                     export_funcs += self.writeIndent(indent + 1)
                     if cur_cmd.has_instance or cur_cmd.name in MANUAL_LOADER_INSTANCE_FUNCS or cur_cmd.name in MANUAL_LOADER_NONINSTANCE_FUNCS:
@@ -887,6 +1100,13 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                 indent = indent - 1
         export_funcs += self.writeIndent(indent)
         export_funcs += '}\n'
+        if self.genOpts.loaderStatistics:
+            export_funcs += self.writeIndent(indent)
+            export_funcs += 'if (*function == nullptr && loader_instance != nullptr) {\n'
+            export_funcs += self.writeIndent(indent + 1)
+            export_funcs += 'LoaderStatistics::GetInstanceProcAddr(loader_instance, name, function);\n'
+            export_funcs += self.writeIndent(indent)
+            export_funcs += '}\n'
         indent = indent - 1
         export_funcs += self.writeIndent(indent)
         export_funcs += '}\n'
@@ -905,6 +1125,8 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
         export_funcs += '\n// Terminator GetInstanceProcAddr function\n'
         export_funcs += 'XRAPI_ATTR XrResult XRAPI_CALL LoaderXrTermGetInstanceProcAddr(XrInstance instance, const char* name,\n'
         export_funcs += '                                                               PFN_xrVoidFunction* function) {\n'
+        export_funcs += '    // Layers forward names they do not handle here, so never trust what the caller left in function\n'
+        export_funcs += '    *function = nullptr;\n'
 
         count = 0
         for x in range(0, 2):
@@ -955,7 +1177,7 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
         export_funcs += '    return RuntimeInterface::GetInstanceProcAddr(instance, name, function);\n'
         export_funcs += '}\n\n'
         export_funcs += '// Instance Init Dispatch Table (put all terminators in first)\n'
-        export_funcs += 'void LoaderGenInitInstanceDispatchTable(XrInstance instance, std::unique_ptr<XrGeneratedDispatchTable>& table) {\n'
+        export_funcs += 'void LoaderGenInitInstanceDispatchTable(XrInstance instance, LoaderUniquePtr<XrGeneratedDispatchTable>& table) {\n'
 
         count = 0
         for x in range(0, 2):
@@ -987,8 +1209,9 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                 if cur_cmd.protect_value:
                     export_funcs += '#endif // %s\n' % cur_cmd.protect_string
         export_funcs += '}\n\n'
-        export_funcs += '// Instance Update Dispatch Table with an API Layer Interface\n'
-        export_funcs += 'void ApiLayerInterface::GenUpdateInstanceDispatchTable(XrInstance instance, std::unique_ptr<XrGeneratedDispatchTable>& table) {\n'
+        export_funcs += '// Instance Update Dispatch Table with the commands get_instance_proc_addr resolves to, normally the topmost API layer\'s\n'
+        export_funcs += 'void ApiLayerInterface::GenUpdateInstanceDispatchTable(XrInstance instance, PFN_xrGetInstanceProcAddr get_instance_proc_addr,\n'
+        export_funcs += '                                                       LoaderUniquePtr<XrGeneratedDispatchTable>& table) {\n'
         export_funcs += '    PFN_xrVoidFunction cur_func_ptr;\n'
         count = 0
         for x in range(0, 2):
@@ -1013,9 +1236,9 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
 
                 if cur_cmd.name not in NO_TRAMPOLINE_OR_TERMINATOR:
                     if cur_cmd.name == 'xrGetInstanceProcAddr':
-                        export_funcs += '    table->GetInstanceProcAddr = _get_instant_proc_addr;\n'
+                        export_funcs += '    table->GetInstanceProcAddr = get_instance_proc_addr;\n'
                     else:
-                        export_funcs += '    _get_instant_proc_addr(instance, "%s", &cur_func_ptr);\n' % cur_cmd.name
+                        export_funcs += '    get_instance_proc_addr(instance, "%s", &cur_func_ptr);\n' % cur_cmd.name
                         export_funcs += '    if (nullptr != cur_func_ptr) {\n'
                         export_funcs += '        table->%s = reinterpret_cast<PFN_%s>(cur_func_ptr);\n' % (base_name, cur_cmd.name)
                         export_funcs += '    }\n'
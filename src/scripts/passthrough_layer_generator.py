@@ -0,0 +1,350 @@
+#!/usr/bin/python3 -i
+#
+# Copyright (c) 2019 The Khronos Group Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Purpose:      This file utilizes the content formatted in the
+#               automatic_source_generator.py class to produce the
+#               generated source code for the pass-through API layer.
+
+import os
+import re
+import sys
+from automatic_source_generator import *
+from collections import namedtuple
+
+MANUALLY_DEFINED_IN_LAYER = [
+    'xrCreateInstance',
+    'xrDestroyInstance',
+]
+
+DONT_GEN_IN_LAYER = [
+    'xrEnumerateApiLayerProperties',
+    'xrEnumerateInstanceExtensionProperties',
+]
+
+# PassthroughGeneratorOptions - subclass of AutomaticSourceGeneratorOptions.
+
+
+class PassthroughGeneratorOptions(AutomaticSourceGeneratorOptions):
+    def __init__(self,
+                 filename=None,
+                 directory='.',
+                 apiname=None,
+                 profile=None,
+                 versions='.*',
+                 emitversions='.*',
+                 defaultExtensions=None,
+                 addExtensions=None,
+                 removeExtensions=None,
+                 emitExtensions=None,
+                 sortProcedure=regSortFeatures,
+                 prefixText="",
+                 genFuncPointers=True,
+                 protectFile=True,
+                 protectFeature=True,
+                 protectProto=None,
+                 protectProtoStr=None,
+                 apicall='',
+                 apientry='',
+                 apientryp='',
+                 indentFuncProto=True,
+                 indentFuncPointer=False,
+                 alignFuncParam=0,
+                 genEnumBeginEndRange=False):
+        AutomaticSourceGeneratorOptions.__init__(self, filename, directory, apiname, profile,
+                                                 versions, emitversions, defaultExtensions,
+                                                 addExtensions, removeExtensions,
+                                                 emitExtensions, sortProcedure)
+
+# PassthroughOutputGenerator - subclass of AutomaticSourceOutputGenerator.
+
+
+class PassthroughOutputGenerator(AutomaticSourceOutputGenerator):
+    """Generate pass-through layer source using XML element attributes from registry"""
+
+    def __init__(self,
+                 errFile=sys.stderr,
+                 warnFile=sys.stderr,
+                 diagFile=sys.stdout):
+        AutomaticSourceOutputGenerator.__init__(
+            self, errFile, warnFile, diagFile)
+
+    # Override the base class header warning so the comment indicates this file.
+    #   self            the AutomaticSourceOutputGenerator object
+    def outputGeneratedHeaderWarning(self):
+        # File Comment
+        generated_warning = '// *********** THIS FILE IS GENERATED - DO NOT EDIT ***********\n'
+        generated_warning += '//     See passthrough_layer_generator.py for modifications\n'
+        generated_warning += '// ************************************************************\n'
+        write(generated_warning, file=self.outFile)
+
+    # Call the base class to properly begin the file, and then add
+    # the file-specific header information.
+    #   self            the PassthroughOutputGenerator object
+    #   gen_opts        the PassthroughGeneratorOptions object
+    def beginFile(self, genOpts):
+        AutomaticSourceOutputGenerator.beginFile(self, genOpts)
+        preamble = ''
+        if self.genOpts.filename == 'xr_generated_passthrough.hpp':
+            preamble += '#pragma once\n\n'
+            preamble += '#include <atomic>\n'
+            preamble += '#include <cstring>\n'
+            preamble += '#include <mutex>\n'
+            preamble += '#include <unordered_map>\n\n'
+            preamble += '#include "api_layer_platform_defines.h"\n'
+            preamble += '#include <openxr/openxr.h>\n'
+            preamble += '#include <openxr/openxr_platform.h>\n\n'
+            preamble += '#include "xr_generated_dispatch_table.h"\n'
+        elif self.genOpts.filename == 'xr_generated_passthrough.cpp':
+            preamble += '#include "xr_generated_passthrough.hpp"\n'
+        write(preamble, file=self.outFile)
+
+    # Write out all the information for the appropriate file,
+    # and then call down to the base class to wrap everything up.
+    #   self            the PassthroughOutputGenerator object
+    def endFile(self):
+        file_data = ''
+        if self.genOpts.filename == 'xr_generated_passthrough.hpp':
+            file_data += self.outputLayerState()
+            file_data += self.outputLayerCommands()
+
+        elif self.genOpts.filename == 'xr_generated_passthrough.cpp':
+            file_data += self.outputLayerStateCleanUp()
+
+        write(file_data, file=self.outFile)
+
+        # Finish processing in superclass
+        AutomaticSourceOutputGenerator.endFile(self)
+
+    # Output the per-slot state: one unordered_map per handle type, from handle to the next dispatch
+    # table, and the shortcut used while only one instance exists.
+    #   self            the PassthroughOutputGenerator object
+    def outputLayerState(self):
+        state = '\n// Number of times the layer can appear in the same call chain.  Each appearance gets its own\n'
+        state += '// slot, with its own copy of every command and its own next dispatch tables.\n'
+        state += '#define XR_PASSTHROUGH_LAYER_MAX_SLOTS 16\n\n'
+        state += 'struct PassthroughLayerState {\n'
+        state += '    // The next dispatch table while exactly one instance exists, so commands need no lookup\n'
+        state += '    std::atomic<XrGeneratedDispatchTable*> only_dispatch;\n'
+        state += '    std::mutex map_mutex;\n'
+        for handle in self.api_handles:
+            base_handle_name = undecorate(handle.name)
+            if handle.protect_value:
+                state += '#if %s\n' % handle.protect_string
+            state += '    std::unordered_map<%s, XrGeneratedDispatchTable*> %s_dispatch_map;\n' % (
+                handle.name, base_handle_name)
+            if handle.protect_value:
+                state += '#endif // %s\n' % handle.protect_string
+        state += '};\n\n'
+        state += 'extern PassthroughLayerState g_passthrough_state[XR_PASSTHROUGH_LAYER_MAX_SLOTS];\n\n'
+        state += '// Drop every map entry using the given table.  Call with state.map_mutex held.\n'
+        state += 'void PassthroughLayerCleanUpMapsForTable(PassthroughLayerState &state, XrGeneratedDispatchTable *table);\n\n'
+        state += '// Find the next dispatch table for a handle, only touching the maps when several instances exist.\n'
+        state += 'template <typename HandleType>\n'
+        state += 'XrGeneratedDispatchTable *PassthroughLayerNextDispatch(PassthroughLayerState &state,\n'
+        state += '                                                      std::unordered_map<HandleType, XrGeneratedDispatchTable *> &dispatch_map,\n'
+        state += '                                                      HandleType handle) {\n'
+        state += '    XrGeneratedDispatchTable *only_dispatch = state.only_dispatch.load(std::memory_order_acquire);\n'
+        state += '    if (nullptr != only_dispatch) {\n'
+        state += '        return only_dispatch;\n'
+        state += '    }\n'
+        state += '    std::unique_lock<std::mutex> lock(state.map_mutex);\n'
+        state += '    auto found = dispatch_map.find(handle);\n'
+        state += '    return (found == dispatch_map.end()) ? nullptr : found->second;\n'
+        state += '}\n\n'
+        state += '// Manually written\n'
+        state += 'template <uint32_t Slot>\n'
+        state += 'XrResult PassthroughLayerXrDestroyInstance(XrInstance instance);\n'
+        return state
+
+    # Output the function that drops a destroyed instance's entries from every map.
+    #   self            the PassthroughOutputGenerator object
+    def outputLayerStateCleanUp(self):
+        clean_up = '\nPassthroughLayerState g_passthrough_state[XR_PASSTHROUGH_LAYER_MAX_SLOTS];\n\n'
+        clean_up += 'template <typename MapType>\n'
+        clean_up += 'static void EraseAllTableMapElements(MapType &search_map, XrGeneratedDispatchTable *search_value) {\n'
+        clean_up += '    for (auto it = search_map.begin(); it != search_map.end();) {\n'
+        clean_up += '        if (it->second == search_value) {\n'
+        clean_up += '            search_map.erase(it++);\n'
+        clean_up += '        } else {\n'
+        clean_up += '            ++it;\n'
+        clean_up += '        }\n'
+        clean_up += '    }\n'
+        clean_up += '}\n\n'
+        clean_up += 'void PassthroughLayerCleanUpMapsForTable(PassthroughLayerState &state, XrGeneratedDispatchTable *table) {\n'
+        for handle in self.api_handles:
+            base_handle_name = undecorate(handle.name)
+            if handle.protect_value:
+                clean_up += '#if %s\n' % handle.protect_string
+            clean_up += '    EraseAllTableMapElements(state.%s_dispatch_map, table);\n' % base_handle_name
+            if handle.protect_value:
+                clean_up += '#endif // %s\n' % handle.protect_string
+        clean_up += '}\n'
+        return clean_up
+
+    # Write a pass-through template for every command we know about, and the layer's
+    # xrGetInstanceProcAddr to hand them out.
+    #   self            the PassthroughOutputGenerator object
+    def outputLayerCommands(self):
+        cur_extension_name = ''
+        generated_commands = '\n// Automatically generated pass-through layer commands\n'
+        for x in range(0, 2):
+            if x == 0:
+                commands = self.core_commands
+            else:
+                commands = self.ext_commands
+
+            for cur_cmd in commands:
+                if cur_cmd.ext_name != cur_extension_name:
+                    if self.isCoreExtensionName(cur_cmd.ext_name):
+                        generated_commands += '\n// ---- Core %s commands\n' % cur_cmd.ext_name[11:].replace(
+                            "_", ".")
+                    else:
+                        generated_commands += '\n// ---- %s extension commands\n' % cur_cmd.ext_name
+                    cur_extension_name = cur_cmd.ext_name
+
+                if cur_cmd.name in DONT_GEN_IN_LAYER or cur_cmd.name in MANUALLY_DEFINED_IN_LAYER:
+                    continue
+
+                # We fill in the GetInstanceProcAddr manually at the end
+                if cur_cmd.name == 'xrGetInstanceProcAddr':
+                    continue
+
+                is_create = (('xrCreate' in cur_cmd.name or 'xrConnect' in cur_cmd.name) and cur_cmd.params[-1].is_handle)
+                is_destroy = (('xrDestroy' in cur_cmd.name or 'xrDisconnect' in cur_cmd.name) and cur_cmd.params[-1].is_handle)
+                base_name = cur_cmd.name[2:]
+
+                if cur_cmd.protect_value:
+                    generated_commands += '#if %s\n' % cur_cmd.protect_string
+
+                prototype = cur_cmd.cdecl.replace(" xr", " PassthroughLayerXr")
+                prototype = prototype.replace("XRAPI_ATTR ", "")
+                prototype = prototype.replace(" XRAPI_CALL ", " ")
+                prototype = prototype.replace(";", " {\n")
+                generated_commands += 'template <uint32_t Slot>\n'
+                generated_commands += prototype
+
+                if cur_cmd.return_type is None or cur_cmd.return_type.text != 'XrResult':
+                    generated_commands += self.printCodeGenErrorMessage(
+                        'Command %s does not return an XrResult.' % cur_cmd.name)
+                if not cur_cmd.params[0].is_handle:
+                    generated_commands += self.printCodeGenErrorMessage(
+                        'Command %s does not have an OpenXR Object handle as the first parameter.' % cur_cmd.name)
+
+                # Find the next dispatch table from the first handle
+                base_handle_name = undecorate(cur_cmd.params[0].type)
+                first_handle_name = self.getFirstHandleName(cur_cmd.params[0])
+                generated_commands += '    PassthroughLayerState &state = g_passthrough_state[Slot];\n'
+                generated_commands += '    XrGeneratedDispatchTable *next_dispatch = PassthroughLayerNextDispatch(state, state.%s_dispatch_map, %s);\n' % (
+                    base_handle_name, first_handle_name)
+                generated_commands += '    if (nullptr == next_dispatch) {\n'
+                generated_commands += '        return XR_ERROR_HANDLE_INVALID;\n'
+                generated_commands += '    }\n'
+
+                call = 'next_dispatch->%s(' % base_name
+                call += ', '.join(param.name for param in cur_cmd.params)
+                call += ')'
+
+                # Created handles use the same next dispatch table as their parent, and destroyed
+                # ones are dropped again.
+                if is_create or is_destroy:
+                    second_base_handle_name = undecorate(cur_cmd.params[-1].type)
+                    last_param_name = cur_cmd.params[-1].name
+                    generated_commands += '    XrResult result = %s;\n' % call
+                    if is_create:
+                        generated_commands += '    if (XR_SUCCEEDED(result) && nullptr != %s) {\n' % last_param_name
+                        generated_commands += '        try {\n'
+                        generated_commands += '            std::unique_lock<std::mutex> lock(state.map_mutex);\n'
+                        generated_commands += '            state.%s_dispatch_map[*%s] = next_dispatch;\n' % (
+                            second_base_handle_name, last_param_name)
+                        generated_commands += '        } catch (...) {\n'
+                        generated_commands += '            return XR_ERROR_OUT_OF_MEMORY;\n'
+                        generated_commands += '        }\n'
+                        generated_commands += '    }\n'
+                    else:
+                        generated_commands += '    if (XR_SUCCEEDED(result)) {\n'
+                        generated_commands += '        std::unique_lock<std::mutex> lock(state.map_mutex);\n'
+                        generated_commands += '        state.%s_dispatch_map.erase(%s);\n' % (
+                            second_base_handle_name, last_param_name)
+                        generated_commands += '    }\n'
+                    generated_commands += '    return result;\n'
+                else:
+                    generated_commands += '    return %s;\n' % call
+                generated_commands += '}\n\n'
+
+                if cur_cmd.protect_value:
+                    generated_commands += '#endif // %s\n' % cur_cmd.protect_string
+
+        # Output the xrGetInstanceProcAddr command for the pass-through layer.
+        generated_commands += '\n// Layer\'s xrGetInstanceProcAddr\n'
+        generated_commands += 'template <uint32_t Slot>\n'
+        generated_commands += 'XrResult PassthroughLayerXrGetInstanceProcAddr(\n'
+        generated_commands += '    XrInstance                                  instance,\n'
+        generated_commands += '    const char*                                 name,\n'
+        generated_commands += '    PFN_xrVoidFunction*                         function) {\n'
+        generated_commands += '    if (0 == strcmp(name, "xrGetInstanceProcAddr")) {\n'
+        generated_commands += '        *function = reinterpret_cast<PFN_xrVoidFunction>(PassthroughLayerXrGetInstanceProcAddr<Slot>);\n'
+        generated_commands += '        return XR_SUCCESS;\n'
+        generated_commands += '    }\n\n'
+        generated_commands += '    PassthroughLayerState &state = g_passthrough_state[Slot];\n'
+        generated_commands += '    XrGeneratedDispatchTable *next_dispatch = PassthroughLayerNextDispatch(state, state.instance_dispatch_map, instance);\n'
+        generated_commands += '    if (nullptr == next_dispatch) {\n'
+        generated_commands += '        *function = nullptr;\n'
+        generated_commands += '        return XR_ERROR_HANDLE_INVALID;\n'
+        generated_commands += '    }\n\n'
+        generated_commands += '    // Only step into the chain for commands something below actually implements\n'
+        generated_commands += '    XrResult result = next_dispatch->GetInstanceProcAddr(instance, name, function);\n'
+        generated_commands += '    if (XR_FAILED(result) || nullptr == *function) {\n'
+        generated_commands += '        return result;\n'
+        generated_commands += '    }\n'
+
+        count = 0
+        for x in range(0, 2):
+            if x == 0:
+                commands = self.core_commands
+            else:
+                commands = self.ext_commands
+
+            for cur_cmd in commands:
+                if cur_cmd.ext_name != cur_extension_name:
+                    if self.isCoreExtensionName(cur_cmd.ext_name):
+                        generated_commands += '\n    // ---- Core %s commands\n' % cur_cmd.ext_name[11:].replace(
+                            "_", ".")
+                    else:
+                        generated_commands += '\n    // ---- %s extension commands\n' % cur_cmd.ext_name
+                    cur_extension_name = cur_cmd.ext_name
+
+                if cur_cmd.name in DONT_GEN_IN_LAYER or cur_cmd.name == 'xrCreateInstance' or cur_cmd.name == 'xrGetInstanceProcAddr':
+                    continue
+
+                layer_command_name = cur_cmd.name.replace("xr", "PassthroughLayerXr", 1)
+
+                if cur_cmd.protect_value:
+                    generated_commands += '#if %s\n' % cur_cmd.protect_string
+
+                if count == 0:
+                    generated_commands += '    if (0 == strcmp(name, "%s")) {\n' % cur_cmd.name
+                else:
+                    generated_commands += '    } else if (0 == strcmp(name, "%s")) {\n' % cur_cmd.name
+                count = count + 1
+
+                generated_commands += '        *function = reinterpret_cast<PFN_xrVoidFunction>(%s<Slot>);\n' % layer_command_name
+                if cur_cmd.protect_value:
+                    generated_commands += '#endif // %s\n' % cur_cmd.protect_string
+
+        generated_commands += '    }\n'
+        generated_commands += '    return XR_SUCCESS;\n'
+        generated_commands += '}\n'
+        return generated_commands
@@ -23,6 +23,7 @@ from loader_source_generator import LoaderSourceGeneratorOptions, LoaderSourceOu
 from utility_source_generator import UtilitySourceGeneratorOptions, UtilitySourceOutputGenerator
 from api_dump_generator import ApiDumpGeneratorOptions, ApiDumpOutputGenerator
 from validation_layer_generator import ValidationSourceGeneratorOptions, ValidationSourceOutputGenerator
+from passthrough_layer_generator import PassthroughGeneratorOptions, PassthroughOutputGenerator
 
 # Simple timer functions
 startTime = None
@@ -212,7 +213,9 @@ def makeGenOpts(args):
             apicall           = 'XRAPI_ATTR ',
             apientry          = 'XRAPI_CALL ',
             apientryp         = 'XRAPI_PTR *',
-            alignFuncParam    = 48)
+            alignFuncParam    = 48,
+            loaderStatistics  = args.loaderStatistics,
+            coldDiagnostics   = args.coldDiagnostics)
         ]
 
     genOpts['xr_generated_loader.cpp'] = [
@@ -235,7 +238,9 @@ def makeGenOpts(args):
             apicall           = 'XRAPI_ATTR ',
             apientry          = 'XRAPI_CALL ',
             apientryp         = 'XRAPI_PTR *',
-            alignFuncParam    = 48)
+            alignFuncParam    = 48,
+            loaderStatistics  = args.loaderStatistics,
+            coldDiagnostics   = args.coldDiagnostics)
         ]
 
     # Source files generated for the api_dump layer
@@ -332,6 +337,53 @@ def makeGenOpts(args):
             alignFuncParam    = 48)
         ]
 
+    # Source files generated for the pass-through layer
+    genOpts['xr_generated_passthrough.hpp'] = [
+          PassthroughOutputGenerator,
+          PassthroughGeneratorOptions(
+            filename          = 'xr_generated_passthrough.hpp',
+            directory         = directory,
+            apiname           = 'openxr',
+            profile           = None,
+            versions          = featuresPat,
+            emitversions      = featuresPat,
+            defaultExtensions = 'openxr',
+            addExtensions     = None,
+            removeExtensions  = None,
+            emitExtensions    = emitExtensionsPat,
+            prefixText        = prefixStrings + xrPrefixStrings,
+            protectFeature    = False,
+            protectProto      = '#ifndef',
+            protectProtoStr   = 'XR_NO_PROTOTYPES',
+            apicall           = 'XRAPI_ATTR ',
+            apientry          = 'XRAPI_CALL ',
+            apientryp         = 'XRAPI_PTR *',
+            alignFuncParam    = 48)
+        ]
+
+    genOpts['xr_generated_passthrough.cpp'] = [
+          PassthroughOutputGenerator,
+          PassthroughGeneratorOptions(
+            filename          = 'xr_generated_passthrough.cpp',
+            directory         = directory,
+            apiname           = 'openxr',
+            profile           = None,
+            versions          = featuresPat,
+            emitversions      = featuresPat,
+            defaultExtensions = 'openxr',
+            addExtensions     = None,
+            removeExtensions  = None,
+            emitExtensions    = emitExtensionsPat,
+            prefixText        = prefixStrings + xrPrefixStrings,
+            protectFeature    = False,
+            protectProto      = '#ifndef',
+            protectProtoStr   = 'XR_NO_PROTOTYPES',
+            apicall           = 'XRAPI_ATTR ',
+            apientry          = 'XRAPI_CALL ',
+            apientryp         = 'XRAPI_PTR *',
+            alignFuncParam    = 48)
+        ]
+
 # Generate a target based on the options in the matching genOpts{} object.
 # This is encapsulated in a function so it can be profiled and/or timed.
 # The args parameter is an parsed argument object containing the following
@@ -422,6 +474,10 @@ if __name__ == '__main__':
                         help='Specify target')
     parser.add_argument('-quiet', action='store_true', default=False,
                         help='Suppress script output during normal execution.')
+    parser.add_argument('-loaderStatistics', action='store_true', default=False,
+                        help='Compile per-command statistics into the generated loader trampolines')
+    parser.add_argument('-coldDiagnostics', action='store_true', default=False,
+                        help='Move error logging out of the generated loader trampolines into shared cold helpers')
 
     args = parser.parse_args()
 
@@ -0,0 +1,173 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "bench_common.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <direct.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+void BenchSetEnv(const char* name, const char* value) {
+#if defined(_WIN32)
+    _putenv_s(name, value);
+#else
+    setenv(name, value, 1);
+#endif
+}
+
+void BenchSetEnvDefault(const char* name, const char* value) {
+    if (nullptr != std::getenv(name)) {
+        return;
+    }
+    BenchSetEnv(name, value);
+}
+
+bool BenchMakeTemporaryDirectory(const char* prefix, std::string& path) {
+#if defined(_WIN32)
+    const char* temp = std::getenv("TEMP");
+    path = std::string((nullptr != temp) ? temp : ".") + "\\" + prefix + "_" + std::to_string(_getpid());
+    return 0 == _mkdir(path.c_str());
+#else
+    const char* temp = std::getenv("TMPDIR");
+    std::string path_template = std::string((nullptr != temp && temp[0] != '\0') ? temp : "/tmp") + "/" + prefix + "_XXXXXX";
+    std::vector<char> buffer(path_template.begin(), path_template.end());
+    buffer.push_back('\0');
+    if (nullptr == mkdtemp(buffer.data())) {
+        return false;
+    }
+    path = buffer.data();
+    return true;
+#endif
+}
+
+void BenchRemoveDirectory(const std::string& path) {
+#if defined(_WIN32)
+    _rmdir(path.c_str());
+#else
+    rmdir(path.c_str());
+#endif
+}
+
+BenchObjectCommands BenchLoaderObjectCommands() {
+    return {xrCreateSession,    xrDestroySession, xrCreateReferenceSpace, xrDestroySpace,    xrCreateActionSet,
+            xrDestroyActionSet, xrCreateAction,   xrDestroyAction,        xrCreateSwapchain, xrDestroySwapchain};
+}
+
+BenchObjectCommands BenchGetObjectCommands(XrInstance instance, PFN_xrGetInstanceProcAddr get_instance_proc_addr) {
+    BenchObjectCommands commands = {};
+    get_instance_proc_addr(instance, "xrCreateSession", reinterpret_cast<PFN_xrVoidFunction*>(&commands.CreateSession));
+    get_instance_proc_addr(instance, "xrDestroySession", reinterpret_cast<PFN_xrVoidFunction*>(&commands.DestroySession));
+    get_instance_proc_addr(instance, "xrCreateReferenceSpace",
+                           reinterpret_cast<PFN_xrVoidFunction*>(&commands.CreateReferenceSpace));
+    get_instance_proc_addr(instance, "xrDestroySpace", reinterpret_cast<PFN_xrVoidFunction*>(&commands.DestroySpace));
+    get_instance_proc_addr(instance, "xrCreateActionSet", reinterpret_cast<PFN_xrVoidFunction*>(&commands.CreateActionSet));
+    get_instance_proc_addr(instance, "xrDestroyActionSet", reinterpret_cast<PFN_xrVoidFunction*>(&commands.DestroyActionSet));
+    get_instance_proc_addr(instance, "xrCreateAction", reinterpret_cast<PFN_xrVoidFunction*>(&commands.CreateAction));
+    get_instance_proc_addr(instance, "xrDestroyAction", reinterpret_cast<PFN_xrVoidFunction*>(&commands.DestroyAction));
+    get_instance_proc_addr(instance, "xrCreateSwapchain", reinterpret_cast<PFN_xrVoidFunction*>(&commands.CreateSwapchain));
+    get_instance_proc_addr(instance, "xrDestroySwapchain", reinterpret_cast<PFN_xrVoidFunction*>(&commands.DestroySwapchain));
+    return commands;
+}
+
+bool BenchCreateInstance(const char* application_name, const std::vector<const char*>& layer_names, XrInstance& instance) {
+    XrInstanceCreateInfo instance_info = {XR_TYPE_INSTANCE_CREATE_INFO};
+    strcpy(instance_info.applicationInfo.applicationName, application_name);
+    instance_info.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+    instance_info.enabledApiLayerCount = static_cast<uint32_t>(layer_names.size());
+    instance_info.enabledApiLayerNames = layer_names.empty() ? nullptr : layer_names.data();
+    return XR_SUCCEEDED(xrCreateInstance(&instance_info, &instance));
+}
+
+bool BenchCreateObjects(XrInstance instance, BenchObjects& objects, const BenchObjectCommands& commands) {
+    XrSessionCreateInfo session_info = {XR_TYPE_SESSION_CREATE_INFO};
+    session_info.systemId = 1;
+    XrReferenceSpaceCreateInfo space_info = {XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+    space_info.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+    space_info.poseInReferenceSpace.orientation.w = 1.0f;
+    XrActionSetCreateInfo action_set_info = {XR_TYPE_ACTION_SET_CREATE_INFO};
+    strcpy(action_set_info.actionSetName, "bench");
+    strcpy(action_set_info.localizedActionSetName, "Bench");
+    XrActionCreateInfo action_info = {XR_TYPE_ACTION_CREATE_INFO};
+    strcpy(action_info.actionName, "select");
+    strcpy(action_info.localizedActionName, "Select");
+    action_info.actionType = XR_INPUT_ACTION_TYPE_BOOLEAN;
+    XrSwapchainCreateInfo swapchain_info = {XR_TYPE_SWAPCHAIN_CREATE_INFO};
+    swapchain_info.width = 64;
+    swapchain_info.height = 64;
+    swapchain_info.faceCount = 1;
+    swapchain_info.arraySize = 1;
+    swapchain_info.mipCount = 1;
+    swapchain_info.sampleCount = 1;
+    if (nullptr == commands.CreateSession || nullptr == commands.CreateReferenceSpace || nullptr == commands.CreateActionSet ||
+        nullptr == commands.CreateAction || nullptr == commands.CreateSwapchain) {
+        return false;
+    }
+    return XR_SUCCEEDED(commands.CreateSession(instance, &session_info, &objects.session)) &&
+           XR_SUCCEEDED(commands.CreateReferenceSpace(objects.session, &space_info, &objects.space)) &&
+           XR_SUCCEEDED(commands.CreateActionSet(objects.session, &action_set_info, &objects.action_set)) &&
+           XR_SUCCEEDED(commands.CreateAction(objects.action_set, &action_info, &objects.action)) &&
+           XR_SUCCEEDED(commands.CreateSwapchain(objects.session, &swapchain_info, &objects.swapchain));
+}
+
+void BenchDestroyObjects(BenchObjects& objects, const BenchObjectCommands& commands) {
+    if (XR_NULL_HANDLE != objects.swapchain) {
+        commands.DestroySwapchain(objects.swapchain);
+    }
+    if (XR_NULL_HANDLE != objects.action) {
+        commands.DestroyAction(objects.action);
+    }
+    if (XR_NULL_HANDLE != objects.action_set) {
+        commands.DestroyActionSet(objects.action_set);
+    }
+    if (XR_NULL_HANDLE != objects.space) {
+        commands.DestroySpace(objects.space);
+    }
+    if (XR_NULL_HANDLE != objects.session) {
+        commands.DestroySession(objects.session);
+    }
+    objects = BenchObjects();
+}
+
+BenchJsonReport::BenchJsonReport(const char* benchmark, const char* records_name) : _records_name(records_name) {
+    _fields.Add("benchmark", benchmark);
+}
+
+BenchJsonObject& BenchJsonReport::AddRecord() {
+    _records.emplace_back();
+    return _records.back();
+}
+
+void BenchJsonReport::Write(std::ostream& out) const {
+    out << "{\n";
+    for (const auto& field : _fields.Fields()) {
+        out << "    \"" << field.first << "\": " << field.second << ",\n";
+    }
+    out << "    \"" << _records_name << "\": [\n";
+    for (size_t index = 0; index < _records.size(); ++index) {
+        const auto& fields = _records[index].Fields();
+        out << "        {";
+        for (size_t field = 0; field < fields.size(); ++field) {
+            out << (0 == field ? "\"" : ", \"") << fields[field].first << "\": " << fields[field].second;
+        }
+        out << ((index + 1 < _records.size()) ? "},\n" : "}\n");
+    }
+    out << "    ]\n}" << std::endl;
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Helpers shared by the loader benchmarks: environment defaults, temporary directories, the objects
+// the timed commands are called on, timing loops, percentiles and the JSON report each benchmark
+// writes to stdout.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+
+// Set an environment variable, or only when it isn't set yet so the caller's choice wins.
+void BenchSetEnv(const char* name, const char* value);
+void BenchSetEnvDefault(const char* name, const char* value);
+
+// Create a new, empty directory in the system's temporary directory, named after prefix.
+bool BenchMakeTemporaryDirectory(const char* prefix, std::string& path);
+// Remove a directory, which must be empty by then.
+void BenchRemoveDirectory(const std::string& path);
+
+// Objects the benchmarks call commands on, all created on one session of the test runtime.
+struct BenchObjects {
+    XrSession session = XR_NULL_HANDLE;
+    XrSpace space = XR_NULL_HANDLE;
+    XrActionSet action_set = XR_NULL_HANDLE;
+    XrAction action = XR_NULL_HANDLE;
+    XrSwapchain swapchain = XR_NULL_HANDLE;
+};
+
+// Commands BenchObjects are created and destroyed with: the loader's exported ones, or those some
+// xrGetInstanceProcAddr returns, such as a runtime's own.
+struct BenchObjectCommands {
+    PFN_xrCreateSession CreateSession;
+    PFN_xrDestroySession DestroySession;
+    PFN_xrCreateReferenceSpace CreateReferenceSpace;
+    PFN_xrDestroySpace DestroySpace;
+    PFN_xrCreateActionSet CreateActionSet;
+    PFN_xrDestroyActionSet DestroyActionSet;
+    PFN_xrCreateAction CreateAction;
+    PFN_xrDestroyAction DestroyAction;
+    PFN_xrCreateSwapchain CreateSwapchain;
+    PFN_xrDestroySwapchain DestroySwapchain;
+};
+
+BenchObjectCommands BenchLoaderObjectCommands();
+BenchObjectCommands BenchGetObjectCommands(XrInstance instance, PFN_xrGetInstanceProcAddr get_instance_proc_addr);
+
+bool BenchCreateInstance(const char* application_name, const std::vector<const char*>& layer_names, XrInstance& instance);
+// On failure, whatever was created is left in objects for BenchDestroyObjects to clean up.
+bool BenchCreateObjects(XrInstance instance, BenchObjects& objects,
+                        const BenchObjectCommands& commands = BenchLoaderObjectCommands());
+void BenchDestroyObjects(BenchObjects& objects, const BenchObjectCommands& commands = BenchLoaderObjectCommands());
+
+// Time one call repeated iterations times, in nanoseconds per call.  The best of several repetitions
+// is kept, to keep scheduling noise out of the numbers.
+template <typename Call>
+double BenchTimeCalls(uint64_t iterations, uint32_t repetitions, Call call) {
+    double best_ns = 0.0;
+    for (uint32_t rep = 0; rep < repetitions; ++rep) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t iter = 0; iter < iterations; ++iter) {
+            call();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations);
+        if (0 == rep || ns < best_ns) {
+            best_ns = ns;
+        }
+    }
+    return best_ns;
+}
+
+template <typename T>
+T BenchPercentile(std::vector<T> samples, double fraction) {
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+// Named values of one JSON object, in the order they were added.  Strings are quoted, anything else
+// is written as it is streamed.
+class BenchJsonObject {
+   public:
+    BenchJsonObject& Add(const char* name, const char* value) { return AddRaw(name, "\"" + std::string(value) + "\""); }
+    BenchJsonObject& Add(const char* name, const std::string& value) { return Add(name, value.c_str()); }
+    template <typename T>
+    BenchJsonObject& Add(const char* name, T value) {
+        std::ostringstream text;
+        text << value;
+        return AddRaw(name, text.str());
+    }
+
+    const std::vector<std::pair<std::string, std::string>>& Fields() const { return _fields; }
+
+   private:
+    BenchJsonObject& AddRaw(const char* name, const std::string& value) {
+        _fields.emplace_back(name, value);
+        return *this;
+    }
+
+    std::vector<std::pair<std::string, std::string>> _fields;
+};
+
+// The report a benchmark writes: its name and top level fields, one per line, followed by an array
+// of records, one per line.
+class BenchJsonReport {
+   public:
+    BenchJsonReport(const char* benchmark, const char* records_name);
+
+    BenchJsonObject& Fields() { return _fields; }
+    BenchJsonObject& AddRecord();
+    void Write(std::ostream& out) const;
+
+   private:
+    std::string _records_name;
+    BenchJsonObject _fields;
+    std::vector<BenchJsonObject> _records;
+};
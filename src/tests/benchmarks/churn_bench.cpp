@@ -0,0 +1,200 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Instance create/destroy churn benchmark.
+//
+// Repeatedly creates an instance with two copies of the pass-through API layer enabled, creates a
+// session, a space, an action set, an action and a swapchain on it, and destroys the instance
+// without destroying them first, so every iteration goes through manifest reads, layer and runtime
+// library loading and unloading, dispatch table creation and the loader's handle map cleanup.
+// Reports per-iteration latency, plus resident memory and open file (handle, on Windows) counts
+// sampled as it goes, as JSON on stdout.
+//
+//   churn_bench [iterations] [soak seconds]
+//
+// With a non-zero soak time the loop runs for that long instead of a fixed number of iterations.
+// XR_RUNTIME_JSON and XR_API_LAYER_PATH default to the test runtime and the pass-through layer stack
+// of this build, but are left alone when already set.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+
+#include "bench_common.hpp"
+
+#if defined(_WIN32)
+#include <psapi.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+static const std::vector<const char*> g_bench_layer_names = {"XR_APILAYER_LUNARG_passthrough_1",
+                                                             "XR_APILAYER_LUNARG_passthrough_2"};
+
+// Number of samples of memory and file counts taken over the run
+static const uint32_t g_sample_count = 20;
+
+struct ChurnSample {
+    uint64_t iteration;
+    uint64_t resident_bytes;
+    uint64_t open_files;
+};
+
+static uint64_t ResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#else
+    // Second field of statm is the resident set, in pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size_pages = 0;
+    uint64_t resident_pages = 0;
+    if (!(statm >> size_pages >> resident_pages)) {
+        return 0;
+    }
+    return resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+static uint64_t OpenFiles() {
+#if defined(_WIN32)
+    DWORD handle_count = 0;
+    GetProcessHandleCount(GetCurrentProcess(), &handle_count);
+    return handle_count;
+#else
+    DIR* dir = opendir("/proc/self/fd");
+    if (nullptr == dir) {
+        return 0;
+    }
+    uint64_t count = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        if ('.' != entry->d_name[0]) {
+            count++;
+        }
+    }
+    closedir(dir);
+    // Don't count the descriptor opendir itself used
+    return count - 1;
+#endif
+}
+
+static bool ChurnOnce() {
+    XrInstance instance = XR_NULL_HANDLE;
+    if (!BenchCreateInstance("churn_bench", g_bench_layer_names, instance)) {
+        return false;
+    }
+    BenchObjects objects;
+    bool succeeded = BenchCreateObjects(instance, objects);
+    // Leave the objects for the loader to clean up along with the instance
+    return XR_SUCCEEDED(xrDestroyInstance(instance)) && succeeded;
+}
+
+static double Mean(std::vector<double>::const_iterator begin, std::vector<double>::const_iterator end) {
+    double total = 0.0;
+    for (auto iter = begin; iter != end; ++iter) {
+        total += *iter;
+    }
+    return (begin == end) ? 0.0 : total / static_cast<double>(end - begin);
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t iterations = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 5000;
+    uint64_t soak_seconds = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 0;
+    if (0 == iterations && 0 == soak_seconds) {
+        std::cerr << "Usage: churn_bench [iterations] [soak seconds]" << std::endl;
+        return 1;
+    }
+    BenchSetEnvDefault("XR_RUNTIME_JSON", CHURN_BENCH_RUNTIME_JSON);
+    BenchSetEnvDefault("XR_API_LAYER_PATH", CHURN_BENCH_LAYER_PATH);
+
+    // One untimed round so the first sample isn't dominated by one-off loader initialization
+    if (!ChurnOnce()) {
+        std::cerr << "Unable to create an instance with the pass-through layers" << std::endl;
+        return 1;
+    }
+
+    std::vector<double> latencies_us;
+    std::vector<ChurnSample> samples;
+    samples.push_back({0, ResidentBytes(), OpenFiles()});
+    auto soak_end = std::chrono::steady_clock::now() + std::chrono::seconds(soak_seconds);
+    uint64_t sample_interval = std::max<uint64_t>(1, iterations / g_sample_count);
+    auto last_sample_time = std::chrono::steady_clock::now();
+    for (uint64_t iter = 0;; ++iter) {
+        auto now = std::chrono::steady_clock::now();
+        if (0 != soak_seconds ? (now >= soak_end) : (iter >= iterations)) {
+            break;
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (!ChurnOnce()) {
+            std::cerr << "Iteration " << iter << " failed" << std::endl;
+            return 1;
+        }
+        auto end = std::chrono::steady_clock::now();
+        latencies_us.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+
+        // Sample on iteration count for fixed runs, and on elapsed time for soaks
+        bool sample_due = (0 != soak_seconds) ? (end - last_sample_time >= std::chrono::seconds(soak_seconds) / g_sample_count)
+                                               : ((iter + 1) % sample_interval == 0);
+        if (sample_due) {
+            samples.push_back({iter + 1, ResidentBytes(), OpenFiles()});
+            last_sample_time = end;
+        }
+    }
+    if (latencies_us.empty()) {
+        std::cerr << "No iterations ran" << std::endl;
+        return 1;
+    }
+    if (samples.back().iteration != latencies_us.size()) {
+        samples.push_back({latencies_us.size(), ResidentBytes(), OpenFiles()});
+    }
+
+    // Drift compares the first and last tenth of the run
+    size_t tenth = std::max<size_t>(1, latencies_us.size() / 10);
+    double first_tenth_us = Mean(latencies_us.begin(), latencies_us.begin() + tenth);
+    double last_tenth_us = Mean(latencies_us.end() - tenth, latencies_us.end());
+    int64_t resident_growth = static_cast<int64_t>(samples.back().resident_bytes) - static_cast<int64_t>(samples.front().resident_bytes);
+    int64_t open_file_growth = static_cast<int64_t>(samples.back().open_files) - static_cast<int64_t>(samples.front().open_files);
+
+    BenchJsonReport report("churn_bench", "samples");
+    report.Fields()
+        .Add("iterations", latencies_us.size())
+        .Add("api_layers", g_bench_layer_names.size())
+        .Add("mean_us", Mean(latencies_us.begin(), latencies_us.end()))
+        .Add("p50_us", BenchPercentile(latencies_us, 0.50))
+        .Add("p99_us", BenchPercentile(latencies_us, 0.99))
+        .Add("max_us", *std::max_element(latencies_us.begin(), latencies_us.end()))
+        .Add("first_tenth_mean_us", first_tenth_us)
+        .Add("last_tenth_mean_us", last_tenth_us)
+        .Add("resident_growth_bytes", resident_growth)
+        .Add("open_file_growth", open_file_growth);
+    for (const ChurnSample& sample : samples) {
+        report.AddRecord()
+            .Add("iteration", sample.iteration)
+            .Add("resident_bytes", sample.resident_bytes)
+            .Add("open_files", sample.open_files);
+    }
+    report.Write(std::cout);
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Layer chain depth benchmark.
+//
+// Stacks 0 to 16 copies of the pass-through API layer between the application and the test
+// runtime, and for every depth times xrLocateSpace and xrGetActionStateBoolean through the loader's
+// trampolines and through the pointers returned by xrGetInstanceProcAddr, along with how long
+// xrCreateInstance took.  Both commands do nothing in the test runtime, so the slope over depth is
+// the cost of one layer hop.  The whole run is then repeated with a stack of manifests in which
+// every layer declares that it only intercepts xrEndFrame and the session commands it needs for that,
+// which should take the layers out of the path of both commands.  Results are written to stdout as JSON.
+//
+//   layer_chain_bench [max_depth] [iterations]
+//
+// XR_RUNTIME_JSON defaults to the test runtime of this build, but is left alone when already set.
+// XR_API_LAYER_PATH is always pointed at the pass-through layer stacks of this build.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+#include <openxr/openxr_loader.h>
+
+#include "bench_common.hpp"
+
+// Number of pass-through layer manifests in each stack directory
+static const uint32_t g_max_depth = 16;
+
+struct ChainStack {
+    const char* intercepts;
+    const char* layer_path;
+};
+
+struct ChainResult {
+    const char* intercepts;
+    uint32_t depth;
+    double create_instance_us;
+    double trampoline_locate_space_ns;
+    double trampoline_action_state_ns;
+    double proc_addr_locate_space_ns;
+    double proc_addr_action_state_ns;
+};
+
+int main(int argc, char* argv[]) {
+    uint32_t max_depth = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : g_max_depth;
+    uint64_t iterations = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 200000;
+    if (max_depth > g_max_depth || 0 == iterations) {
+        std::cerr << "Usage: layer_chain_bench [max_depth (0-" << g_max_depth << ")] [iterations]" << std::endl;
+        return 1;
+    }
+    BenchSetEnvDefault("XR_RUNTIME_JSON", LAYER_CHAIN_BENCH_RUNTIME_JSON);
+    const ChainStack stacks[] = {{"all", LAYER_CHAIN_BENCH_LAYER_PATH}, {"xrEndFrame", LAYER_CHAIN_BENCH_END_FRAME_LAYER_PATH}};
+
+    std::vector<std::string> all_layer_names;
+    for (uint32_t layer = 1; layer <= g_max_depth; ++layer) {
+        all_layer_names.push_back("XR_APILAYER_LUNARG_passthrough_" + std::to_string(layer));
+    }
+
+    std::vector<ChainResult> results;
+    for (const ChainStack& stack : stacks) {
+        BenchSetEnv("XR_API_LAYER_PATH", stack.layer_path);
+        xrLoaderRefreshEnvironment();
+        for (uint32_t depth = 0; depth <= max_depth; ++depth) {
+            std::vector<const char*> layer_names;
+            for (uint32_t layer = 0; layer < depth; ++layer) {
+                layer_names.push_back(all_layer_names[layer].c_str());
+            }
+
+            ChainResult result = {};
+            result.intercepts = stack.intercepts;
+            result.depth = depth;
+            XrInstance instance = XR_NULL_HANDLE;
+            BenchObjects objects;
+            auto start = std::chrono::steady_clock::now();
+            bool created = BenchCreateInstance("layer_chain_bench", layer_names, instance);
+            auto end = std::chrono::steady_clock::now();
+            result.create_instance_us = std::chrono::duration<double, std::micro>(end - start).count();
+            if (!created || !BenchCreateObjects(instance, objects)) {
+                std::cerr << "Unable to set up an instance with " << depth << " pass-through layers intercepting " << stack.intercepts
+                          << std::endl;
+                BenchDestroyObjects(objects);
+                xrDestroyInstance(instance);
+                return 1;
+            }
+
+            XrSpaceRelation relation = {XR_TYPE_SPACE_RELATION};
+            XrActionStateBoolean action_state = {XR_TYPE_ACTION_STATE_BOOLEAN};
+            result.trampoline_locate_space_ns =
+                BenchTimeCalls(iterations, 5, [&]() { xrLocateSpace(objects.space, objects.space, 1, &relation); });
+            result.trampoline_action_state_ns =
+                BenchTimeCalls(iterations, 5, [&]() { xrGetActionStateBoolean(objects.action, 0, nullptr, &action_state); });
+
+            PFN_xrLocateSpace locate_space = nullptr;
+            PFN_xrGetActionStateBoolean get_action_state_boolean = nullptr;
+            xrGetInstanceProcAddr(instance, "xrLocateSpace", reinterpret_cast<PFN_xrVoidFunction*>(&locate_space));
+            xrGetInstanceProcAddr(instance, "xrGetActionStateBoolean",
+                                  reinterpret_cast<PFN_xrVoidFunction*>(&get_action_state_boolean));
+            if (nullptr == locate_space || nullptr == get_action_state_boolean) {
+                std::cerr << "Unable to get commands with " << depth << " pass-through layers" << std::endl;
+                BenchDestroyObjects(objects);
+                xrDestroyInstance(instance);
+                return 1;
+            }
+            result.proc_addr_locate_space_ns =
+                BenchTimeCalls(iterations, 5, [&]() { locate_space(objects.space, objects.space, 1, &relation); });
+            result.proc_addr_action_state_ns =
+                BenchTimeCalls(iterations, 5, [&]() { get_action_state_boolean(objects.action, 0, nullptr, &action_state); });
+
+            BenchDestroyObjects(objects);
+            xrDestroyInstance(instance);
+            results.push_back(result);
+        }
+    }
+
+    BenchJsonReport report("layer_chain_bench", "results");
+    report.Fields().Add("iterations", iterations);
+    for (const ChainResult& result : results) {
+        report.AddRecord()
+            .Add("intercepts", result.intercepts)
+            .Add("depth", result.depth)
+            .Add("create_instance_us", result.create_instance_us)
+            .Add("trampoline_locate_space_ns", result.trampoline_locate_space_ns)
+            .Add("trampoline_action_state_ns", result.trampoline_action_state_ns)
+            .Add("proc_addr_locate_space_ns", result.proc_addr_locate_space_ns)
+            .Add("proc_addr_action_state_ns", result.proc_addr_action_state_ns);
+    }
+    report.Write(std::cout);
+    return 0;
+}
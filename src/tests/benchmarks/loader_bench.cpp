@@ -0,0 +1,193 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Trampoline overhead benchmark.
+//
+// Times a few representative commands against the test runtime, whose implementations of them do
+// nothing, three ways: through the loader's exported trampolines, through the pointers returned by
+// xrGetInstanceProcAddr, and by calling the runtime directly.  The first two are repeated with zero,
+// one and two copies of the pass-through API layer enabled.  For the direct calls the instance and
+// objects are created on a copy of the test runtime linked into this benchmark, negotiated with
+// directly, so that it is only handed handles it created itself.  Results are written to stdout as JSON.
+//
+//   loader_bench [iterations] [repetitions]
+//
+// XR_RUNTIME_JSON and XR_API_LAYER_PATH default to the test runtime and the pass-through layer stack
+// of this build, but are left alone when already set.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+
+#include "bench_common.hpp"
+#include "loader_interfaces.h"
+
+// The test runtime, linked in statically so it can be called without going through the loader
+extern "C" XrResult xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderInfo,
+                                                      XrNegotiateRuntimeRequest* runtimeRequest);
+
+static const char* const g_bench_layer_names[] = {"XR_APILAYER_LUNARG_passthrough_1", "XR_APILAYER_LUNARG_passthrough_2"};
+
+struct BenchCommands {
+    PFN_xrLocateSpace LocateSpace;
+    PFN_xrGetActionStateBoolean GetActionStateBoolean;
+    PFN_xrAcquireSwapchainImage AcquireSwapchainImage;
+    PFN_xrEndFrame EndFrame;
+    PFN_xrStringToPath StringToPath;
+};
+
+static void GetCommands(XrInstance instance, PFN_xrGetInstanceProcAddr get_instance_proc_addr, BenchCommands& commands) {
+    get_instance_proc_addr(instance, "xrLocateSpace", reinterpret_cast<PFN_xrVoidFunction*>(&commands.LocateSpace));
+    get_instance_proc_addr(instance, "xrGetActionStateBoolean",
+                           reinterpret_cast<PFN_xrVoidFunction*>(&commands.GetActionStateBoolean));
+    get_instance_proc_addr(instance, "xrAcquireSwapchainImage",
+                           reinterpret_cast<PFN_xrVoidFunction*>(&commands.AcquireSwapchainImage));
+    get_instance_proc_addr(instance, "xrEndFrame", reinterpret_cast<PFN_xrVoidFunction*>(&commands.EndFrame));
+    get_instance_proc_addr(instance, "xrStringToPath", reinterpret_cast<PFN_xrVoidFunction*>(&commands.StringToPath));
+}
+
+// Negotiate with the statically linked test runtime and get its xrGetInstanceProcAddr
+static PFN_xrGetInstanceProcAddr NegotiateRuntime() {
+    XrNegotiateLoaderInfo loader_info = {};
+    loader_info.structType = XR_LOADER_INTERFACE_STRUCT_LOADER_INFO;
+    loader_info.structVersion = XR_LOADER_INFO_STRUCT_VERSION;
+    loader_info.structSize = sizeof(XrNegotiateLoaderInfo);
+    loader_info.minInterfaceVersion = 1;
+    loader_info.maxInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+    loader_info.minXrVersion = XR_MAKE_VERSION(0, 1, 0);
+    loader_info.maxXrVersion = XR_MAKE_VERSION(1, 0, 0);
+    XrNegotiateRuntimeRequest runtime_info = {};
+    runtime_info.structType = XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST;
+    runtime_info.structVersion = XR_RUNTIME_INFO_STRUCT_VERSION;
+    runtime_info.structSize = sizeof(XrNegotiateRuntimeRequest);
+    if (XR_FAILED(xrNegotiateLoaderRuntimeInterface(&loader_info, &runtime_info))) {
+        return nullptr;
+    }
+    return runtime_info.getInstanceProcAddr;
+}
+
+static void TimeCommands(const BenchCommands& commands, XrInstance instance, const BenchObjects& objects, const char* path,
+                         uint32_t layer_count, uint64_t iterations, uint32_t repetitions, BenchJsonReport& report) {
+    XrSpaceRelation relation = {XR_TYPE_SPACE_RELATION};
+    XrActionStateBoolean action_state = {XR_TYPE_ACTION_STATE_BOOLEAN};
+    uint32_t image_index = 0;
+    XrFrameEndInfo frame_end_info = {XR_TYPE_FRAME_END_INFO};
+    frame_end_info.displayTime = 1;
+    frame_end_info.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+    XrPath path_handle = XR_NULL_PATH;
+
+    auto add_result = [&](const char* command, double ns_per_call) {
+        report.AddRecord().Add("command", command).Add("path", path).Add("layers", layer_count).Add("ns_per_call", ns_per_call);
+    };
+    add_result("xrLocateSpace", BenchTimeCalls(iterations, repetitions, [&]() {
+                   commands.LocateSpace(objects.space, objects.space, 1, &relation);
+               }));
+    add_result("xrGetActionStateBoolean", BenchTimeCalls(iterations, repetitions, [&]() {
+                   commands.GetActionStateBoolean(objects.action, 0, nullptr, &action_state);
+               }));
+    add_result("xrAcquireSwapchainImage", BenchTimeCalls(iterations, repetitions, [&]() {
+                   commands.AcquireSwapchainImage(objects.swapchain, nullptr, &image_index);
+               }));
+    add_result("xrEndFrame", BenchTimeCalls(iterations, repetitions, [&]() {
+                   commands.EndFrame(objects.session, &frame_end_info);
+               }));
+    add_result("xrStringToPath", BenchTimeCalls(iterations, repetitions, [&]() {
+                   commands.StringToPath(instance, "/user/hand/left", &path_handle);
+               }));
+}
+
+// Time the commands called directly on the statically linked test runtime, on an instance and objects
+// created through it rather than through the loader.
+static bool TimeRuntimeCommands(uint64_t iterations, uint32_t repetitions, BenchJsonReport& report) {
+    PFN_xrGetInstanceProcAddr get_instance_proc_addr = NegotiateRuntime();
+    if (nullptr == get_instance_proc_addr) {
+        return false;
+    }
+    PFN_xrCreateInstance create_instance = nullptr;
+    PFN_xrDestroyInstance destroy_instance = nullptr;
+    get_instance_proc_addr(XR_NULL_HANDLE, "xrCreateInstance", reinterpret_cast<PFN_xrVoidFunction*>(&create_instance));
+    get_instance_proc_addr(XR_NULL_HANDLE, "xrDestroyInstance", reinterpret_cast<PFN_xrVoidFunction*>(&destroy_instance));
+    if (nullptr == create_instance || nullptr == destroy_instance) {
+        return false;
+    }
+
+    XrInstanceCreateInfo instance_info = {XR_TYPE_INSTANCE_CREATE_INFO};
+    strcpy(instance_info.applicationInfo.applicationName, "loader_bench");
+    instance_info.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+    XrInstance instance = XR_NULL_HANDLE;
+    if (XR_FAILED(create_instance(&instance_info, &instance))) {
+        return false;
+    }
+    BenchObjectCommands object_commands = BenchGetObjectCommands(instance, get_instance_proc_addr);
+    BenchObjects objects;
+    bool succeeded = BenchCreateObjects(instance, objects, object_commands);
+    if (succeeded) {
+        BenchCommands runtime_commands = {};
+        GetCommands(instance, get_instance_proc_addr, runtime_commands);
+        // Calling the runtime directly skips any layers, so once is enough
+        TimeCommands(runtime_commands, instance, objects, "direct", 0, iterations, repetitions, report);
+    }
+    BenchDestroyObjects(objects, object_commands);
+    destroy_instance(instance);
+    return succeeded;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t iterations = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    uint32_t repetitions = (argc > 2) ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 5;
+    if (0 == iterations || 0 == repetitions) {
+        std::cerr << "Usage: loader_bench [iterations] [repetitions]" << std::endl;
+        return 1;
+    }
+    BenchSetEnvDefault("XR_RUNTIME_JSON", LOADER_BENCH_RUNTIME_JSON);
+    BenchSetEnvDefault("XR_API_LAYER_PATH", LOADER_BENCH_LAYER_PATH);
+
+    BenchJsonReport report("loader_bench", "results");
+    report.Fields().Add("iterations", iterations).Add("repetitions", repetitions);
+
+    // The exported trampolines are the same whatever the instance
+    BenchCommands trampolines = {xrLocateSpace, xrGetActionStateBoolean, xrAcquireSwapchainImage, xrEndFrame, xrStringToPath};
+
+    for (uint32_t layer_count = 0; layer_count <= 2; ++layer_count) {
+        XrInstance instance = XR_NULL_HANDLE;
+        BenchObjects objects;
+        std::vector<const char*> layer_names(g_bench_layer_names, g_bench_layer_names + layer_count);
+        if (!BenchCreateInstance("loader_bench", layer_names, instance) || !BenchCreateObjects(instance, objects)) {
+            std::cerr << "Unable to set up an instance with " << layer_count << " API layers" << std::endl;
+            BenchDestroyObjects(objects);
+            xrDestroyInstance(instance);
+            return 1;
+        }
+        TimeCommands(trampolines, instance, objects, "trampoline", layer_count, iterations, repetitions, report);
+
+        BenchCommands instance_commands = {};
+        GetCommands(instance, xrGetInstanceProcAddr, instance_commands);
+        TimeCommands(instance_commands, instance, objects, "get_instance_proc_addr", layer_count, iterations, repetitions, report);
+        BenchDestroyObjects(objects);
+        xrDestroyInstance(instance);
+    }
+
+    if (!TimeRuntimeCommands(iterations, repetitions, report)) {
+        std::cerr << "Unable to set up objects directly on the test runtime" << std::endl;
+        return 1;
+    }
+
+    report.Write(std::cout);
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Manifest parsing benchmark.
+//
+// Generates a directory of API layer manifests and times parsing every one of them, first
+// through a std::ifstream (the loader's original path) and then through FileSysUtilsMappedFile.
+// Results are written to stdout as JSON.
+//
+//   manifest_bench [directory] [manifest count] [iterations]
+//
+// Without a directory the manifests are written to a new temporary directory, which is removed afterwards.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "filesystem_utils.hpp"
+
+#include <json/json.h>
+
+#include "bench_common.hpp"
+
+static bool MakeDirectory(const std::string& path) {
+#if defined(_WIN32)
+    return 0 == _mkdir(path.c_str()) || FileSysUtilsIsDirectory(path);
+#else
+    return 0 == mkdir(path.c_str(), 0755) || FileSysUtilsIsDirectory(path);
+#endif
+}
+
+// Write a layer manifest.  Every tenth manifest carries a long extension list so both the
+// read and the map paths of FileSysUtilsMappedFile get exercised.
+static bool WriteManifest(const std::string& filename, uint32_t index) {
+    std::ofstream out(filename, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    uint32_t extension_count = (index % 10 == 0) ? 400 : 4;
+    out << "{\n    \"file_format_version\": \"1.0.0\",\n    \"api_layer\": {\n";
+    out << "        \"name\": \"XR_APILAYER_BENCH_layer_" << index << "\",\n";
+    out << "        \"library_path\": \"./libXrApiLayer_bench_" << index << ".so\",\n";
+    out << "        \"api_version\": \"0.90\",\n        \"implementation_version\": \"1\",\n";
+    out << "        \"description\": \"Synthetic layer manifest for benchmarking\",\n";
+    out << "        \"instance_extensions\": [\n";
+    for (uint32_t ext = 0; ext < extension_count; ++ext) {
+        out << "            { \"name\": \"XR_EXT_bench_extension_" << ext << "\", \"spec_version\": " << ext + 1 << " }";
+        out << ((ext + 1 < extension_count) ? ",\n" : "\n");
+    }
+    out << "        ]\n    }\n}\n";
+    return out.good();
+}
+
+static bool ParseWithStream(const std::string& filename) {
+    std::ifstream json_stream = std::ifstream(filename, std::ifstream::in);
+    if (!json_stream.is_open()) {
+        return false;
+    }
+    Json::Reader reader;
+    Json::Value root_node = Json::nullValue;
+    return reader.parse(json_stream, root_node, false) && !root_node.isNull();
+}
+
+static bool ParseWithMapping(const std::string& filename) {
+    FileSysUtilsMappedFile json_file;
+    if (!json_file.Open(filename)) {
+        return false;
+    }
+    Json::Reader reader;
+    Json::Value root_node = Json::nullValue;
+    return reader.parse(json_file.Data(), json_file.Data() + json_file.Size(), root_node, false) && !root_node.isNull();
+}
+
+template <typename Parser>
+static double TimeParse(const std::vector<std::string>& files, uint32_t iterations, Parser parser, uint32_t& failures) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t iter = 0; iter < iterations; ++iter) {
+        for (const auto& file : files) {
+            if (!parser(file)) {
+                failures++;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::string directory = (argc > 1) ? argv[1] : "";
+    uint32_t manifest_count = (argc > 2) ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1000;
+    uint32_t iterations = (argc > 3) ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 10;
+    if (0 == manifest_count || 0 == iterations) {
+        std::cerr << "Usage: manifest_bench [directory] [manifest count] [iterations]" << std::endl;
+        return 1;
+    }
+
+    bool temporary = directory.empty();
+    if (temporary && !BenchMakeTemporaryDirectory("manifest_bench", directory)) {
+        std::cerr << "Unable to create a temporary directory" << std::endl;
+        return 1;
+    }
+    if (!MakeDirectory(directory)) {
+        std::cerr << "Unable to create directory " << directory << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> files;
+    bool written = true;
+    for (uint32_t index = 0; index < manifest_count && written; ++index) {
+        std::string filename;
+        FileSysUtilsCombinePaths(directory, "bench_layer_" + std::to_string(index) + ".json", filename);
+        files.push_back(filename);
+        written = WriteManifest(filename, index);
+        if (!written) {
+            std::cerr << "Unable to write manifest " << filename << std::endl;
+        }
+    }
+
+    uint32_t stream_failures = 0;
+    uint32_t mapped_failures = 0;
+    if (written) {
+        // Warm the page cache so both runs see the same conditions.
+        uint32_t failures = 0;
+        TimeParse(files, 1, ParseWithStream, failures);
+
+        double stream_ms = TimeParse(files, iterations, ParseWithStream, stream_failures);
+        double mapped_ms = TimeParse(files, iterations, ParseWithMapping, mapped_failures);
+        double parses = static_cast<double>(manifest_count) * iterations;
+
+        BenchJsonReport report("manifest_bench", "results");
+        report.Fields().Add("manifests", manifest_count).Add("iterations", iterations);
+        report.AddRecord()
+            .Add("reader", "std::ifstream")
+            .Add("total_ms", stream_ms)
+            .Add("us_per_manifest", stream_ms * 1000.0 / parses)
+            .Add("failures", stream_failures);
+        report.AddRecord()
+            .Add("reader", "FileSysUtilsMappedFile")
+            .Add("total_ms", mapped_ms)
+            .Add("us_per_manifest", mapped_ms * 1000.0 / parses)
+            .Add("failures", mapped_failures);
+        report.Write(std::cout);
+    }
+
+    if (temporary) {
+        for (const auto& filename : files) {
+            std::remove(filename.c_str());
+        }
+        BenchRemoveDirectory(directory);
+    }
+    return (written && stream_failures == 0 && mapped_failures == 0) ? 0 : 1;
+}
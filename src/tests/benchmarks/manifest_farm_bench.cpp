@@ -0,0 +1,355 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Synthetic manifest farm startup benchmark.
+//
+// Generates a farm of runtime manifests plus implicit and explicit API layer manifests, points the
+// loader at it through XR_RUNTIME_JSON, XR_API_LAYER_PATH and the XDG directories, then times
+// xrEnumerateApiLayerProperties, xrEnumerateInstanceExtensionProperties and xrCreateInstance.
+//
+//   manifest_farm_bench [directory] [runtime count] [layer count] [iterations]
+//
+// Before each "cold" call every manifest in the farm is rewritten, one byte longer or shorter than
+// before, and XR_RUNTIME_JSON is switched to the next runtime manifest.  Changing the files is what
+// makes the loader read and parse them all again: its API layer properties are only reused while no
+// manifest directory has changed, and runtime manifests only while their size and modification time
+// match.  An environment change alone invalidates neither.  "warm" calls repeat with the farm left
+// alone.  The operating system's file cache is warm either way.  Results are written to stdout as JSON.
+//
+// Without a directory the farm is built in a new temporary directory, which is removed afterwards.
+//
+// Every runtime manifest points at the test runtime and every layer manifest at the pass-through layer,
+// so they all parse and validate completely.  Implicit layers carry an enable_environment that is
+// never set, and no explicit layer is enabled, so none of them end up loaded.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "filesystem_utils.hpp"
+#include "loader_test_utils.hpp"
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+
+#include "bench_common.hpp"
+
+static bool MakeDirectories(const std::string& path) {
+    std::string parent;
+    if (FileSysUtilsIsDirectory(path)) {
+        return true;
+    }
+    if (FileSysUtilsGetParentPath(path, parent) && parent != path && !parent.empty() && !MakeDirectories(parent)) {
+        return false;
+    }
+#if defined(_WIN32)
+    return 0 == _mkdir(path.c_str()) || FileSysUtilsIsDirectory(path);
+#else
+    return 0 == mkdir(path.c_str(), 0755) || FileSysUtilsIsDirectory(path);
+#endif
+}
+
+// Create the directory, and clear out manifests left behind by an earlier, larger run
+static bool PrepareDirectory(const std::string& path) {
+    if (!MakeDirectories(path)) {
+        return false;
+    }
+    std::vector<std::string> files;
+    FileSysUtilsFindFilesInPath(path, files);
+    for (const auto& file : files) {
+        std::string full_path;
+        if (file.size() > 5 && file.compare(file.size() - 5, 5, ".json") == 0 && FileSysUtilsCombinePaths(path, file, full_path)) {
+            std::remove(full_path.c_str());
+        }
+    }
+    return true;
+}
+
+static const char* const g_farm_extension_prefix = "XR_EXT_farm_extension_";
+
+// Roughly what shipping manifests look like: a handful of extensions, and every so often a long list.
+static uint32_t FarmExtensionCount(uint32_t index) { return (index % 10 == 0) ? 40 : 4; }
+
+static void WriteExtensions(std::ofstream& out, uint32_t index, const char* indent) {
+    uint32_t extension_count = FarmExtensionCount(index);
+    out << indent << "\"instance_extensions\": [\n";
+    for (uint32_t ext = 0; ext < extension_count; ++ext) {
+        out << indent << "    { \"name\": \"" << g_farm_extension_prefix << ext << "\", \"spec_version\": " << ext + 1 << " }";
+        out << ((ext + 1 < extension_count) ? ",\n" : "\n");
+    }
+    out << indent << "],\n";
+}
+
+// Every other generation of a manifest ends in an extra newline, so that rewriting it always changes its
+// size even where modification times are too coarse to tell two writes apart.
+static const char* ManifestEnd(uint32_t generation) { return (generation % 2 == 0) ? "}\n" : "}\n\n"; }
+
+static bool WriteRuntimeManifest(const std::string& filename, uint32_t index, uint32_t generation,
+                                 const std::string& library_path) {
+    std::ofstream out(filename, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    out << "{\n    \"file_format_version\": \"1.0.0\",\n    \"runtime\": {\n";
+    out << "        \"library_path\": \"" << library_path << "\",\n";
+    WriteExtensions(out, index, "        ");
+    out << "        \"functions\": {\n";
+    out << "            \"xrNegotiateLoaderRuntimeInterface\": \"xrNegotiateLoaderRuntimeInterface\"\n";
+    out << "        }\n    }\n" << ManifestEnd(generation);
+    return out.good();
+}
+
+static bool WriteLayerManifest(const std::string& filename, uint32_t index, bool implicit, uint32_t generation,
+                               const std::string& library_path) {
+    std::ofstream out(filename, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    out << "{\n    \"file_format_version\": \"1.0.0\",\n    \"api_layer\": {\n";
+    out << "        \"name\": \"XR_APILAYER_FARM_" << (implicit ? "implicit_" : "explicit_") << index << "\",\n";
+    out << "        \"library_path\": \"" << library_path << "\",\n";
+    out << "        \"api_version\": \"0.90\",\n        \"implementation_version\": \"1\",\n";
+    out << "        \"description\": \"Synthetic layer manifest for benchmarking\",\n";
+    WriteExtensions(out, index, "        ");
+    if (implicit) {
+        out << "        \"enable_environment\": \"XR_FARM_ENABLE_IMPLICIT_" << index << "\",\n";
+        out << "        \"disable_environment\": \"XR_FARM_DISABLE_IMPLICIT_" << index << "\",\n";
+    }
+    out << "        \"functions\": {\n";
+    out << "            \"xrNegotiateLoaderApiLayerInterface\": \"xrNegotiateLoaderApiLayerInterface\"\n";
+    out << "        }\n    }\n" << ManifestEnd(generation);
+    return out.good();
+}
+
+// Where the farm's manifests go, and which generation of them is on disk.
+struct ManifestFarm {
+    std::vector<std::string> runtime_files;
+    std::vector<std::string> layer_files;
+    uint32_t generation = 0;
+    // The runtime manifest XR_RUNTIME_JSON points at
+    uint32_t active_runtime = 0;
+};
+
+static bool WriteFarm(const ManifestFarm& farm) {
+    for (uint32_t index = 0; index < farm.runtime_files.size(); ++index) {
+        if (!WriteRuntimeManifest(farm.runtime_files[index], index, farm.generation, MANIFEST_FARM_RUNTIME_LIBRARY)) {
+            std::cerr << "Unable to write manifest " << farm.runtime_files[index] << std::endl;
+            return false;
+        }
+    }
+    for (uint32_t index = 0; index < farm.layer_files.size(); ++index) {
+        bool implicit = (index % 2 == 0);
+        if (!WriteLayerManifest(farm.layer_files[index], index, implicit, farm.generation, MANIFEST_FARM_LAYER_LIBRARY)) {
+            std::cerr << "Unable to write manifest " << farm.layer_files[index] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool EnumerateLayers() {
+    uint32_t count = 0;
+    if (XR_FAILED(xrEnumerateApiLayerProperties(0, &count, nullptr))) {
+        return false;
+    }
+    std::vector<XrApiLayerProperties> properties(count, {XR_TYPE_API_LAYER_PROPERTIES});
+    return XR_SUCCEEDED(xrEnumerateApiLayerProperties(count, &count, properties.data()));
+}
+
+// No layer is enabled, so besides the loader's own extensions exactly those of the active runtime manifest must
+// be reported.  Any fewer and the manifest was rejected, leaving the loader to ask the runtime library instead.
+static bool EnumerateExtensions(uint32_t expected_farm_extensions) {
+    uint32_t count = 0;
+    if (XR_FAILED(xrEnumerateInstanceExtensionProperties(nullptr, 0, &count, nullptr))) {
+        return false;
+    }
+    std::vector<XrExtensionProperties> properties(count, {XR_TYPE_EXTENSION_PROPERTIES});
+    if (XR_FAILED(xrEnumerateInstanceExtensionProperties(nullptr, count, &count, properties.data()))) {
+        return false;
+    }
+    size_t prefix_length = strlen(g_farm_extension_prefix);
+    uint32_t farm_extensions = static_cast<uint32_t>(
+        std::count_if(properties.begin(), properties.end(), [prefix_length](const XrExtensionProperties& property) {
+            return 0 == strncmp(property.extensionName, g_farm_extension_prefix, prefix_length);
+        }));
+    if (farm_extensions != expected_farm_extensions) {
+        std::cerr << "Expected " << expected_farm_extensions << " extensions from the runtime manifest, got " << farm_extensions
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool CreateInstance(double& elapsed_us) {
+    XrInstanceCreateInfo instance_info = {XR_TYPE_INSTANCE_CREATE_INFO};
+    strcpy(instance_info.applicationInfo.applicationName, "manifest_farm_bench");
+    instance_info.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+    XrInstance instance = XR_NULL_HANDLE;
+    auto start = std::chrono::steady_clock::now();
+    XrResult result = xrCreateInstance(&instance_info, &instance);
+    auto end = std::chrono::steady_clock::now();
+    elapsed_us = std::chrono::duration<double, std::micro>(end - start).count();
+    if (XR_FAILED(result)) {
+        return false;
+    }
+    xrDestroyInstance(instance);
+    return true;
+}
+
+// Run one command for every iteration, rewriting the farm first when cold so that the loader's caches
+// are invalidated.  Only the command itself is timed.
+template <typename Command>
+static bool TimeCommand(const char* name, bool cold, uint32_t iterations, ManifestFarm& farm, Command command,
+                        BenchJsonReport& report) {
+    double total_us = 0.0;
+    double min_us = 0.0;
+    for (uint32_t iter = 0; iter < iterations; ++iter) {
+        if (cold) {
+            ++farm.generation;
+            if (!WriteFarm(farm)) {
+                return false;
+            }
+            farm.active_runtime = iter % static_cast<uint32_t>(farm.runtime_files.size());
+            LoaderTestSetEnvironmentVariable("XR_RUNTIME_JSON", farm.runtime_files[farm.active_runtime]);
+        }
+        double elapsed_us = 0.0;
+        if (!command(elapsed_us)) {
+            std::cerr << name << " failed" << std::endl;
+            return false;
+        }
+        total_us += elapsed_us;
+        if (0 == iter || elapsed_us < min_us) {
+            min_us = elapsed_us;
+        }
+    }
+    report.AddRecord()
+        .Add("command", name)
+        .Add("phase", cold ? "cold" : "warm")
+        .Add("mean_us", total_us / iterations)
+        .Add("min_us", min_us);
+    return true;
+}
+
+template <typename Call>
+static bool TimeCall(Call call, double& elapsed_us) {
+    auto start = std::chrono::steady_clock::now();
+    bool succeeded = call();
+    auto end = std::chrono::steady_clock::now();
+    elapsed_us = std::chrono::duration<double, std::micro>(end - start).count();
+    return succeeded;
+}
+
+int main(int argc, char* argv[]) {
+    std::string directory = (argc > 1) ? argv[1] : "";
+    uint32_t runtime_count = (argc > 2) ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 16;
+    uint32_t layer_count = (argc > 3) ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1000;
+    uint32_t iterations = (argc > 4) ? static_cast<uint32_t>(std::strtoul(argv[4], nullptr, 10)) : 20;
+    if (0 == runtime_count || 0 == iterations) {
+        std::cerr << "Usage: manifest_farm_bench [directory] [runtime count] [layer count] [iterations]" << std::endl;
+        return 1;
+    }
+
+    bool temporary = directory.empty();
+    if (temporary && !BenchMakeTemporaryDirectory("manifest_farm", directory)) {
+        std::cerr << "Unable to create a temporary directory" << std::endl;
+        return 1;
+    }
+    std::string farm;
+    if (!MakeDirectories(directory) || !FileSysUtilsGetAbsolutePath(directory, farm)) {
+        std::cerr << "Unable to create directory " << directory << std::endl;
+        return 1;
+    }
+    std::string major = std::to_string(XR_VERSION_MAJOR(XR_CURRENT_API_VERSION));
+    std::string runtime_dir = farm + "/runtimes";
+    std::string explicit_dir = farm + "/explicit";
+    std::string xdg_config_dir = farm + "/xdg_config";
+    std::string xdg_data_dir = farm + "/xdg_data";
+    std::string xdg_data_home = farm + "/xdg_data_home";
+    std::string implicit_dir = xdg_config_dir + "/openxr/" + major + "/api_layers/implicit.d";
+    for (const std::string* dir : {&runtime_dir, &explicit_dir, &xdg_data_dir, &xdg_data_home, &implicit_dir}) {
+        if (!PrepareDirectory(*dir)) {
+            std::cerr << "Unable to create directory " << *dir << std::endl;
+            return 1;
+        }
+    }
+
+    ManifestFarm manifests;
+    for (uint32_t index = 0; index < runtime_count; ++index) {
+        manifests.runtime_files.push_back(runtime_dir + "/farm_runtime_" + std::to_string(index) + ".json");
+    }
+    for (uint32_t index = 0; index < layer_count; ++index) {
+        bool implicit = (index % 2 == 0);
+        std::string layer_dir = implicit ? implicit_dir : explicit_dir;
+        manifests.layer_files.push_back(layer_dir + "/farm_layer_" + std::to_string(index) + ".json");
+    }
+    if (!WriteFarm(manifests)) {
+        return 1;
+    }
+
+    LoaderTestSetEnvironmentVariable("XDG_CONFIG_DIRS", xdg_config_dir);
+    LoaderTestSetEnvironmentVariable("XDG_DATA_DIRS", xdg_data_dir);
+    LoaderTestSetEnvironmentVariable("XDG_DATA_HOME", xdg_data_home);
+    LoaderTestSetEnvironmentVariable("XR_API_LAYER_PATH", explicit_dir);
+    LoaderTestSetEnvironmentVariable("XR_RUNTIME_JSON", manifests.runtime_files[0]);
+
+    BenchJsonReport report("manifest_farm_bench", "results");
+    report.Fields().Add("runtime_manifests", runtime_count).Add("layer_manifests", layer_count).Add("iterations", iterations);
+    bool succeeded = true;
+    for (uint32_t pass = 0; pass < 2 && succeeded; ++pass) {
+        bool cold = (0 == pass);
+        succeeded = TimeCommand("xrEnumerateApiLayerProperties", cold, iterations, manifests,
+                                [](double& elapsed_us) { return TimeCall(EnumerateLayers, elapsed_us); }, report) &&
+                    TimeCommand("xrEnumerateInstanceExtensionProperties", cold, iterations, manifests,
+                                [&manifests](double& elapsed_us) {
+                                    uint32_t expected = FarmExtensionCount(manifests.active_runtime);
+                                    return TimeCall([expected]() { return EnumerateExtensions(expected); }, elapsed_us);
+                                },
+                                report) &&
+                    TimeCommand("xrCreateInstance", cold, iterations, manifests, CreateInstance, report);
+    }
+
+    if (temporary) {
+        for (const auto& filename : manifests.runtime_files) {
+            std::remove(filename.c_str());
+        }
+        for (const auto& filename : manifests.layer_files) {
+            std::remove(filename.c_str());
+        }
+        std::string openxr_dir = xdg_config_dir + "/openxr";
+        std::string major_dir = openxr_dir + "/" + major;
+        for (const std::string& dir : {implicit_dir, major_dir + "/api_layers", major_dir, openxr_dir, xdg_config_dir, runtime_dir,
+                                       explicit_dir, xdg_data_dir, xdg_data_home, farm}) {
+            BenchRemoveDirectory(dir);
+        }
+    }
+    if (!succeeded) {
+        return 1;
+    }
+
+    report.Write(std::cout);
+    return 0;
+}
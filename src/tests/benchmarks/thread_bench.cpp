@@ -0,0 +1,161 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Multi-threaded trampoline scaling benchmark.
+//
+// Runs 1 to N threads, each alternating xrLocateSpace and xrGetActionStateBoolean calls through the
+// loader's trampolines against the test runtime, whose versions of both do nothing.  Every thread
+// count is run twice: once with each thread owning its own session, space and action ("disjoint"),
+// and once with all threads sharing the same ones ("shared").  Either way every call takes the
+// loader's g_space_mutex or g_action_mutex, so the numbers show how far the handle map locking lets
+// the trampolines scale.  Results are written to stdout as JSON.
+//
+//   thread_bench [max_threads] [calls_per_thread]
+//
+// Latencies are measured per call with std::chrono::steady_clock, so they include the cost of
+// reading the clock.  XR_RUNTIME_JSON defaults to the test runtime of this build.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+
+#include "bench_common.hpp"
+
+struct ScalingResult {
+    std::string handles;
+    uint32_t thread_count;
+    double calls_per_second;
+    double speedup;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+};
+
+static void CallLoop(const BenchObjects& objects, std::atomic<bool>& go, uint32_t* latencies_ns, uint32_t calls) {
+    XrSpaceRelation relation = {XR_TYPE_SPACE_RELATION};
+    XrActionStateBoolean action_state = {XR_TYPE_ACTION_STATE_BOOLEAN};
+    while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    for (uint32_t call = 0; call < calls; ++call) {
+        auto start = std::chrono::steady_clock::now();
+        if (0 == (call & 1)) {
+            xrLocateSpace(objects.space, objects.space, 1, &relation);
+        } else {
+            xrGetActionStateBoolean(objects.action, 0, nullptr, &action_state);
+        }
+        auto end = std::chrono::steady_clock::now();
+        latencies_ns[call] = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+}
+
+static ScalingResult RunThreads(const std::vector<BenchObjects>& objects, bool shared, uint32_t thread_count, uint32_t calls) {
+    std::vector<uint32_t> latencies_ns(static_cast<size_t>(thread_count) * calls);
+    std::vector<std::thread> threads;
+    std::atomic<bool> go(false);
+    for (uint32_t thread = 0; thread < thread_count; ++thread) {
+        const BenchObjects& thread_objects = objects[shared ? 0 : thread];
+        threads.emplace_back(CallLoop, std::cref(thread_objects), std::ref(go), &latencies_ns[static_cast<size_t>(thread) * calls],
+                             calls);
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    ScalingResult result = {};
+    result.handles = shared ? "shared" : "disjoint";
+    result.thread_count = thread_count;
+    result.calls_per_second = static_cast<double>(latencies_ns.size()) / std::chrono::duration<double>(end - start).count();
+    result.p50_ns = BenchPercentile(latencies_ns, 0.50);
+    result.p99_ns = BenchPercentile(latencies_ns, 0.99);
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t max_threads = std::max(1U, std::thread::hardware_concurrency());
+    if (argc > 1) {
+        max_threads = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    uint32_t calls = (argc > 2) ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 100000;
+    if (0 == max_threads || 0 == calls) {
+        std::cerr << "Usage: thread_bench [max_threads] [calls_per_thread]" << std::endl;
+        return 1;
+    }
+    BenchSetEnvDefault("XR_RUNTIME_JSON", THREAD_BENCH_RUNTIME_JSON);
+
+    XrInstance instance = XR_NULL_HANDLE;
+    if (!BenchCreateInstance("thread_bench", {}, instance)) {
+        std::cerr << "Unable to create an instance" << std::endl;
+        return 1;
+    }
+
+    int exit_code = 0;
+    std::vector<BenchObjects> objects(max_threads);
+    for (auto& thread_objects : objects) {
+        if (!BenchCreateObjects(instance, thread_objects)) {
+            std::cerr << "Unable to create the per-thread objects" << std::endl;
+            exit_code = 1;
+            break;
+        }
+    }
+
+    std::vector<ScalingResult> results;
+    if (0 == exit_code) {
+        for (uint32_t pass = 0; pass < 2; ++pass) {
+            bool shared = (1 == pass);
+            double single_thread_calls_per_second = 0.0;
+            for (uint32_t thread_count = 1; thread_count <= max_threads; ++thread_count) {
+                ScalingResult result = RunThreads(objects, shared, thread_count, calls);
+                if (1 == thread_count) {
+                    single_thread_calls_per_second = result.calls_per_second;
+                }
+                result.speedup = result.calls_per_second / single_thread_calls_per_second;
+                results.push_back(result);
+            }
+        }
+    }
+
+    for (auto& thread_objects : objects) {
+        BenchDestroyObjects(thread_objects);
+    }
+    xrDestroyInstance(instance);
+    if (0 != exit_code) {
+        return exit_code;
+    }
+
+    BenchJsonReport report("thread_bench", "results");
+    report.Fields().Add("calls_per_thread", calls);
+    for (const ScalingResult& result : results) {
+        report.AddRecord()
+            .Add("handles", result.handles)
+            .Add("threads", result.thread_count)
+            .Add("calls_per_second", static_cast<uint64_t>(result.calls_per_second))
+            .Add("speedup", result.speedup)
+            .Add("p50_ns", result.p50_ns)
+            .Add("p99_ns", result.p99_ns);
+    }
+    report.Write(std::cout);
+    return 0;
+}
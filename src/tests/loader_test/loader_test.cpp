@@ -17,17 +17,24 @@
 // Author: Mark Young <marky@lunarg.com>
 //
 
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <new>
 #include <sstream>
 #include <cstring>
 #include <vector>
 
 #include "filesystem_utils.hpp"
+#include "loader_extension_properties.hpp"
+#include "loader_platform.hpp"
 #include "loader_test_utils.hpp"
 
 #include "xr_dependencies.h"
 #include <openxr/openxr.h>
 #include <openxr/openxr_platform.h>
+#include <openxr/openxr_loader.h>
 
 // Filter out the loader's messages to std::cerr if this is defined to 1.  This allows a
 // clean output for the test.
@@ -37,6 +44,28 @@ enum LoaderTestGraphicsApiToUse { GRAPHICS_API_UNKONWN = 0, GRAPHICS_API_OPENGL,
 LoaderTestGraphicsApiToUse g_graphics_api_to_use = GRAPHICS_API_UNKONWN;
 bool g_debug_utils_exists = false;
 
+// Every allocation made through the global operator new, and how many of them are still live, so a
+// test can tell whether the loader went around the allocation callbacks it was given.
+static std::atomic<uint64_t> g_global_allocation_count(0);
+static std::atomic<int64_t> g_global_outstanding_count(0);
+
+void* operator new(size_t size) {
+    g_global_allocation_count++;
+    void* memory = malloc(size == 0 ? 1 : size);
+    if (nullptr == memory) {
+        throw std::bad_alloc();
+    }
+    g_global_outstanding_count++;
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    if (nullptr != memory) {
+        g_global_outstanding_count--;
+    }
+    free(memory);
+}
+
 void CleanupEnvironmentVariables() {
     LoaderTestUnsetEnvironmentVariable("XR_ENABLE_API_LAYERS");
     LoaderTestUnsetEnvironmentVariable("XR_API_LAYER_PATH");
@@ -241,6 +270,10 @@ void TestEnumInstanceExtensions(uint32_t& total, uint32_t& passed, uint32_t& ski
                     expected_extension_count = 4;
                     break;
             }
+#if defined(LOADER_STATISTICS)
+            // The loader adds XR_EXT_loader_statistics itself
+            expected_extension_count++;
+#endif  // LOADER_STATISTICS
 
             // Test just runtimes
             std::vector<std::string> files;
@@ -460,6 +493,49 @@ void TestEnumInstanceExtensions(uint32_t& total, uint32_t& passed, uint32_t& ski
     local_failed++;            \
     std::cout << "        " << cout_string << ": Failed" << std::endl;
 
+// Test merging extension properties the way the loader combines the API layer, runtime and loader lists.
+DEFINE_TEST(TestMergeExtensionProperties) {
+    INIT_TEST(TestMergeExtensionProperties)
+
+    try {
+        std::vector<XrExtensionProperties> properties;
+        ExtensionPropertiesMerge merge(properties);
+        merge.Add("XR_EXT_first", 2);
+        merge.Add("XR_EXT_second", 1);
+        merge.Add("XR_EXT_third", 3);
+        TEST_EQUAL(properties.size(), 3, "Distinct extensions are all added")
+
+        // Repeats, including one given a newer and one an older spec version, don't move or duplicate entries.
+        merge.Add("XR_EXT_second", 4);
+        merge.Add("XR_EXT_first", 1);
+        merge.Add("XR_EXT_fourth", 1);
+        TEST_EQUAL(properties.size(), 4, "Repeated extensions are merged")
+        TEST_EQUAL(strcmp(properties[0].extensionName, "XR_EXT_first"), 0, "First extension keeps its position")
+        TEST_EQUAL(strcmp(properties[1].extensionName, "XR_EXT_second"), 0, "Second extension keeps its position")
+        TEST_EQUAL(strcmp(properties[2].extensionName, "XR_EXT_third"), 0, "Third extension keeps its position")
+        TEST_EQUAL(strcmp(properties[3].extensionName, "XR_EXT_fourth"), 0, "New extension is added last")
+        TEST_EQUAL(properties[0].specVersion, 2, "Older spec version does not replace a newer one")
+        TEST_EQUAL(properties[1].specVersion, 4, "Newer spec version replaces an older one")
+        TEST_EQUAL(properties[3].type, XR_TYPE_EXTENSION_PROPERTIES, "Added extension has the right type")
+
+        // A second merge picks up the entries already in the list.
+        std::vector<XrExtensionProperties> more_properties = properties;
+        more_properties[2].specVersion = 5;
+        ExtensionPropertiesMerge second_merge(properties);
+        second_merge.Add(more_properties);
+        TEST_EQUAL(properties.size(), 4, "Merging the same extensions again adds nothing")
+        TEST_EQUAL(properties[2].specVersion, 5, "Merging a list updates the spec version")
+    } catch (...) {
+        TEST_FAIL("Exception triggered during test, automatic failure")
+    }
+
+    // Cleanup
+    CleanupEnvironmentVariables();
+
+    // Output results for this test
+    TEST_REPORT(TestMergeExtensionProperties)
+}
+
 // Test creating and destroying an OpenXR instance through the loader.
 DEFINE_TEST(TestCreateDestroyInstance) {
     INIT_TEST(TestCreateDestroyInstance)
@@ -675,6 +751,393 @@ DEFINE_TEST(TestGetSystem) {
     TEST_REPORT(TestGetSystem)
 }
 
+// Create an instance for the tests below, with the given next chain, extensions and API layers.
+static XrResult CreateLoaderTestInstance(XrInstance* instance, const void* next = nullptr,
+                                         const std::vector<const char*>& extensions = {},
+                                         const std::vector<const char*>& api_layers = {}) {
+    XrInstanceCreateInfo instance_create_info = {};
+    instance_create_info.type = XR_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.next = next;
+    strcpy(instance_create_info.applicationInfo.applicationName, "Loader Test");
+    instance_create_info.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+    instance_create_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    instance_create_info.enabledExtensionNames = extensions.empty() ? nullptr : extensions.data();
+    instance_create_info.enabledApiLayerCount = static_cast<uint32_t>(api_layers.size());
+    instance_create_info.enabledApiLayerNames = api_layers.empty() ? nullptr : api_layers.data();
+    return xrCreateInstance(&instance_create_info, instance);
+}
+
+struct TestAllocationTracker {
+    uint64_t allocations = 0;
+    uint64_t outstanding = 0;
+};
+
+// malloc already returns memory aligned for any fundamental type, which is all the loader asks for
+static void* XRAPI_PTR TestAllocate(void* user_data, size_t size, size_t alignment) {
+    TestAllocationTracker* tracker = reinterpret_cast<TestAllocationTracker*>(user_data);
+    tracker->allocations++;
+    tracker->outstanding++;
+    return malloc(size);
+}
+
+static void XRAPI_PTR TestFree(void* user_data, void* memory) {
+    TestAllocationTracker* tracker = reinterpret_cast<TestAllocationTracker*>(user_data);
+    tracker->outstanding--;
+    free(memory);
+}
+
+static XrBool32 XRAPI_PTR TestIgnoreDebugMessage(XrDebugUtilsMessageSeverityFlagsEXT message_severity,
+                                                 XrDebugUtilsMessageTypeFlagsEXT message_types,
+                                                 const XrDebugUtilsMessengerCallbackDataEXT* callback_data, void* user_data) {
+    return XR_FALSE;
+}
+
+// Test that once an instance has been created with allocation callbacks, the loader allocates through
+// them rather than the global heap, and hands everything back when the instance is destroyed.
+DEFINE_TEST(TestAllocationCallbacks) {
+    INIT_TEST(TestAllocationCallbacks)
+
+    try {
+        std::string current_path;
+        std::string test_runtime_path;
+        if (!FileSysUtilsGetCurrentPath(current_path) ||
+            !FileSysUtilsCombinePaths(current_path, "resources/runtimes/test_runtime.json", test_runtime_path)) {
+            std::cout << "FAILED to set runtime path!" << std::endl;
+            throw - 1;
+        }
+        LoaderTestSetEnvironmentVariable("XR_RUNTIME_JSON", test_runtime_path);
+
+        TestAllocationTracker tracker;
+        XrLoaderAllocationCallbacks allocation_callbacks = {};
+        allocation_callbacks.type = XR_TYPE_LOADER_ALLOCATION_CALLBACKS;
+        allocation_callbacks.userData = &tracker;
+        allocation_callbacks.pfnAllocation = TestAllocate;
+        allocation_callbacks.pfnFree = TestFree;
+
+        // The runtime is loaded for the first instance and shared with every later one, and the first trampoline
+        // calls on a thread may set up per-thread state, such as loader statistics counters.  Keep an instance
+        // alive while measuring, so neither shows up as allocations made for the instance under test.
+        XrInstance first_instance = XR_NULL_HANDLE;
+        TEST_EQUAL(CreateLoaderTestInstance(&first_instance, &allocation_callbacks), XR_SUCCESS,
+                   "Creating first instance with allocation callbacks")
+        TEST_NOT_EQUAL(tracker.allocations, 0, "Instance allocated through the callbacks")
+        XrSessionCreateInfo session_create_info = {};
+        session_create_info.type = XR_TYPE_SESSION_CREATE_INFO;
+        XrSession warm_up_session = XR_NULL_HANDLE;
+        if (XR_SUCCESS == xrCreateSession(first_instance, &session_create_info, &warm_up_session)) {
+            xrDestroySession(warm_up_session);
+        }
+
+        // Creating an instance still allocates from the global heap on the way, to parse manifests and format
+        // log messages, but nothing it keeps may be left there.
+        int64_t global_outstanding = g_global_outstanding_count;
+        uint64_t callback_allocations = tracker.allocations;
+        XrInstance instance = XR_NULL_HANDLE;
+        TEST_EQUAL(CreateLoaderTestInstance(&instance, &allocation_callbacks), XR_SUCCESS,
+                   "Creating instance with allocation callbacks")
+        TEST_EQUAL(g_global_outstanding_count - global_outstanding, 0, "Nothing kept for the instance on the global heap")
+        TEST_NOT_EQUAL(tracker.allocations, callback_allocations, "Second instance allocated through the callbacks")
+
+        callback_allocations = tracker.allocations;
+        uint64_t global_allocations = g_global_allocation_count;
+        bool sessions_valid = true;
+        for (uint32_t iteration = 0; iteration < 16; ++iteration) {
+            XrSession sessions[4];
+            for (XrSession& session : sessions) {
+                sessions_valid = sessions_valid && XR_SUCCESS == xrCreateSession(instance, &session_create_info, &session);
+            }
+            for (XrSession& session : sessions) {
+                sessions_valid = sessions_valid && XR_SUCCESS == xrDestroySession(session);
+            }
+        }
+        TEST_EQUAL(sessions_valid, true, "Creating and destroying sessions")
+        TEST_EQUAL(g_global_allocation_count - global_allocations, 0, "No global allocations tracking sessions")
+        TEST_NOT_EQUAL(tracker.allocations, callback_allocations, "Sessions tracked through the callbacks")
+
+        TEST_EQUAL(xrDestroyInstance(instance), XR_SUCCESS, "Destroying instance")
+        TEST_EQUAL(g_global_outstanding_count - global_outstanding, 0, "Global heap back where it was before the instance")
+        TEST_EQUAL(xrDestroyInstance(first_instance), XR_SUCCESS, "Destroying first instance")
+        TEST_EQUAL(tracker.outstanding, 0, "Everything allocated through the callbacks was freed")
+
+        allocation_callbacks.pfnFree = nullptr;
+        TEST_EQUAL(CreateLoaderTestInstance(&instance, &allocation_callbacks), XR_ERROR_VALIDATION_FAILURE,
+                   "Creating instance with incomplete allocation callbacks")
+        allocation_callbacks.pfnFree = TestFree;
+
+        // The callbacks are taken out of the chain passed on to the runtime, which rejects structures it doesn't know
+        XrDebugUtilsMessengerCreateInfoEXT messenger_create_info = {};
+        messenger_create_info.type = XR_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+        messenger_create_info.next = &allocation_callbacks;
+        messenger_create_info.messageSeverities = XR_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+        messenger_create_info.messageTypes = XR_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT;
+        messenger_create_info.userCallback = TestIgnoreDebugMessage;
+        TEST_EQUAL(CreateLoaderTestInstance(&instance, &messenger_create_info, {XR_EXT_DEBUG_UTILS_EXTENSION_NAME}), XR_SUCCESS,
+                   "Creating instance with allocation callbacks behind a messenger create info")
+        TEST_EQUAL(xrDestroyInstance(instance), XR_SUCCESS, "Destroying instance with a messenger")
+
+        XrBaseInStructure unknown_structure = {};
+        unknown_structure.type = XR_TYPE_SPACE_RELATION;
+        unknown_structure.next = reinterpret_cast<const XrBaseInStructure*>(&allocation_callbacks);
+        TEST_EQUAL(CreateLoaderTestInstance(&instance, &unknown_structure), XR_ERROR_VALIDATION_FAILURE,
+                   "Creating instance with allocation callbacks behind a structure the loader can't copy")
+        TEST_EQUAL(tracker.outstanding, 0, "Everything allocated for the instance with a messenger was freed")
+    } catch (...) {
+        TEST_FAIL("Exception triggered during test, automatic failure")
+    }
+
+    // Cleanup
+    CleanupEnvironmentVariables();
+
+    // Output results for this test
+    TEST_REPORT(TestAllocationCallbacks)
+}
+
+// Test that instances alive at the same time can't mix allocation callbacks, and that callbacks are
+// no longer called once the last instance using them is gone.
+DEFINE_TEST(TestAllocationCallbacksTwoInstances) {
+    INIT_TEST(TestAllocationCallbacksTwoInstances)
+
+    try {
+        std::string current_path;
+        std::string test_runtime_path;
+        if (!FileSysUtilsGetCurrentPath(current_path) ||
+            !FileSysUtilsCombinePaths(current_path, "resources/runtimes/test_runtime.json", test_runtime_path)) {
+            std::cout << "FAILED to set runtime path!" << std::endl;
+            throw - 1;
+        }
+        LoaderTestSetEnvironmentVariable("XR_RUNTIME_JSON", test_runtime_path);
+
+        TestAllocationTracker first_tracker;
+        XrLoaderAllocationCallbacks first_callbacks = {};
+        first_callbacks.type = XR_TYPE_LOADER_ALLOCATION_CALLBACKS;
+        first_callbacks.userData = &first_tracker;
+        first_callbacks.pfnAllocation = TestAllocate;
+        first_callbacks.pfnFree = TestFree;
+        TestAllocationTracker second_tracker;
+        XrLoaderAllocationCallbacks second_callbacks = first_callbacks;
+        second_callbacks.userData = &second_tracker;
+
+        XrInstance first_instance = XR_NULL_HANDLE;
+        XrInstance second_instance = XR_NULL_HANDLE;
+        XrInstance rejected_instance = XR_NULL_HANDLE;
+        TEST_EQUAL(CreateLoaderTestInstance(&first_instance, &first_callbacks), XR_SUCCESS, "Creating first instance")
+        TEST_EQUAL(CreateLoaderTestInstance(&second_instance, &first_callbacks), XR_SUCCESS,
+                   "Creating second instance with the same callbacks")
+        TEST_EQUAL(CreateLoaderTestInstance(&rejected_instance, &second_callbacks), XR_ERROR_VALIDATION_FAILURE,
+                   "Creating instance with different callbacks")
+        TEST_EQUAL(CreateLoaderTestInstance(&rejected_instance), XR_ERROR_VALIDATION_FAILURE,
+                   "Creating instance without callbacks")
+        TEST_EQUAL(second_tracker.allocations, 0, "Rejected callbacks never called")
+
+        TEST_EQUAL(xrDestroyInstance(first_instance), XR_SUCCESS, "Destroying first instance")
+        TEST_NOT_EQUAL(first_tracker.outstanding, 0, "Second instance still allocated through the callbacks")
+        TEST_EQUAL(xrDestroyInstance(second_instance), XR_SUCCESS, "Destroying second instance")
+        TEST_EQUAL(first_tracker.outstanding, 0, "Everything freed once both instances are destroyed")
+
+        uint64_t first_allocations = first_tracker.allocations;
+        TEST_EQUAL(CreateLoaderTestInstance(&second_instance, &second_callbacks), XR_SUCCESS,
+                   "Creating instance with other callbacks once the first are released")
+        TEST_NOT_EQUAL(second_tracker.allocations, 0, "Instance allocated through its own callbacks")
+        TEST_EQUAL(xrDestroyInstance(second_instance), XR_SUCCESS, "Destroying instance with other callbacks")
+        TEST_EQUAL(first_tracker.allocations, first_allocations, "Released callbacks no longer called")
+        TEST_EQUAL(first_tracker.outstanding, 0, "Released callbacks still have nothing outstanding")
+        TEST_EQUAL(second_tracker.outstanding, 0, "Everything freed through the other callbacks")
+
+        TEST_EQUAL(CreateLoaderTestInstance(&first_instance), XR_SUCCESS, "Creating instance without callbacks")
+        TEST_EQUAL(CreateLoaderTestInstance(&rejected_instance, &first_callbacks), XR_ERROR_VALIDATION_FAILURE,
+                   "Creating instance with callbacks next to one without")
+        TEST_EQUAL(xrDestroyInstance(first_instance), XR_SUCCESS, "Destroying instance without callbacks")
+    } catch (...) {
+        TEST_FAIL("Exception triggered during test, automatic failure")
+    }
+
+    // Cleanup
+    CleanupEnvironmentVariables();
+
+    // Output results for this test
+    TEST_REPORT(TestAllocationCallbacksTwoInstances)
+}
+
+// Soak test creating and destroying a large number of handles, after which the loader's memory footprint
+// must be back where it started.
+DEFINE_TEST(TestMemoryFootprint) {
+    INIT_TEST(TestMemoryFootprint)
+
+    try {
+        std::string current_path;
+        std::string test_runtime_path;
+        if (!FileSysUtilsGetCurrentPath(current_path) ||
+            !FileSysUtilsCombinePaths(current_path, "resources/runtimes/test_runtime.json", test_runtime_path)) {
+            std::cout << "FAILED to set runtime path!" << std::endl;
+            throw - 1;
+        }
+        LoaderTestSetEnvironmentVariable("XR_RUNTIME_JSON", test_runtime_path);
+
+        XrInstance instance = XR_NULL_HANDLE;
+
+        // Anything the loader caches across instances is in place after the first one
+        TEST_EQUAL(CreateLoaderTestInstance(&instance), XR_SUCCESS, "Creating first instance")
+        TEST_EQUAL(xrDestroyInstance(instance), XR_SUCCESS, "Destroying first instance")
+        XrLoaderMemoryFootprint baseline = {};
+        TEST_EQUAL(xrLoaderGetMemoryFootprint(&baseline), XR_SUCCESS, "Getting baseline footprint")
+
+        TEST_EQUAL(CreateLoaderTestInstance(&instance), XR_SUCCESS, "Creating instance")
+        XrLoaderMemoryFootprint footprint = {};
+        xrLoaderGetMemoryFootprint(&footprint);
+        TEST_NOT_EQUAL(footprint.instanceBytes, 0, "Instance counted in footprint")
+        TEST_NOT_EQUAL(footprint.dispatchTableBytes, baseline.dispatchTableBytes, "Dispatch tables counted in footprint")
+
+        XrSessionCreateInfo session_create_info = {};
+        session_create_info.type = XR_TYPE_SESSION_CREATE_INFO;
+        std::vector<XrSession> sessions(100);
+        bool sessions_valid = true;
+        for (uint32_t batch = 0; batch < 100; ++batch) {
+            for (XrSession& session : sessions) {
+                sessions_valid = sessions_valid && XR_SUCCESS == xrCreateSession(instance, &session_create_info, &session);
+            }
+            if (batch == 0) {
+                xrLoaderGetMemoryFootprint(&footprint);
+                TEST_NOT_EQUAL(footprint.handleMapBytes, baseline.handleMapBytes, "Sessions counted in footprint")
+            }
+            for (XrSession& session : sessions) {
+                sessions_valid = sessions_valid && XR_SUCCESS == xrDestroySession(session);
+            }
+        }
+        TEST_EQUAL(sessions_valid, true, "Creating and destroying 10000 sessions")
+
+        TEST_EQUAL(xrDestroyInstance(instance), XR_SUCCESS, "Destroying instance")
+        xrLoaderGetMemoryFootprint(&footprint);
+        TEST_EQUAL(footprint.totalBytes, baseline.totalBytes, "Footprint back to baseline")
+        TEST_EQUAL(footprint.handleMapBytes, baseline.handleMapBytes, "Handle maps back to baseline")
+    } catch (...) {
+        TEST_FAIL("Exception triggered during test, automatic failure")
+    }
+
+    // Cleanup
+    CleanupEnvironmentVariables();
+
+    // Output results for this test
+    TEST_REPORT(TestMemoryFootprint)
+}
+
+#if defined(LOADER_STATISTICS)
+// Find the statistics of one command, or nullptr if the loader doesn't report it.
+static const XrLoaderCommandStatisticsEXT* FindCommandStatistics(const std::vector<XrLoaderCommandStatisticsEXT>& statistics,
+                                                                 const char* command_name) {
+    for (const XrLoaderCommandStatisticsEXT& statistic : statistics) {
+        if (0 == strcmp(statistic.commandName, command_name)) {
+            return &statistic;
+        }
+    }
+    return nullptr;
+}
+
+// Find the number of live handles of one type, or -1 if the loader doesn't report that type.
+static int64_t FindHandleCount(const std::vector<XrLoaderHandleStatisticsEXT>& statistics, XrObjectType object_type) {
+    for (const XrLoaderHandleStatisticsEXT& statistic : statistics) {
+        if (statistic.objectType == object_type) {
+            return static_cast<int64_t>(statistic.handleCount);
+        }
+    }
+    return -1;
+}
+
+// Test that XR_EXT_loader_statistics counts exactly the calls made through the generated trampolines, and
+// reports the handles the loader is tracking.  Statistics are process wide, so only differences are checked.
+DEFINE_TEST(TestLoaderStatistics) {
+    INIT_TEST(TestLoaderStatistics)
+
+    try {
+        std::string current_path;
+        std::string test_runtime_path;
+        if (!FileSysUtilsGetCurrentPath(current_path) ||
+            !FileSysUtilsCombinePaths(current_path, "resources/runtimes/test_runtime.json", test_runtime_path)) {
+            std::cout << "FAILED to set runtime path!" << std::endl;
+            throw - 1;
+        }
+        LoaderTestSetEnvironmentVariable("XR_RUNTIME_JSON", test_runtime_path);
+
+        XrInstance instance = XR_NULL_HANDLE;
+        TEST_EQUAL(CreateLoaderTestInstance(&instance, nullptr, {XR_EXT_LOADER_STATISTICS_EXTENSION_NAME}), XR_SUCCESS,
+                   "Creating instance with loader statistics")
+
+        PFN_xrEnumerateLoaderCommandStatisticsEXT pfn_command_statistics = nullptr;
+        PFN_xrEnumerateLoaderHandleStatisticsEXT pfn_handle_statistics = nullptr;
+        xrGetInstanceProcAddr(instance, "xrEnumerateLoaderCommandStatisticsEXT",
+                              reinterpret_cast<PFN_xrVoidFunction*>(&pfn_command_statistics));
+        xrGetInstanceProcAddr(instance, "xrEnumerateLoaderHandleStatisticsEXT",
+                              reinterpret_cast<PFN_xrVoidFunction*>(&pfn_handle_statistics));
+        TEST_NOT_EQUAL(pfn_command_statistics, nullptr, "Getting xrEnumerateLoaderCommandStatisticsEXT")
+        TEST_NOT_EQUAL(pfn_handle_statistics, nullptr, "Getting xrEnumerateLoaderHandleStatisticsEXT")
+
+        if (nullptr != pfn_command_statistics && nullptr != pfn_handle_statistics) {
+            uint32_t command_count = 0;
+            TEST_EQUAL(pfn_command_statistics(instance, 0, &command_count, nullptr), XR_SUCCESS, "Getting command count")
+            std::vector<XrLoaderCommandStatisticsEXT> before(command_count);
+            std::vector<XrLoaderCommandStatisticsEXT> after(command_count);
+            TEST_EQUAL(pfn_command_statistics(instance, command_count, &command_count, before.data()), XR_SUCCESS,
+                       "Getting command statistics before the calls")
+
+            const uint32_t session_count = 5;
+            XrSessionCreateInfo session_create_info = {};
+            session_create_info.type = XR_TYPE_SESSION_CREATE_INFO;
+            std::vector<XrSession> sessions(session_count);
+            bool sessions_valid = true;
+            for (XrSession& session : sessions) {
+                sessions_valid = sessions_valid && XR_SUCCESS == xrCreateSession(instance, &session_create_info, &session);
+            }
+            TEST_EQUAL(sessions_valid, true, "Creating sessions")
+
+            uint32_t handle_type_count = 0;
+            TEST_EQUAL(pfn_handle_statistics(instance, 0, &handle_type_count, nullptr), XR_SUCCESS, "Getting handle type count")
+            std::vector<XrLoaderHandleStatisticsEXT> handles(handle_type_count);
+            TEST_EQUAL(pfn_handle_statistics(instance, handle_type_count, &handle_type_count, handles.data()), XR_SUCCESS,
+                       "Getting handle statistics with sessions alive")
+            TEST_EQUAL(FindHandleCount(handles, XR_OBJECT_TYPE_SESSION), static_cast<int64_t>(session_count),
+                       "Live sessions reported")
+
+            for (XrSession& session : sessions) {
+                sessions_valid = sessions_valid && XR_SUCCESS == xrDestroySession(session);
+            }
+            TEST_EQUAL(sessions_valid, true, "Destroying sessions")
+            TEST_EQUAL(pfn_handle_statistics(instance, handle_type_count, &handle_type_count, handles.data()), XR_SUCCESS,
+                       "Getting handle statistics with sessions destroyed")
+            TEST_EQUAL(FindHandleCount(handles, XR_OBJECT_TYPE_SESSION), 0, "No sessions reported once destroyed")
+
+            TEST_EQUAL(pfn_command_statistics(instance, command_count, &command_count, after.data()), XR_SUCCESS,
+                       "Getting command statistics after the calls")
+            const char* const counted_commands[] = {"xrCreateSession", "xrDestroySession"};
+            for (const char* command_name : counted_commands) {
+                const XrLoaderCommandStatisticsEXT* before_statistic = FindCommandStatistics(before, command_name);
+                const XrLoaderCommandStatisticsEXT* after_statistic = FindCommandStatistics(after, command_name);
+                std::string message = command_name;
+                if (nullptr == before_statistic || nullptr == after_statistic) {
+                    TEST_FAIL(message + " reported")
+                    continue;
+                }
+                TEST_EQUAL(after_statistic->callCount - before_statistic->callCount, session_count, message + " calls counted")
+                TEST_EQUAL(after_statistic->totalNs >= before_statistic->totalNs, true, message + " time accumulated")
+            }
+            const XrLoaderCommandStatisticsEXT* before_statistic = FindCommandStatistics(before, "xrBeginSession");
+            const XrLoaderCommandStatisticsEXT* after_statistic = FindCommandStatistics(after, "xrBeginSession");
+            TEST_EQUAL(nullptr != before_statistic && nullptr != after_statistic &&
+                           after_statistic->callCount == before_statistic->callCount,
+                       true, "Commands not called are not counted")
+        }
+
+        TEST_EQUAL(xrDestroyInstance(instance), XR_SUCCESS, "Destroying instance")
+    } catch (...) {
+        TEST_FAIL("Exception triggered during test, automatic failure")
+    }
+
+    // Cleanup
+    CleanupEnvironmentVariables();
+
+    // Output results for this test
+    TEST_REPORT(TestLoaderStatistics)
+}
+#endif  // LOADER_STATISTICS
+
 // Test at least one non-XrInstance function to make sure that the automatic non-instance functions work.
 DEFINE_TEST(TestCreateDestroySession) {
     INIT_TEST(TestCreateDestroySession)
@@ -882,6 +1345,253 @@ DEFINE_TEST(TestCreateDestroySession) {
     TEST_REPORT(TestCreateDestroySession)
 }
 
+// Poll the next event, and tell whether it is the given session changing to the given state.
+static bool PollSessionState(XrInstance instance, XrSession session, XrSessionState state) {
+    XrEventDataBuffer event = {};
+    event.type = XR_TYPE_EVENT_DATA_BUFFER;
+    if (XR_SUCCESS != xrPollEvent(instance, &event) || XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED != event.type) {
+        return false;
+    }
+    const XrEventDataSessionStateChanged* state_changed = reinterpret_cast<const XrEventDataSessionStateChanged*>(&event);
+    return state_changed->session == session && state_changed->state == state;
+}
+
+// Run a session through a few frames of the frame loop against the mock runtime, which implements it
+// without any XR hardware.
+DEFINE_TEST(TestMockRuntimeFrameLoop) {
+    INIT_TEST(TestMockRuntimeFrameLoop)
+
+    try {
+        std::string current_path;
+        std::string mock_runtime_path;
+        if (!FileSysUtilsGetCurrentPath(current_path) ||
+            !FileSysUtilsCombinePaths(current_path, "resources/runtimes/mock_runtime.json", mock_runtime_path)) {
+            std::cout << "FAILED to set runtime path!" << std::endl;
+            throw - 1;
+        }
+        LoaderTestSetEnvironmentVariable("XR_RUNTIME_JSON", mock_runtime_path);
+        // Don't wait for a display that isn't there
+        LoaderTestSetEnvironmentVariable("XR_MOCK_RUNTIME_DISPLAY_PERIOD_NS", "0");
+
+        XrInstance instance = XR_NULL_HANDLE;
+        TEST_EQUAL(CreateLoaderTestInstance(&instance, nullptr, {XR_KHR_HEADLESS_EXTENSION_NAME}), XR_SUCCESS, "Creating instance")
+
+        XrSystemGetInfo system_get_info = {};
+        system_get_info.type = XR_TYPE_SYSTEM_GET_INFO;
+        system_get_info.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+        XrSystemId system_id = XR_NULL_SYSTEM_ID;
+        TEST_EQUAL(xrGetSystem(instance, &system_get_info, &system_id), XR_SUCCESS, "xrGetSystem")
+
+        XrSession session = XR_NULL_HANDLE;
+        XrSessionCreateInfo session_create_info = {};
+        session_create_info.type = XR_TYPE_SESSION_CREATE_INFO;
+        session_create_info.systemId = system_id;
+        TEST_EQUAL(xrCreateSession(instance, &session_create_info, &session), XR_SUCCESS, "xrCreateSession")
+        TEST_EQUAL(PollSessionState(instance, session, XR_SESSION_STATE_IDLE), true, "Session idle")
+        TEST_EQUAL(PollSessionState(instance, session, XR_SESSION_STATE_READY), true, "Session ready")
+
+        XrSessionBeginInfo session_begin_info = {};
+        session_begin_info.type = XR_TYPE_SESSION_BEGIN_INFO;
+        session_begin_info.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        TEST_EQUAL(xrBeginSession(session, &session_begin_info), XR_SUCCESS, "xrBeginSession")
+        TEST_EQUAL(PollSessionState(instance, session, XR_SESSION_STATE_RUNNING), true, "Session running")
+
+        bool frames_valid = true;
+        for (uint32_t frame = 0; frame < 3; ++frame) {
+            XrFrameWaitInfo frame_wait_info = {};
+            frame_wait_info.type = XR_TYPE_FRAME_WAIT_INFO;
+            XrFrameState frame_state = {};
+            frame_state.type = XR_TYPE_FRAME_STATE;
+            frames_valid = frames_valid && XR_SUCCESS == xrWaitFrame(session, &frame_wait_info, &frame_state);
+
+            XrFrameBeginInfo frame_begin_info = {};
+            frame_begin_info.type = XR_TYPE_FRAME_BEGIN_INFO;
+            frames_valid = frames_valid && XR_SUCCESS == xrBeginFrame(session, &frame_begin_info);
+
+            XrFrameEndInfo frame_end_info = {};
+            frame_end_info.type = XR_TYPE_FRAME_END_INFO;
+            frame_end_info.displayTime = frame_state.predictedDisplayTime;
+            frame_end_info.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+            frames_valid = frames_valid && XR_SUCCESS == xrEndFrame(session, &frame_end_info);
+        }
+        TEST_EQUAL(frames_valid, true, "Waiting, beginning and ending 3 frames")
+        // Ending the first frame makes the session visible and gives it focus
+        TEST_EQUAL(PollSessionState(instance, session, XR_SESSION_STATE_VISIBLE), true, "Session visible")
+        TEST_EQUAL(PollSessionState(instance, session, XR_SESSION_STATE_FOCUSED), true, "Session focused")
+
+        TEST_EQUAL(xrEndSession(session), XR_SUCCESS, "xrEndSession")
+        TEST_EQUAL(xrDestroySession(session), XR_SUCCESS, "xrDestroySession")
+        TEST_EQUAL(xrDestroyInstance(instance), XR_SUCCESS, "Destroying instance")
+    } catch (...) {
+        TEST_FAIL("Exception triggered during test, automatic failure")
+    }
+
+    // Cleanup
+    CleanupEnvironmentVariables();
+    LoaderTestUnsetEnvironmentVariable("XR_MOCK_RUNTIME_DISPLAY_PERIOD_NS");
+
+    // Output results for this test
+    TEST_REPORT(TestMockRuntimeFrameLoop)
+}
+
+// Write the manifest of a counting layer.  intercepted_functions is the JSON value given for
+// "intercepted_functions", or nullptr to leave it out.
+static bool WriteCountingLayerManifest(const std::string& directory, const std::string& layer_name,
+                                       const char* intercepted_functions) {
+    std::string filename;
+    if (!FileSysUtilsCombinePaths(directory, layer_name + ".json", filename)) {
+        return false;
+    }
+    std::ofstream out(filename, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    out << "{\n    \"file_format_version\": \"1.0.0\",\n    \"api_layer\": {\n";
+    out << "        \"name\": \"XR_APILAYER_LUNARG_" << layer_name << "\",\n";
+    out << "        \"library_path\": \"" << COUNTING_LAYER_LIBRARY << "\",\n";
+    out << "        \"api_version\": \"" << XR_VERSION_MAJOR(XR_CURRENT_API_VERSION) << "."
+        << XR_VERSION_MINOR(XR_CURRENT_API_VERSION) << "\",\n";
+    out << "        \"implementation_version\": \"1\",\n";
+    if (nullptr != intercepted_functions) {
+        out << "        \"intercepted_functions\": " << intercepted_functions << ",\n";
+    }
+    out << "        \"description\": \"Counting test layer\"\n    }\n}\n";
+    return out.good();
+}
+
+typedef uint32_t (*PFN_CountingLayerGetCallCount)(const char* layerName, const char* command);
+typedef void (*PFN_CountingLayerResetCallCounts)();
+
+// Create an instance on the test runtime with the given counting layers enabled, top first, call
+// xrStringToPath once and destroy it again.
+static bool CallThroughCountingLayers(const std::vector<std::string>& layer_names) {
+    std::vector<std::string> full_layer_names;
+    std::vector<const char*> enabled_layers;
+    for (const auto& layer_name : layer_names) {
+        full_layer_names.push_back("XR_APILAYER_LUNARG_" + layer_name);
+    }
+    for (const auto& full_layer_name : full_layer_names) {
+        enabled_layers.push_back(full_layer_name.c_str());
+    }
+    XrInstance instance = XR_NULL_HANDLE;
+    if (XR_SUCCESS != CreateLoaderTestInstance(&instance, nullptr, {}, enabled_layers)) {
+        return false;
+    }
+    XrPath path = XR_NULL_PATH;
+    bool succeeded = XR_SUCCESS == xrStringToPath(instance, "/user/hand/left", &path);
+    return XR_SUCCESS == xrDestroyInstance(instance) && succeeded;
+}
+
+// Test that layers declaring the functions they intercept are only called for those, and for
+// xrDestroyInstance, while every other layer is still called for everything.
+DEFINE_TEST(TestInterceptedFunctions) {
+    INIT_TEST(TestInterceptedFunctions)
+
+    LoaderPlatformLibraryHandle counting_layer_library = nullptr;
+    try {
+        std::string current_path;
+        std::string test_runtime_path;
+        std::string layer_path;
+        if (!FileSysUtilsGetCurrentPath(current_path) ||
+            !FileSysUtilsCombinePaths(current_path, "resources/runtimes/test_runtime.json", test_runtime_path)) {
+            std::cout << "FAILED to set runtime path!" << std::endl;
+            throw - 1;
+        }
+        if (!FileSysUtilsCombinePaths(current_path, "resources/counting_layers", layer_path)) {
+            std::cout << "FAILED to set layer path!" << std::endl;
+            throw - 1;
+        }
+        LoaderTestSetEnvironmentVariable("XR_RUNTIME_JSON", test_runtime_path);
+        LoaderTestSetEnvironmentVariable("XR_API_LAYER_PATH", layer_path);
+
+        // More layers than the loader has per-position resolvers for, the second and the last of them
+        // intercepting xrStringToPath
+        const uint32_t deep_layer_count = 20;
+        std::vector<std::string> deep_layers;
+        bool manifests_written = WriteCountingLayerManifest(layer_path, "counting_listed", "[ \"xrStringToPath\" ]") &&
+                                 WriteCountingLayerManifest(layer_path, "counting_unlisted", "[ \"xrEndFrame\" ]") &&
+                                 WriteCountingLayerManifest(layer_path, "counting_no_list", nullptr) &&
+                                 WriteCountingLayerManifest(layer_path, "counting_malformed", "\"xrEndFrame\"");
+        for (uint32_t layer = 0; layer < deep_layer_count; ++layer) {
+            deep_layers.push_back("counting_deep_" + std::to_string(layer));
+            bool listed = (1 == layer || deep_layer_count - 1 == layer);
+            manifests_written = manifests_written && WriteCountingLayerManifest(layer_path, deep_layers.back(),
+                                                                                listed ? "[ \"xrStringToPath\" ]"
+                                                                                       : "[ \"xrEndFrame\" ]");
+        }
+        if (!manifests_written) {
+            std::cout << "FAILED to write layer manifests!" << std::endl;
+            throw - 1;
+        }
+
+        counting_layer_library = LoaderPlatformLibraryOpen(COUNTING_LAYER_LIBRARY);
+        if (nullptr == counting_layer_library) {
+            std::cout << "FAILED to open " << COUNTING_LAYER_LIBRARY << "!" << std::endl;
+            throw - 1;
+        }
+        PFN_CountingLayerGetCallCount get_call_count = reinterpret_cast<PFN_CountingLayerGetCallCount>(
+            LoaderPlatformLibraryGetProcAddr(counting_layer_library, "CountingLayerGetCallCount"));
+        PFN_CountingLayerResetCallCounts reset_call_counts = reinterpret_cast<PFN_CountingLayerResetCallCounts>(
+            LoaderPlatformLibraryGetProcAddr(counting_layer_library, "CountingLayerResetCallCounts"));
+        if (nullptr == get_call_count || nullptr == reset_call_counts) {
+            std::cout << "FAILED to find the counting layer's call counts!" << std::endl;
+            throw - 1;
+        }
+
+        reset_call_counts();
+        TEST_EQUAL(CallThroughCountingLayers({"counting_unlisted", "counting_listed", "counting_no_list"}), true,
+                   "Calling through layers with and without lists")
+        TEST_EQUAL(get_call_count("XR_APILAYER_LUNARG_counting_unlisted", "xrStringToPath"), 0U,
+                   "Layer with a list skipped for a command it doesn't list")
+        TEST_EQUAL(get_call_count("XR_APILAYER_LUNARG_counting_listed", "xrStringToPath"), 1U,
+                   "Layer with a list called for a command it lists")
+        TEST_EQUAL(get_call_count("XR_APILAYER_LUNARG_counting_no_list", "xrStringToPath"), 1U,
+                   "Layer without a list called for every command")
+        TEST_EQUAL(get_call_count("XR_APILAYER_LUNARG_counting_unlisted", "xrDestroyInstance"), 1U,
+                   "Layer with a list called for xrDestroyInstance without listing it")
+        TEST_EQUAL(get_call_count("XR_APILAYER_LUNARG_counting_listed", "xrDestroyInstance"), 1U,
+                   "Layer listing other commands called for xrDestroyInstance")
+        TEST_EQUAL(get_call_count("XR_APILAYER_LUNARG_counting_no_list", "xrDestroyInstance"), 1U,
+                   "Layer without a list called for xrDestroyInstance")
+
+        reset_call_counts();
+        TEST_EQUAL(CallThroughCountingLayers({"counting_malformed", "counting_listed"}), true,
+                   "Calling through a layer with a malformed list")
+        TEST_EQUAL(get_call_count("XR_APILAYER_LUNARG_counting_malformed", "xrStringToPath"), 1U,
+                   "Layer whose list isn't an array called for every command")
+        TEST_EQUAL(get_call_count("XR_APILAYER_LUNARG_counting_listed", "xrStringToPath"), 1U,
+                   "Layer below a malformed list called for a command it lists")
+
+        reset_call_counts();
+        TEST_EQUAL(CallThroughCountingLayers(deep_layers), true, "Calling through " + std::to_string(deep_layer_count) + " layers")
+        uint32_t deep_string_to_path_mismatches = 0;
+        uint32_t deep_destroy_instance_mismatches = 0;
+        for (uint32_t layer = 0; layer < deep_layer_count; ++layer) {
+            std::string layer_name = "XR_APILAYER_LUNARG_" + deep_layers[layer];
+            uint32_t expected_calls = (1 == layer || deep_layer_count - 1 == layer) ? 1 : 0;
+            if (get_call_count(layer_name.c_str(), "xrStringToPath") != expected_calls) {
+                deep_string_to_path_mismatches++;
+            }
+            if (get_call_count(layer_name.c_str(), "xrDestroyInstance") != 1) {
+                deep_destroy_instance_mismatches++;
+            }
+        }
+        TEST_EQUAL(deep_string_to_path_mismatches, 0U, "Only the layers listing it called for xrStringToPath in a deep chain")
+        TEST_EQUAL(deep_destroy_instance_mismatches, 0U, "Every layer called for xrDestroyInstance in a deep chain")
+    } catch (...) {
+        TEST_FAIL("Exception triggered during test, automatic failure")
+    }
+
+    // Cleanup
+    if (nullptr != counting_layer_library) {
+        LoaderPlatformLibraryClose(counting_layer_library);
+    }
+    CleanupEnvironmentVariables();
+
+    // Output results for this test
+    TEST_REPORT(TestInterceptedFunctions)
+}
+
 const char test_function_name[] = "MyTestFunctionName";
 static char message_id[64];
 static uint64_t object_handle;
@@ -1137,7 +1847,6 @@ DEFINE_TEST(TestDebugUtils) {
             std::string enabled_graphics_extension_name;
             const char* enabled_extension_array[2];
             instance_create_info.type = XR_TYPE_INSTANCE_CREATE_INFO;
-            instance_create_info.enabledExtensionCount = 2;
             instance_create_info.enabledExtensionNames = enabled_extension_array;
 
             enabled_extension_array[0] = debug_utils_extension_name;
@@ -1162,6 +1871,8 @@ DEFINE_TEST(TestDebugUtils) {
                 instance_create_info.enabledExtensionNames = enabled_extension_array;
             }
 #endif  // XR_USE_GRAPHICS_API_D3D11
+            // A runtime offering debug utils may not offer any of the graphics APIs above
+            instance_create_info.enabledExtensionCount = enabled_graphics_extension_name.empty() ? 1 : 2;
 
             // Create an instance with the appropriate data for the debug utils messenger
             XrDebugUtilsMessengerCreateInfoEXT debug_utils_messenger_create_info = {};
@@ -1985,9 +2696,21 @@ int main(int argc, char* argv[]) {
 
     TestEnumLayers(total_tests, total_passed, total_skipped, total_failed);
     TestEnumInstanceExtensions(total_tests, total_passed, total_skipped, total_failed);
+    TestMergeExtensionProperties(total_tests, total_passed, total_skipped, total_failed);
     TestCreateDestroyInstance(total_tests, total_passed, total_skipped, total_failed);
+    TestAllocationCallbacks(total_tests, total_passed, total_skipped, total_failed);
+    TestAllocationCallbacksTwoInstances(total_tests, total_passed, total_skipped, total_failed);
+    TestMemoryFootprint(total_tests, total_passed, total_skipped, total_failed);
+#if defined(LOADER_STATISTICS)
+    TestLoaderStatistics(total_tests, total_passed, total_skipped, total_failed);
+#endif  // LOADER_STATISTICS
     TestGetSystem(total_tests, total_passed, total_skipped, total_failed);
     TestCreateDestroySession(total_tests, total_passed, total_skipped, total_failed);
+    // A loader with the runtime linked into it can't be pointed at the mock runtime
+#if !defined(LOADER_STATIC_RUNTIME)
+    TestMockRuntimeFrameLoop(total_tests, total_passed, total_skipped, total_failed);
+#endif  // !LOADER_STATIC_RUNTIME
+    TestInterceptedFunctions(total_tests, total_passed, total_skipped, total_failed);
     TestDebugUtils(total_tests, total_passed, total_skipped, total_failed);
 
 #if FILTER_OUT_LOADER_ERRORS == 1
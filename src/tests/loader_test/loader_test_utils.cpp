@@ -17,20 +17,27 @@
 // Author: Mark Young <marky@lunarg.com>
 //
 
-#include "gfxwrapper_opengl.h"  // for GL Extensions
 #include "loader_test_utils.hpp"
 
-#define XR_USE_GRAPHICS_API_OPENGL 1
 #include "xr_dependencies.h"
 #include <openxr/openxr.h>
+#include <openxr/openxr_loader.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 
+// The loader only sees a change to the environment once it re-reads its snapshot of it.
+static bool RefreshLoaderEnvironment(bool changed) {
+    if (changed) {
+        xrLoaderRefreshEnvironment();
+    }
+    return changed;
+}
+
 #if defined(XR_OS_WINDOWS)
 
 bool LoaderTestSetEnvironmentVariable(const std::string &variable, const std::string &value) {
-    return TRUE == SetEnvironmentVariable(variable.c_str(), value.c_str());
+    return RefreshLoaderEnvironment(TRUE == SetEnvironmentVariable(variable.c_str(), value.c_str()));
 }
 
 bool LoaderTestGetEnvironmentVariable(const std::string &variable, std::string &value) {
@@ -45,16 +52,13 @@ bool LoaderTestGetEnvironmentVariable(const std::string &variable, std::string &
 }
 
 bool LoaderTestUnsetEnvironmentVariable(const std::string &variable) {
-    return TRUE == SetEnvironmentVariable(variable.c_str(), "");
+    return RefreshLoaderEnvironment(TRUE == SetEnvironmentVariable(variable.c_str(), ""));
 }
 
 #elif defined(XR_OS_LINUX)
 
 bool LoaderTestSetEnvironmentVariable(const std::string &variable, const std::string &value) {
-    if (0 == setenv(variable.c_str(), value.c_str(), 1)) {
-        return true;
-    }
-    return false;
+    return RefreshLoaderEnvironment(0 == setenv(variable.c_str(), value.c_str(), 1));
 }
 
 bool LoaderTestGetEnvironmentVariable(const std::string &variable, std::string &value) {
@@ -67,19 +71,13 @@ bool LoaderTestGetEnvironmentVariable(const std::string &variable, std::string &
 }
 
 bool LoaderTestUnsetEnvironmentVariable(const std::string &variable) {
-    if (0 == unsetenv(variable.c_str())) {
-        return true;
-    }
-    return false;
+    return RefreshLoaderEnvironment(0 == unsetenv(variable.c_str()));
 }
 
 #elif defined(XR_OS_APPLE)
 
 bool LoaderTestSetEnvironmentVariable(const std::string &variable, const std::string &value) {
-    if (0 == setenv(variable.c_str(), value.c_str(), 1)) {
-        return true;
-    }
-    return false;
+    return RefreshLoaderEnvironment(0 == setenv(variable.c_str(), value.c_str(), 1));
 }
 
 bool LoaderTestGetEnvironmentVariable(const std::string &variable, std::string &value) {
@@ -92,10 +90,7 @@ bool LoaderTestGetEnvironmentVariable(const std::string &variable, std::string &
 }
 
 bool LoaderTestUnsetEnvironmentVariable(const std::string &variable) {
-    if (0 == unsetenv(variable.c_str())) {
-        return true;
-    }
-    return false;
+    return RefreshLoaderEnvironment(0 == unsetenv(variable.c_str()));
 }
 
 #else
@@ -0,0 +1,212 @@
+// Copyright (c) 2019 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Counting API layer for the loader tests.
+//
+// Forwards every command to the next layer or the runtime, and counts the calls it gets to
+// xrStringToPath and xrDestroyInstance, so that loader_test can check which layers the loader
+// routes a command through.  Like the pass-through layer, the library can back several layers at
+// once, each layer name negotiated getting a slot of its own, so that it can be stacked deeper than
+// the loader resolves chain positions for.  Each slot follows one instance at a time.
+
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+
+#include "loader_interfaces.h"
+#include "api_layer_slots.hpp"
+
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define LAYER_EXPORT __attribute__((visibility("default")))
+#elif defined(__SUNPRO_C) && (__SUNPRO_C >= 0x590)
+#define LAYER_EXPORT __attribute__((visibility("default")))
+#else
+#define LAYER_EXPORT
+#endif
+
+#define COUNTING_LAYER_MAX_SLOTS 32
+
+struct CountingLayerSlot {
+    PFN_xrGetInstanceProcAddr next_get_instance_proc_addr = nullptr;
+    PFN_xrDestroyInstance next_destroy_instance = nullptr;
+    PFN_xrStringToPath next_string_to_path = nullptr;
+    uint32_t destroy_instance_calls = 0;
+    uint32_t string_to_path_calls = 0;
+};
+
+template <uint32_t Slot>
+XrResult CountingLayerXrCreateApiLayerInstance(const XrInstanceCreateInfo *info, const struct XrApiLayerCreateInfo *apiLayerInfo,
+                                               XrInstance *instance);
+template <uint32_t Slot>
+XrResult CountingLayerXrGetInstanceProcAddr(XrInstance instance, const char *name, PFN_xrVoidFunction *function);
+
+template <uint32_t Slot>
+struct CountingLayerSlotCommands {
+    static PFN_xrGetInstanceProcAddr GetInstanceProcAddr() {
+        return reinterpret_cast<PFN_xrGetInstanceProcAddr>(CountingLayerXrGetInstanceProcAddr<Slot>);
+    }
+    static PFN_xrCreateApiLayerInstance CreateApiLayerInstance() {
+        return reinterpret_cast<PFN_xrCreateApiLayerInstance>(CountingLayerXrCreateApiLayerInstance<Slot>);
+    }
+};
+
+static ApiLayerSlots<CountingLayerSlotCommands, COUNTING_LAYER_MAX_SLOTS> g_layer_slots;
+
+// Chain and counts for each slot
+static std::mutex g_slot_mutex;
+static CountingLayerSlot g_slots[COUNTING_LAYER_MAX_SLOTS];
+
+template <uint32_t Slot>
+XrResult CountingLayerXrCreateApiLayerInstance(const XrInstanceCreateInfo *info, const struct XrApiLayerCreateInfo *apiLayerInfo,
+                                               XrInstance *instance) {
+    std::string layer_name = g_layer_slots.LayerName(Slot);
+
+    if (nullptr == apiLayerInfo || XR_LOADER_INTERFACE_STRUCT_API_LAYER_CREATE_INFO != apiLayerInfo->structType ||
+        nullptr == apiLayerInfo->nextInfo || XR_LOADER_INTERFACE_STRUCT_API_LAYER_NEXT_INFO != apiLayerInfo->nextInfo->structType ||
+        layer_name != apiLayerInfo->nextInfo->layerName || nullptr == apiLayerInfo->nextInfo->nextGetInstanceProcAddr ||
+        nullptr == apiLayerInfo->nextInfo->nextCreateApiLayerInstance) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // Move the next info up by one so that the next layer gets its own
+    XrApiLayerCreateInfo new_api_layer_info = *apiLayerInfo;
+    new_api_layer_info.nextInfo = apiLayerInfo->nextInfo->next;
+    PFN_xrGetInstanceProcAddr next_get_instance_proc_addr = apiLayerInfo->nextInfo->nextGetInstanceProcAddr;
+
+    XrResult result = apiLayerInfo->nextInfo->nextCreateApiLayerInstance(info, &new_api_layer_info, instance);
+    if (XR_FAILED(result)) {
+        return result;
+    }
+
+    PFN_xrDestroyInstance next_destroy_instance = nullptr;
+    PFN_xrStringToPath next_string_to_path = nullptr;
+    next_get_instance_proc_addr(*instance, "xrDestroyInstance", reinterpret_cast<PFN_xrVoidFunction *>(&next_destroy_instance));
+    next_get_instance_proc_addr(*instance, "xrStringToPath", reinterpret_cast<PFN_xrVoidFunction *>(&next_string_to_path));
+
+    std::unique_lock<std::mutex> slot_lock(g_slot_mutex);
+    g_slots[Slot].next_get_instance_proc_addr = next_get_instance_proc_addr;
+    g_slots[Slot].next_destroy_instance = next_destroy_instance;
+    g_slots[Slot].next_string_to_path = next_string_to_path;
+    return result;
+}
+
+template <uint32_t Slot>
+XrResult CountingLayerXrDestroyInstance(XrInstance instance) {
+    std::unique_lock<std::mutex> slot_lock(g_slot_mutex);
+    ++g_slots[Slot].destroy_instance_calls;
+    PFN_xrDestroyInstance next_destroy_instance = g_slots[Slot].next_destroy_instance;
+    g_slots[Slot].next_get_instance_proc_addr = nullptr;
+    g_slots[Slot].next_destroy_instance = nullptr;
+    g_slots[Slot].next_string_to_path = nullptr;
+    slot_lock.unlock();
+    return (nullptr != next_destroy_instance) ? next_destroy_instance(instance) : XR_ERROR_HANDLE_INVALID;
+}
+
+template <uint32_t Slot>
+XrResult CountingLayerXrStringToPath(XrInstance instance, const char *pathString, XrPath *path) {
+    std::unique_lock<std::mutex> slot_lock(g_slot_mutex);
+    ++g_slots[Slot].string_to_path_calls;
+    PFN_xrStringToPath next_string_to_path = g_slots[Slot].next_string_to_path;
+    slot_lock.unlock();
+    return (nullptr != next_string_to_path) ? next_string_to_path(instance, pathString, path) : XR_ERROR_FUNCTION_UNSUPPORTED;
+}
+
+template <uint32_t Slot>
+XrResult CountingLayerXrGetInstanceProcAddr(XrInstance instance, const char *name, PFN_xrVoidFunction *function) {
+    if (0 == strcmp(name, "xrGetInstanceProcAddr")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(CountingLayerXrGetInstanceProcAddr<Slot>);
+    } else if (0 == strcmp(name, "xrDestroyInstance")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(CountingLayerXrDestroyInstance<Slot>);
+    } else if (0 == strcmp(name, "xrStringToPath")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(CountingLayerXrStringToPath<Slot>);
+    } else {
+        std::unique_lock<std::mutex> slot_lock(g_slot_mutex);
+        PFN_xrGetInstanceProcAddr next_get_instance_proc_addr = g_slots[Slot].next_get_instance_proc_addr;
+        slot_lock.unlock();
+        if (nullptr == next_get_instance_proc_addr) {
+            *function = nullptr;
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+        return next_get_instance_proc_addr(instance, name, function);
+    }
+    return XR_SUCCESS;
+}
+
+extern "C" {
+
+LAYER_EXPORT XrResult xrNegotiateLoaderApiLayerInterface(const XrNegotiateLoaderInfo *loaderInfo, const char *apiLayerName,
+                                                         XrNegotiateApiLayerRequest *apiLayerRequest) {
+    if (nullptr == loaderInfo || nullptr == apiLayerName || nullptr == apiLayerRequest ||
+        loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO ||
+        loaderInfo->structVersion != XR_LOADER_INFO_STRUCT_VERSION || loaderInfo->structSize != sizeof(XrNegotiateLoaderInfo) ||
+        apiLayerRequest->structType != XR_LOADER_INTERFACE_STRUCT_API_LAYER_REQUEST ||
+        apiLayerRequest->structVersion != XR_API_LAYER_INFO_STRUCT_VERSION ||
+        apiLayerRequest->structSize != sizeof(XrNegotiateApiLayerRequest) ||
+        loaderInfo->minInterfaceVersion > XR_CURRENT_LOADER_API_LAYER_VERSION ||
+        loaderInfo->maxInterfaceVersion < XR_CURRENT_LOADER_API_LAYER_VERSION ||
+        loaderInfo->maxXrVersion < XR_CURRENT_API_VERSION || loaderInfo->minXrVersion > XR_CURRENT_API_VERSION) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+
+    uint32_t slot = 0;
+    try {
+        if (!g_layer_slots.AcquireSlot(apiLayerName, slot)) {
+            return XR_ERROR_INITIALIZATION_FAILED;
+        }
+    } catch (...) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+
+    apiLayerRequest->layerInterfaceVersion = XR_CURRENT_LOADER_API_LAYER_VERSION;
+    apiLayerRequest->layerXrVersion = XR_CURRENT_API_VERSION;
+    apiLayerRequest->getInstanceProcAddr = g_layer_slots.EntryPoints(slot).get_instance_proc_addr;
+    apiLayerRequest->createApiLayerInstance = g_layer_slots.EntryPoints(slot).create_api_layer_instance;
+
+    return XR_SUCCESS;
+}
+
+// Calls the named layer got to command, which is either "xrStringToPath" or "xrDestroyInstance", since the
+// counts were last reset.  Layers that were never negotiated got none.
+LAYER_EXPORT uint32_t CountingLayerGetCallCount(const char *layerName, const char *command) {
+    uint32_t slot = 0;
+    try {
+        if (!g_layer_slots.FindSlot(layerName, slot)) {
+            return 0;
+        }
+    } catch (...) {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> slot_lock(g_slot_mutex);
+    if (0 == strcmp(command, "xrStringToPath")) {
+        return g_slots[slot].string_to_path_calls;
+    } else if (0 == strcmp(command, "xrDestroyInstance")) {
+        return g_slots[slot].destroy_instance_calls;
+    }
+    return 0;
+}
+
+LAYER_EXPORT void CountingLayerResetCallCounts() {
+    std::unique_lock<std::mutex> slot_lock(g_slot_mutex);
+    for (uint32_t slot = 0; slot < COUNTING_LAYER_MAX_SLOTS; ++slot) {
+        g_slots[slot].string_to_path_calls = 0;
+        g_slots[slot].destroy_instance_calls = 0;
+    }
+}
+
+}  // extern "C"
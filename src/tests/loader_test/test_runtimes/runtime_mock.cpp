@@ -0,0 +1,985 @@
+// Copyright (c) 2017-2019 The Khronos Group Inc.
+// Copyright (c) 2017-2019 Valve Corporation
+// Copyright (c) 2017-2019 LunarG, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// A headless runtime that needs nothing but a CPU.  It implements enough of the API for an application to
+// run its whole frame loop: a single head mounted system with mono and stereo views, session state changes
+// reported through xrPollEvent, reference and action spaces following synthetic poses, swapchains whose
+// images are plain CPU memory, and xrWaitFrame paced to a configurable display period.  Nothing is ever
+// displayed and no input is ever active.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "xr_dependencies.h"
+#include <openxr/openxr.h>
+
+#include "loader_interfaces.h"
+#include "xr_generated_utilities.h"
+
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define RUNTIME_EXPORT __attribute__((visibility("default")))
+#elif defined(__SUNPRO_C) && (__SUNPRO_C >= 0x590)
+#define RUNTIME_EXPORT __attribute__((visibility("default")))
+#else
+#define RUNTIME_EXPORT
+#endif
+
+// Time between two displayed frames, in nanoseconds.  Defaults to 90Hz, "0" lets xrWaitFrame return immediately.
+#define MOCK_RUNTIME_DISPLAY_PERIOD_ENV_VAR "XR_MOCK_RUNTIME_DISPLAY_PERIOD_NS"
+// Number of frames after which a running session is asked to stop, so that applications exit on their own.
+// Unset or "0" never stops it.
+#define MOCK_RUNTIME_FRAME_LIMIT_ENV_VAR "XR_MOCK_RUNTIME_FRAME_LIMIT"
+
+namespace {
+
+const XrSystemId kMockSystemId = 1;
+const int64_t kDefaultDisplayPeriodNs = 11111111;
+const uint32_t kRecommendedImageSize = 1024;
+const uint32_t kMaxImageSize = 4096;
+const uint32_t kMaxLayerCount = 16;
+const uint32_t kSwapchainImageCount = 3;
+const uint32_t kBytesPerPixel = 4;
+const float kEyeHeight = 1.6f;
+const float kHalfIpd = 0.032f;
+// GL_RGBA8 and GL_SRGB8_ALPHA8, both stored as 4 bytes per pixel.
+const int64_t kSwapchainFormats[] = {0x8058, 0x8C43};
+
+uint64_t GetEnvNumber(const char* name, uint64_t default_value) {
+    const char* value = std::getenv(name);
+    if (nullptr == value || 0 == strcmp(value, "")) {
+        return default_value;
+    }
+    return std::strtoull(value, nullptr, 10);
+}
+
+XrTime MockNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Pose math, all poses are relative to the stage.
+
+XrQuaternionf Multiply(const XrQuaternionf& a, const XrQuaternionf& b) {
+    XrQuaternionf result;
+    result.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+    result.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+    result.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+    result.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+    return result;
+}
+
+XrVector3f Rotate(const XrQuaternionf& q, const XrVector3f& v) {
+    XrQuaternionf p = {v.x, v.y, v.z, 0.0f};
+    XrQuaternionf conjugate = {-q.x, -q.y, -q.z, q.w};
+    XrQuaternionf rotated = Multiply(Multiply(q, p), conjugate);
+    XrVector3f result = {rotated.x, rotated.y, rotated.z};
+    return result;
+}
+
+// Apply b, then a
+XrPosef Multiply(const XrPosef& a, const XrPosef& b) {
+    XrPosef result;
+    result.orientation = Multiply(a.orientation, b.orientation);
+    XrVector3f offset = Rotate(a.orientation, b.position);
+    result.position.x = a.position.x + offset.x;
+    result.position.y = a.position.y + offset.y;
+    result.position.z = a.position.z + offset.z;
+    return result;
+}
+
+XrPosef Invert(const XrPosef& pose) {
+    XrPosef result;
+    result.orientation = {-pose.orientation.x, -pose.orientation.y, -pose.orientation.z, pose.orientation.w};
+    XrVector3f position = Rotate(result.orientation, pose.position);
+    result.position = {-position.x, -position.y, -position.z};
+    return result;
+}
+
+XrPosef MakePose(float yaw, float x, float y, float z) {
+    XrPosef result;
+    result.orientation = {0.0f, std::sin(yaw / 2.0f), 0.0f, std::cos(yaw / 2.0f)};
+    result.position = {x, y, z};
+    return result;
+}
+
+// The head slowly looks around and sways from side to side.
+XrPosef HeadPose(XrTime time) {
+    double seconds = static_cast<double>(time) / 1e9;
+    float yaw = static_cast<float>(0.5 * std::sin(seconds * 0.5));
+    float sway = static_cast<float>(0.1 * std::sin(seconds));
+    return MakePose(yaw, sway, kEyeHeight, 0.0f);
+}
+
+// Hands are held in front of the head, the left one for subaction paths ending in "left".
+XrPosef HandPose(XrTime time, bool left) {
+    return Multiply(HeadPose(time), MakePose(0.0f, left ? -0.2f : 0.2f, -0.3f, -0.4f));
+}
+
+struct MockInstance;
+struct MockSession;
+
+struct MockSpace {
+    MockSession* session;
+    bool is_action_space;
+    bool left_hand;
+    XrReferenceSpaceType reference_space_type;
+    XrPosef pose_in_space;
+};
+
+struct MockSwapchain {
+    MockSession* session;
+    std::vector<std::vector<uint8_t>> images;
+    // Acquired images in the order they were acquired, the first of which may be waited for
+    std::deque<uint32_t> acquired;
+    uint32_t next_image = 0;
+    bool waited = false;
+};
+
+struct MockActionSet {
+    MockSession* session;
+};
+
+struct MockAction {
+    MockActionSet* action_set;
+    XrActionType type;
+};
+
+struct MockSession {
+    MockInstance* instance;
+    std::mutex mutex;
+    XrSessionState state = XR_SESSION_STATE_UNKNOWN;
+    bool running = false;
+    XrViewConfigurationType view_configuration = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+    int64_t display_period_ns = kDefaultDisplayPeriodNs;
+    uint64_t frame_limit = 0;
+    XrTime last_vsync = 0;
+    uint64_t frames_waited = 0;
+    uint64_t frames_begun = 0;
+    uint64_t frames_ended = 0;
+    bool frame_in_progress = false;
+    std::unordered_map<MockSpace*, std::unique_ptr<MockSpace>> spaces;
+    std::unordered_map<MockSwapchain*, std::unique_ptr<MockSwapchain>> swapchains;
+    std::unordered_map<MockActionSet*, std::unique_ptr<MockActionSet>> action_sets;
+    std::unordered_map<MockAction*, std::unique_ptr<MockAction>> actions;
+};
+
+struct MockInstance {
+    std::mutex mutex;
+    std::deque<XrEventDataBuffer> events;
+    std::vector<std::string> paths;
+    std::unordered_map<MockSession*, std::unique_ptr<MockSession>> sessions;
+};
+
+template <typename T>
+T* FromHandle(uint64_t handle) {
+    return reinterpret_cast<T*>(static_cast<uintptr_t>(handle));
+}
+
+template <typename H, typename T>
+H ToHandle(T* object) {
+    return reinterpret_cast<H>(reinterpret_cast<uintptr_t>(object));
+}
+
+#define MOCK_FROM_HANDLE(type, handle) FromHandle<type>(reinterpret_cast<uint64_t>(handle))
+
+template <typename T>
+XrResult FillArray(uint32_t capacity_input, uint32_t* count_output, T* output, const T* values, uint32_t count) {
+    if (nullptr == count_output) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *count_output = count;
+    if (0 == capacity_input) {
+        return XR_SUCCESS;
+    }
+    if (capacity_input < count) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        output[i] = values[i];
+    }
+    return XR_SUCCESS;
+}
+
+XrResult FillString(uint32_t capacity_input, uint32_t* count_output, char* buffer, const std::string& value) {
+    if (nullptr == count_output) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *count_output = static_cast<uint32_t>(value.size() + 1);
+    if (0 == capacity_input) {
+        return XR_SUCCESS;
+    }
+    if (capacity_input < *count_output) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    memcpy(buffer, value.c_str(), *count_output);
+    return XR_SUCCESS;
+}
+
+// Must be called with the session's mutex held
+void QueueSessionState(MockSession* session, XrSessionState state) {
+    session->state = state;
+    XrEventDataBuffer buffer = {};
+    XrEventDataSessionStateChanged* event = reinterpret_cast<XrEventDataSessionStateChanged*>(&buffer);
+    event->type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
+    event->session = ToHandle<XrSession>(session);
+    event->state = state;
+    event->time = MockNow();
+    std::unique_lock<std::mutex> instance_lock(session->instance->mutex);
+    session->instance->events.push_back(buffer);
+}
+
+uint32_t ViewCount(XrViewConfigurationType view_configuration) {
+    return XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO == view_configuration ? 1 : 2;
+}
+
+// Pose of a space relative to the stage at the given time
+XrPosef SpacePose(const MockSpace* space, XrTime time) {
+    XrPosef origin = MakePose(0.0f, 0.0f, 0.0f, 0.0f);
+    if (space->is_action_space) {
+        origin = HandPose(time, space->left_hand);
+    } else if (XR_REFERENCE_SPACE_TYPE_VIEW == space->reference_space_type) {
+        origin = HeadPose(time);
+    } else if (XR_REFERENCE_SPACE_TYPE_LOCAL == space->reference_space_type) {
+        origin = MakePose(0.0f, 0.0f, kEyeHeight, 0.0f);
+    }
+    return Multiply(origin, space->pose_in_space);
+}
+
+}  // namespace
+
+extern "C" {
+
+XrResult MockXrEnumerateInstanceExtensionProperties(const char* layerName, uint32_t propertyCapacityInput,
+                                                    uint32_t* propertyCountOutput, XrExtensionProperties* properties) {
+    if (nullptr != layerName) {
+        return XR_ERROR_API_LAYER_NOT_PRESENT;
+    }
+    if (nullptr == propertyCountOutput) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *propertyCountOutput = 1;
+    if (0 == propertyCapacityInput) {
+        return XR_SUCCESS;
+    }
+    strcpy(properties[0].extensionName, XR_KHR_HEADLESS_EXTENSION_NAME);
+    properties[0].specVersion = XR_KHR_headless_SPEC_VERSION;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrCreateInstance(const XrInstanceCreateInfo* info, XrInstance* instance) {
+    if (nullptr == info || nullptr == instance) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    for (uint32_t ext = 0; ext < info->enabledExtensionCount; ++ext) {
+        if (0 != strcmp(info->enabledExtensionNames[ext], XR_KHR_HEADLESS_EXTENSION_NAME)) {
+            return XR_ERROR_EXTENSION_NOT_PRESENT;
+        }
+    }
+    MockInstance* mock_instance = new MockInstance;
+    // Path 0 is XR_NULL_PATH
+    mock_instance->paths.push_back("");
+    *instance = ToHandle<XrInstance>(mock_instance);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrDestroyInstance(XrInstance instance) {
+    delete MOCK_FROM_HANDLE(MockInstance, instance);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetInstanceProperties(XrInstance instance, XrInstanceProperties* instanceProperties) {
+    instanceProperties->runtimeVersion = XR_MAKE_VERSION(0, 90, 0);
+    strcpy(instanceProperties->runtimeName, "Mock Runtime");
+    return XR_SUCCESS;
+}
+
+XrResult MockXrPollEvent(XrInstance instance, XrEventDataBuffer* eventData) {
+    MockInstance* mock_instance = MOCK_FROM_HANDLE(MockInstance, instance);
+    std::unique_lock<std::mutex> instance_lock(mock_instance->mutex);
+    if (mock_instance->events.empty()) {
+        return XR_EVENT_UNAVAILABLE;
+    }
+    *eventData = mock_instance->events.front();
+    mock_instance->events.pop_front();
+    return XR_SUCCESS;
+}
+
+XrResult MockXrResultToString(XrInstance instance, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE]) {
+    return GeneratedXrUtilitiesResultToString(value, buffer);
+}
+
+XrResult MockXrStructureTypeToString(XrInstance instance, XrStructureType value, char buffer[XR_MAX_STRUCTURE_NAME_SIZE]) {
+    return GeneratedXrUtilitiesStructureTypeToString(value, buffer);
+}
+
+XrResult MockXrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId) {
+    if (XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY != getInfo->formFactor) {
+        return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+    }
+    *systemId = kMockSystemId;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetSystemProperties(XrInstance instance, XrSystemId systemId, XrSystemProperties* properties) {
+    if (kMockSystemId != systemId) {
+        return XR_ERROR_SYSTEM_INVALID;
+    }
+    properties->systemId = systemId;
+    properties->vendorId = 0;
+    strcpy(properties->systemName, "Mock Runtime System");
+    properties->graphicsProperties.maxSwapchainImageHeight = kMaxImageSize;
+    properties->graphicsProperties.maxSwapchainImageWidth = kMaxImageSize;
+    properties->graphicsProperties.maxViewCount = 2;
+    properties->graphicsProperties.maxLayerCount = kMaxLayerCount;
+    properties->trackingProperties.orientationTracking = XR_TRUE;
+    properties->trackingProperties.positionTracking = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrEnumerateEnvironmentBlendModes(XrInstance instance, XrSystemId systemId, uint32_t environmentBlendModeCapacityInput,
+                                              uint32_t* environmentBlendModeCountOutput,
+                                              XrEnvironmentBlendMode* environmentBlendModes) {
+    static const XrEnvironmentBlendMode blend_modes[] = {XR_ENVIRONMENT_BLEND_MODE_OPAQUE};
+    return FillArray(environmentBlendModeCapacityInput, environmentBlendModeCountOutput, environmentBlendModes, blend_modes, 1);
+}
+
+XrResult MockXrEnumerateViewConfigurations(XrInstance instance, XrSystemId systemId, uint32_t viewConfigurationTypeCapacityInput,
+                                           uint32_t* viewConfigurationTypeCountOutput,
+                                           XrViewConfigurationType* viewConfigurationTypes) {
+    static const XrViewConfigurationType view_configurations[] = {XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
+                                                                  XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO};
+    return FillArray(viewConfigurationTypeCapacityInput, viewConfigurationTypeCountOutput, viewConfigurationTypes,
+                     view_configurations, 2);
+}
+
+XrResult MockXrGetViewConfigurationProperties(XrInstance instance, XrSystemId systemId,
+                                              XrViewConfigurationType viewConfigurationType,
+                                              XrViewConfigurationProperties* configurationProperties) {
+    configurationProperties->viewConfigurationType = viewConfigurationType;
+    configurationProperties->fovMutable = XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrEnumerateViewConfigurationViews(XrInstance instance, XrSystemId systemId,
+                                               XrViewConfigurationType viewConfigurationType, uint32_t viewCapacityInput,
+                                               uint32_t* viewCountOutput, XrViewConfigurationView* views) {
+    XrViewConfigurationView view = {};
+    view.type = XR_TYPE_VIEW_CONFIGURATION_VIEW;
+    view.recommendedImageRectWidth = kRecommendedImageSize;
+    view.maxImageRectWidth = kMaxImageSize;
+    view.recommendedImageRectHeight = kRecommendedImageSize;
+    view.maxImageRectHeight = kMaxImageSize;
+    view.recommendedSwapchainSampleCount = 1;
+    view.maxSwapchainSampleCount = 1;
+    XrViewConfigurationView config_views[2] = {view, view};
+    return FillArray(viewCapacityInput, viewCountOutput, views, config_views, ViewCount(viewConfigurationType));
+}
+
+XrResult MockXrCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) {
+    if (kMockSystemId != createInfo->systemId) {
+        return XR_ERROR_SYSTEM_INVALID;
+    }
+    MockInstance* mock_instance = MOCK_FROM_HANDLE(MockInstance, instance);
+    std::unique_ptr<MockSession> mock_session(new MockSession);
+    mock_session->instance = mock_instance;
+    mock_session->display_period_ns =
+        static_cast<int64_t>(GetEnvNumber(MOCK_RUNTIME_DISPLAY_PERIOD_ENV_VAR, kDefaultDisplayPeriodNs));
+    mock_session->frame_limit = GetEnvNumber(MOCK_RUNTIME_FRAME_LIMIT_ENV_VAR, 0);
+    MockSession* new_session = mock_session.get();
+    {
+        std::unique_lock<std::mutex> instance_lock(mock_instance->mutex);
+        mock_instance->sessions[new_session] = std::move(mock_session);
+    }
+    std::unique_lock<std::mutex> session_lock(new_session->mutex);
+    QueueSessionState(new_session, XR_SESSION_STATE_IDLE);
+    QueueSessionState(new_session, XR_SESSION_STATE_READY);
+    *session = ToHandle<XrSession>(new_session);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrDestroySession(XrSession session) {
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    MockInstance* mock_instance = mock_session->instance;
+    std::unique_lock<std::mutex> instance_lock(mock_instance->mutex);
+    // Drop events about this session that were never polled
+    for (auto event = mock_instance->events.begin(); event != mock_instance->events.end();) {
+        if (XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED == event->type &&
+            reinterpret_cast<XrEventDataSessionStateChanged*>(&*event)->session == session) {
+            event = mock_instance->events.erase(event);
+        } else {
+            ++event;
+        }
+    }
+    mock_instance->sessions.erase(mock_session);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo) {
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    if (mock_session->running) {
+        return XR_ERROR_SESSION_RUNNING;
+    }
+    mock_session->running = true;
+    mock_session->view_configuration = beginInfo->primaryViewConfigurationType;
+    mock_session->last_vsync = MockNow();
+    mock_session->frames_waited = 0;
+    mock_session->frames_begun = 0;
+    mock_session->frames_ended = 0;
+    mock_session->frame_in_progress = false;
+    QueueSessionState(mock_session, XR_SESSION_STATE_RUNNING);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrEndSession(XrSession session) {
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    if (!mock_session->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    mock_session->running = false;
+    bool stopped_by_limit = (XR_SESSION_STATE_STOPPING == mock_session->state);
+    QueueSessionState(mock_session, XR_SESSION_STATE_IDLE);
+    // A session stopped because of the frame limit is over for good, others may be begun again
+    QueueSessionState(mock_session, stopped_by_limit ? XR_SESSION_STATE_EXITING : XR_SESSION_STATE_READY);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState) {
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    if (!mock_session->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    int64_t period = mock_session->display_period_ns;
+    XrTime now = MockNow();
+    XrTime vsync = now;
+    if (period > 0) {
+        // Wait for the next vsync, skipping any missed while the application was busy
+        vsync = mock_session->last_vsync + period;
+        if (vsync <= now) {
+            vsync = now + period - (now - mock_session->last_vsync) % period;
+        }
+    }
+    mock_session->last_vsync = vsync;
+    mock_session->frames_waited++;
+    session_lock.unlock();
+
+    if (vsync > now) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(vsync - now));
+    }
+    // The frame rendered now is shown one period after this vsync
+    frameState->predictedDisplayTime = vsync + period;
+    frameState->predictedDisplayPeriod = period;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo) {
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    if (!mock_session->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    if (mock_session->frames_begun >= mock_session->frames_waited) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    mock_session->frames_begun++;
+    if (mock_session->frame_in_progress) {
+        return XR_FRAME_DISCARDED;
+    }
+    mock_session->frame_in_progress = true;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    if (!mock_session->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    if (!mock_session->frame_in_progress) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    if (frameEndInfo->layerCount > kMaxLayerCount || XR_ENVIRONMENT_BLEND_MODE_OPAQUE != frameEndInfo->environmentBlendMode) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    for (uint32_t layer = 0; layer < frameEndInfo->layerCount; ++layer) {
+        if (XR_TYPE_COMPOSITION_LAYER_PROJECTION != frameEndInfo->layers[layer]->type) {
+            continue;
+        }
+        const XrCompositionLayerProjection* projection =
+            reinterpret_cast<const XrCompositionLayerProjection*>(frameEndInfo->layers[layer]);
+        if (ViewCount(mock_session->view_configuration) != projection->viewCount) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        for (uint32_t view = 0; view < projection->viewCount; ++view) {
+            MockSwapchain* swapchain = MOCK_FROM_HANDLE(MockSwapchain, projection->views[view].subImage.swapchain);
+            if (0 == mock_session->swapchains.count(swapchain)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+        }
+    }
+    mock_session->frame_in_progress = false;
+    mock_session->frames_ended++;
+
+    // The application becomes visible, and gets focus, once it has submitted its first frame.
+    if (1 == mock_session->frames_ended && XR_SESSION_STATE_RUNNING == mock_session->state) {
+        QueueSessionState(mock_session, XR_SESSION_STATE_VISIBLE);
+        QueueSessionState(mock_session, XR_SESSION_STATE_FOCUSED);
+    }
+    if (0 != mock_session->frame_limit && mock_session->frames_ended == mock_session->frame_limit) {
+        QueueSessionState(mock_session, XR_SESSION_STATE_STOPPING);
+    }
+    return XR_SUCCESS;
+}
+
+XrResult MockXrEnumerateReferenceSpaces(XrSession session, uint32_t spaceCapacityInput, uint32_t* spaceCountOutput,
+                                        XrReferenceSpaceType* spaces) {
+    static const XrReferenceSpaceType reference_spaces[] = {XR_REFERENCE_SPACE_TYPE_VIEW, XR_REFERENCE_SPACE_TYPE_LOCAL,
+                                                            XR_REFERENCE_SPACE_TYPE_STAGE};
+    return FillArray(spaceCapacityInput, spaceCountOutput, spaces, reference_spaces, 3);
+}
+
+XrResult MockXrCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateInfo* createInfo, XrSpace* space) {
+    if (XR_REFERENCE_SPACE_TYPE_VIEW != createInfo->referenceSpaceType &&
+        XR_REFERENCE_SPACE_TYPE_LOCAL != createInfo->referenceSpaceType &&
+        XR_REFERENCE_SPACE_TYPE_STAGE != createInfo->referenceSpaceType) {
+        return XR_ERROR_REFERENCE_SPACE_UNSUPPORTED;
+    }
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    std::unique_ptr<MockSpace> mock_space(new MockSpace);
+    mock_space->session = mock_session;
+    mock_space->is_action_space = false;
+    mock_space->left_hand = false;
+    mock_space->reference_space_type = createInfo->referenceSpaceType;
+    mock_space->pose_in_space = createInfo->poseInReferenceSpace;
+    *space = ToHandle<XrSpace>(mock_space.get());
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    mock_session->spaces[mock_space.get()] = std::move(mock_space);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetReferenceSpaceBoundsRect(XrSession session, XrReferenceSpaceType referenceSpaceType, XrExtent2Df* bounds) {
+    if (XR_REFERENCE_SPACE_TYPE_STAGE != referenceSpaceType) {
+        bounds->width = 0.0f;
+        bounds->height = 0.0f;
+        return XR_SPACE_BOUNDS_UNAVAILABLE;
+    }
+    bounds->width = 4.0f;
+    bounds->height = 4.0f;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceRelation* relation) {
+    const MockSpace* mock_space = MOCK_FROM_HANDLE(MockSpace, space);
+    const MockSpace* mock_base_space = MOCK_FROM_HANDLE(MockSpace, baseSpace);
+    relation->relationFlags = XR_SPACE_RELATION_ORIENTATION_VALID_BIT | XR_SPACE_RELATION_POSITION_VALID_BIT |
+                              XR_SPACE_RELATION_ORIENTATION_TRACKED_BIT | XR_SPACE_RELATION_POSITION_TRACKED_BIT;
+    relation->time = time;
+    relation->pose = Multiply(Invert(SpacePose(mock_base_space, time)), SpacePose(mock_space, time));
+    relation->linearVelocity = {0.0f, 0.0f, 0.0f};
+    relation->angularVelocity = {0.0f, 0.0f, 0.0f};
+    relation->linearAcceleration = {0.0f, 0.0f, 0.0f};
+    relation->angularAcceleration = {0.0f, 0.0f, 0.0f};
+    return XR_SUCCESS;
+}
+
+XrResult MockXrDestroySpace(XrSpace space) {
+    MockSpace* mock_space = MOCK_FROM_HANDLE(MockSpace, space);
+    MockSession* mock_session = mock_space->session;
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    mock_session->spaces.erase(mock_space);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrLocateViews(XrSession session, const XrViewLocateInfo* viewLocateInfo, XrViewState* viewState,
+                           uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrView* views) {
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    uint32_t view_count = ViewCount(mock_session->view_configuration);
+    *viewCountOutput = view_count;
+    if (0 == viewCapacityInput) {
+        return XR_SUCCESS;
+    }
+    if (viewCapacityInput < view_count) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    viewState->viewStateFlags = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT |
+                                XR_VIEW_STATE_ORIENTATION_TRACKED_BIT | XR_VIEW_STATE_POSITION_TRACKED_BIT;
+    const MockSpace* mock_space = MOCK_FROM_HANDLE(MockSpace, viewLocateInfo->space);
+    XrPosef head_in_space = Multiply(Invert(SpacePose(mock_space, viewLocateInfo->displayTime)), HeadPose(viewLocateInfo->displayTime));
+    for (uint32_t view = 0; view < view_count; ++view) {
+        float eye_offset = (1 == view_count) ? 0.0f : (0 == view ? -kHalfIpd : kHalfIpd);
+        views[view].pose = Multiply(head_in_space, MakePose(0.0f, eye_offset, 0.0f, 0.0f));
+        views[view].fov = {-0.785398f, 0.785398f, 0.785398f, -0.785398f};
+    }
+    return XR_SUCCESS;
+}
+
+XrResult MockXrEnumerateSwapchainFormats(XrSession session, uint32_t formatCapacityInput, uint32_t* formatCountOutput,
+                                         int64_t* formats) {
+    return FillArray(formatCapacityInput, formatCountOutput, formats, kSwapchainFormats, 2);
+}
+
+XrResult MockXrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain) {
+    if (kSwapchainFormats[0] != createInfo->format && kSwapchainFormats[1] != createInfo->format) {
+        return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+    }
+    if (0 == createInfo->width || 0 == createInfo->height || kMaxImageSize < createInfo->width ||
+        kMaxImageSize < createInfo->height) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    std::unique_ptr<MockSwapchain> mock_swapchain(new MockSwapchain);
+    mock_swapchain->session = mock_session;
+    size_t layers = static_cast<size_t>(createInfo->faceCount ? createInfo->faceCount : 1) *
+                    static_cast<size_t>(createInfo->arraySize ? createInfo->arraySize : 1);
+    size_t image_size = static_cast<size_t>(createInfo->width) * createInfo->height * kBytesPerPixel * layers;
+    mock_swapchain->images.resize(kSwapchainImageCount);
+    for (std::vector<uint8_t>& image : mock_swapchain->images) {
+        image.resize(image_size);
+    }
+    *swapchain = ToHandle<XrSwapchain>(mock_swapchain.get());
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    mock_session->swapchains[mock_swapchain.get()] = std::move(mock_swapchain);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrDestroySwapchain(XrSwapchain swapchain) {
+    MockSwapchain* mock_swapchain = MOCK_FROM_HANDLE(MockSwapchain, swapchain);
+    MockSession* mock_session = mock_swapchain->session;
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    mock_session->swapchains.erase(mock_swapchain);
+    return XR_SUCCESS;
+}
+
+// The images only live in the runtime's memory, so there's nothing to report beyond their count.
+XrResult MockXrEnumerateSwapchainImages(XrSwapchain swapchain, uint32_t imageCapacityInput, uint32_t* imageCountOutput,
+                                        XrSwapchainImageBaseHeader* images) {
+    MockSwapchain* mock_swapchain = MOCK_FROM_HANDLE(MockSwapchain, swapchain);
+    *imageCountOutput = static_cast<uint32_t>(mock_swapchain->images.size());
+    if (0 != imageCapacityInput && imageCapacityInput < *imageCountOutput) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    return XR_SUCCESS;
+}
+
+XrResult MockXrAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo* acquireInfo, uint32_t* index) {
+    MockSwapchain* mock_swapchain = MOCK_FROM_HANDLE(MockSwapchain, swapchain);
+    std::unique_lock<std::mutex> session_lock(mock_swapchain->session->mutex);
+    if (mock_swapchain->acquired.size() == mock_swapchain->images.size()) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    *index = mock_swapchain->next_image;
+    mock_swapchain->acquired.push_back(*index);
+    mock_swapchain->next_image = (mock_swapchain->next_image + 1) % static_cast<uint32_t>(mock_swapchain->images.size());
+    return XR_SUCCESS;
+}
+
+XrResult MockXrWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* waitInfo) {
+    MockSwapchain* mock_swapchain = MOCK_FROM_HANDLE(MockSwapchain, swapchain);
+    std::unique_lock<std::mutex> session_lock(mock_swapchain->session->mutex);
+    if (mock_swapchain->acquired.empty() || mock_swapchain->waited) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    mock_swapchain->waited = true;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo* releaseInfo) {
+    MockSwapchain* mock_swapchain = MOCK_FROM_HANDLE(MockSwapchain, swapchain);
+    std::unique_lock<std::mutex> session_lock(mock_swapchain->session->mutex);
+    if (!mock_swapchain->waited) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    mock_swapchain->acquired.pop_front();
+    mock_swapchain->waited = false;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrStringToPath(XrInstance instance, const char* pathString, XrPath* path) {
+    if (nullptr == pathString || '/' != pathString[0] || XR_MAX_PATH_LENGTH <= strlen(pathString)) {
+        return XR_ERROR_PATH_FORMAT_INVALID;
+    }
+    MockInstance* mock_instance = MOCK_FROM_HANDLE(MockInstance, instance);
+    std::unique_lock<std::mutex> instance_lock(mock_instance->mutex);
+    for (size_t existing = 1; existing < mock_instance->paths.size(); ++existing) {
+        if (mock_instance->paths[existing] == pathString) {
+            *path = existing;
+            return XR_SUCCESS;
+        }
+    }
+    *path = mock_instance->paths.size();
+    mock_instance->paths.push_back(pathString);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrPathToString(XrInstance instance, XrPath path, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput,
+                            char* buffer) {
+    MockInstance* mock_instance = MOCK_FROM_HANDLE(MockInstance, instance);
+    std::unique_lock<std::mutex> instance_lock(mock_instance->mutex);
+    if (XR_NULL_PATH == path || mock_instance->paths.size() <= path) {
+        return XR_ERROR_PATH_INVALID;
+    }
+    return FillString(bufferCapacityInput, bufferCountOutput, buffer, mock_instance->paths[static_cast<size_t>(path)]);
+}
+
+XrResult MockXrCreateActionSet(XrSession session, const XrActionSetCreateInfo* createInfo, XrActionSet* actionSet) {
+    MockSession* mock_session = MOCK_FROM_HANDLE(MockSession, session);
+    std::unique_ptr<MockActionSet> mock_action_set(new MockActionSet);
+    mock_action_set->session = mock_session;
+    *actionSet = ToHandle<XrActionSet>(mock_action_set.get());
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    mock_session->action_sets[mock_action_set.get()] = std::move(mock_action_set);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrDestroyActionSet(XrActionSet actionSet) {
+    MockActionSet* mock_action_set = MOCK_FROM_HANDLE(MockActionSet, actionSet);
+    MockSession* mock_session = mock_action_set->session;
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    for (auto action = mock_session->actions.begin(); action != mock_session->actions.end();) {
+        if (action->first->action_set == mock_action_set) {
+            action = mock_session->actions.erase(action);
+        } else {
+            ++action;
+        }
+    }
+    mock_session->action_sets.erase(mock_action_set);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrCreateAction(XrActionSet actionSet, const XrActionCreateInfo* createInfo, XrAction* action) {
+    MockActionSet* mock_action_set = MOCK_FROM_HANDLE(MockActionSet, actionSet);
+    MockSession* mock_session = mock_action_set->session;
+    std::unique_ptr<MockAction> mock_action(new MockAction);
+    mock_action->action_set = mock_action_set;
+    mock_action->type = createInfo->actionType;
+    *action = ToHandle<XrAction>(mock_action.get());
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    mock_session->actions[mock_action.get()] = std::move(mock_action);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrDestroyAction(XrAction action) {
+    MockAction* mock_action = MOCK_FROM_HANDLE(MockAction, action);
+    MockSession* mock_session = mock_action->action_set->session;
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    mock_session->actions.erase(mock_action);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrCreateActionSpace(XrAction action, const XrActionSpaceCreateInfo* createInfo, XrSpace* space) {
+    MockAction* mock_action = MOCK_FROM_HANDLE(MockAction, action);
+    MockSession* mock_session = mock_action->action_set->session;
+    std::unique_ptr<MockSpace> mock_space(new MockSpace);
+    mock_space->session = mock_session;
+    mock_space->is_action_space = true;
+    mock_space->left_hand = false;
+    mock_space->reference_space_type = XR_REFERENCE_SPACE_TYPE_STAGE;
+    mock_space->pose_in_space = createInfo->poseInActionSpace;
+    if (XR_NULL_PATH != createInfo->subactionPath) {
+        MockInstance* mock_instance = mock_session->instance;
+        std::unique_lock<std::mutex> instance_lock(mock_instance->mutex);
+        if (createInfo->subactionPath < mock_instance->paths.size()) {
+            const std::string& subaction_path = mock_instance->paths[static_cast<size_t>(createInfo->subactionPath)];
+            mock_space->left_hand = subaction_path.size() >= 4 && 0 == subaction_path.compare(subaction_path.size() - 4, 4, "left");
+        }
+    }
+    *space = ToHandle<XrSpace>(mock_space.get());
+    std::unique_lock<std::mutex> session_lock(mock_session->mutex);
+    mock_session->spaces[mock_space.get()] = std::move(mock_space);
+    return XR_SUCCESS;
+}
+
+XrResult MockXrSetInteractionProfileSuggestedBindings(XrSession session,
+                                                      const XrInteractionProfileSuggestedBinding* suggestedBindings) {
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetCurrentInteractionProfile(XrSession session, XrPath topLevelUserPath,
+                                            XrInteractionProfileInfo* interactionProfile) {
+    interactionProfile->interactionProfile = XR_NULL_PATH;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrSyncActionData(XrSession session, uint32_t countActionSets, const XrActiveActionSet* actionSets) {
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetActionStateBoolean(XrAction action, uint32_t countSubactionPaths, const XrPath* subactionPaths,
+                                     XrActionStateBoolean* data) {
+    data->currentState = XR_FALSE;
+    data->changedSinceLastSync = XR_FALSE;
+    data->lastChangeTime = 0;
+    data->isActive = XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetActionStateVector1f(XrAction action, uint32_t countSubactionPaths, const XrPath* subactionPaths,
+                                      XrActionStateVector1f* data) {
+    data->currentState = 0.0f;
+    data->changedSinceLastSync = XR_FALSE;
+    data->lastChangeTime = 0;
+    data->isActive = XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetActionStateVector2f(XrAction action, uint32_t countSubactionPaths, const XrPath* subactionPaths,
+                                      XrActionStateVector2f* data) {
+    data->currentState = {0.0f, 0.0f};
+    data->changedSinceLastSync = XR_FALSE;
+    data->lastChangeTime = 0;
+    data->isActive = XR_FALSE;
+    return XR_SUCCESS;
+}
+
+// Action spaces are always located, so pose actions are reported as active.
+XrResult MockXrGetActionStatePose(XrAction action, XrPath subactionPath, XrActionStatePose* data) {
+    data->isActive = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetBoundSourcesForAction(XrAction action, uint32_t sourceCapacityInput, uint32_t* sourceCountOutput,
+                                        XrPath* sources) {
+    *sourceCountOutput = 0;
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetInputSourceLocalizedName(XrSession session, XrPath source, XrInputSourceLocalizedNameFlags whichComponents,
+                                           uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer) {
+    return FillString(bufferCapacityInput, bufferCountOutput, buffer, "");
+}
+
+XrResult MockXrApplyHapticFeedback(XrAction hapticAction, uint32_t countSubactionPaths, const XrPath* subactionPaths,
+                                   const XrHapticBaseHeader* hapticEvent) {
+    return XR_SUCCESS;
+}
+
+XrResult MockXrStopHapticFeedback(XrAction hapticAction, uint32_t countSubactionPaths, const XrPath* subactionPaths) {
+    return XR_SUCCESS;
+}
+
+XrResult MockXrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
+
+struct MockCommand {
+    const char* name;
+    PFN_xrVoidFunction function;
+};
+
+#define MOCK_COMMAND(command) \
+    { "xr" #command, reinterpret_cast<PFN_xrVoidFunction>(MockXr##command) }
+
+static const MockCommand g_mock_commands[] = {
+    MOCK_COMMAND(GetInstanceProcAddr),
+    MOCK_COMMAND(EnumerateInstanceExtensionProperties),
+    MOCK_COMMAND(CreateInstance),
+    MOCK_COMMAND(DestroyInstance),
+    MOCK_COMMAND(GetInstanceProperties),
+    MOCK_COMMAND(PollEvent),
+    MOCK_COMMAND(ResultToString),
+    MOCK_COMMAND(StructureTypeToString),
+    MOCK_COMMAND(GetSystem),
+    MOCK_COMMAND(GetSystemProperties),
+    MOCK_COMMAND(EnumerateEnvironmentBlendModes),
+    MOCK_COMMAND(EnumerateViewConfigurations),
+    MOCK_COMMAND(GetViewConfigurationProperties),
+    MOCK_COMMAND(EnumerateViewConfigurationViews),
+    MOCK_COMMAND(CreateSession),
+    MOCK_COMMAND(DestroySession),
+    MOCK_COMMAND(BeginSession),
+    MOCK_COMMAND(EndSession),
+    MOCK_COMMAND(WaitFrame),
+    MOCK_COMMAND(BeginFrame),
+    MOCK_COMMAND(EndFrame),
+    MOCK_COMMAND(EnumerateReferenceSpaces),
+    MOCK_COMMAND(CreateReferenceSpace),
+    MOCK_COMMAND(GetReferenceSpaceBoundsRect),
+    MOCK_COMMAND(CreateActionSpace),
+    MOCK_COMMAND(LocateSpace),
+    MOCK_COMMAND(DestroySpace),
+    MOCK_COMMAND(LocateViews),
+    MOCK_COMMAND(EnumerateSwapchainFormats),
+    MOCK_COMMAND(CreateSwapchain),
+    MOCK_COMMAND(DestroySwapchain),
+    MOCK_COMMAND(EnumerateSwapchainImages),
+    MOCK_COMMAND(AcquireSwapchainImage),
+    MOCK_COMMAND(WaitSwapchainImage),
+    MOCK_COMMAND(ReleaseSwapchainImage),
+    MOCK_COMMAND(StringToPath),
+    MOCK_COMMAND(PathToString),
+    MOCK_COMMAND(CreateActionSet),
+    MOCK_COMMAND(DestroyActionSet),
+    MOCK_COMMAND(CreateAction),
+    MOCK_COMMAND(DestroyAction),
+    MOCK_COMMAND(SetInteractionProfileSuggestedBindings),
+    MOCK_COMMAND(GetCurrentInteractionProfile),
+    MOCK_COMMAND(SyncActionData),
+    MOCK_COMMAND(GetActionStateBoolean),
+    MOCK_COMMAND(GetActionStateVector1f),
+    MOCK_COMMAND(GetActionStateVector2f),
+    MOCK_COMMAND(GetActionStatePose),
+    MOCK_COMMAND(GetBoundSourcesForAction),
+    MOCK_COMMAND(GetInputSourceLocalizedName),
+    MOCK_COMMAND(ApplyHapticFeedback),
+    MOCK_COMMAND(StopHapticFeedback),
+};
+
+#undef MOCK_COMMAND
+
+XrResult MockXrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
+    *function = nullptr;
+    for (const MockCommand& command : g_mock_commands) {
+        if (0 == strcmp(name, command.name)) {
+            *function = command.function;
+            break;
+        }
+    }
+    return *function ? XR_SUCCESS : XR_ERROR_FUNCTION_UNSUPPORTED;
+}
+
+// Function used to negotiate an interface betewen the loader and a runtime.
+RUNTIME_EXPORT XrResult xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderInfo,
+                                                          XrNegotiateRuntimeRequest* runtimeRequest) {
+    if (nullptr == loaderInfo || nullptr == runtimeRequest || loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO ||
+        loaderInfo->structVersion != XR_LOADER_INFO_STRUCT_VERSION || loaderInfo->structSize != sizeof(XrNegotiateLoaderInfo) ||
+        runtimeRequest->structType != XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST ||
+        runtimeRequest->structVersion != XR_RUNTIME_INFO_STRUCT_VERSION ||
+        runtimeRequest->structSize != sizeof(XrNegotiateRuntimeRequest) ||
+        loaderInfo->minInterfaceVersion > XR_CURRENT_LOADER_RUNTIME_VERSION ||
+        loaderInfo->maxInterfaceVersion < XR_CURRENT_LOADER_RUNTIME_VERSION ||
+        loaderInfo->maxInterfaceVersion > XR_CURRENT_LOADER_RUNTIME_VERSION ||
+        loaderInfo->minXrVersion < XR_MAKE_VERSION(0, 1, 0) || loaderInfo->minXrVersion >= XR_MAKE_VERSION(1, 1, 0)) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+
+    runtimeRequest->runtimeInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+    runtimeRequest->runtimeXrVersion = XR_CURRENT_API_VERSION;
+    runtimeRequest->getInstanceProcAddr = reinterpret_cast<PFN_xrGetInstanceProcAddr>(MockXrGetInstanceProcAddr);
+
+    return XR_SUCCESS;
+}
+
+}  // extern "C"
@@ -17,6 +17,7 @@
 // Author: Mark Young <marky@lunarg.com>
 //
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -55,6 +56,78 @@ XrResult RuntimeTestXrEnumerateInstanceExtensionProperties(const char *layerName
     return XR_SUCCESS;
 }
 
+XrResult RuntimeTestXrGetSystem(XrInstance instance, const XrSystemGetInfo *getInfo, XrSystemId *systemId) {
+    *systemId = 1;
+    return XR_SUCCESS;
+}
+
+// Handles are made up without allocating anything, so the loader's own allocations can be told apart.
+// Benchmarks create objects from several threads at once.
+static uint64_t RuntimeTestNextHandle() {
+    static std::atomic<uint64_t> next_handle(1);
+    return next_handle++;
+}
+
+XrResult RuntimeTestXrCreateSession(XrInstance instance, const XrSessionCreateInfo *createInfo, XrSession *session) {
+    *session = reinterpret_cast<XrSession>(RuntimeTestNextHandle());
+    return XR_SUCCESS;
+}
+
+XrResult RuntimeTestXrDestroySession(XrSession session) { return XR_SUCCESS; }
+
+XrResult RuntimeTestXrBeginSession(XrSession session, const XrSessionBeginInfo *beginInfo) { return XR_SUCCESS; }
+
+XrResult RuntimeTestXrEndSession(XrSession session) { return XR_SUCCESS; }
+
+// The rest do nothing at all, so that benchmarks only measure what the loader and API layers add on top
+XrResult RuntimeTestXrCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateInfo *createInfo, XrSpace *space) {
+    *space = reinterpret_cast<XrSpace>(RuntimeTestNextHandle());
+    return XR_SUCCESS;
+}
+
+XrResult RuntimeTestXrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceRelation *relation) { return XR_SUCCESS; }
+
+XrResult RuntimeTestXrDestroySpace(XrSpace space) { return XR_SUCCESS; }
+
+XrResult RuntimeTestXrCreateActionSet(XrSession session, const XrActionSetCreateInfo *createInfo, XrActionSet *actionSet) {
+    *actionSet = reinterpret_cast<XrActionSet>(RuntimeTestNextHandle());
+    return XR_SUCCESS;
+}
+
+XrResult RuntimeTestXrDestroyActionSet(XrActionSet actionSet) { return XR_SUCCESS; }
+
+XrResult RuntimeTestXrCreateAction(XrActionSet actionSet, const XrActionCreateInfo *createInfo, XrAction *action) {
+    *action = reinterpret_cast<XrAction>(RuntimeTestNextHandle());
+    return XR_SUCCESS;
+}
+
+XrResult RuntimeTestXrDestroyAction(XrAction action) { return XR_SUCCESS; }
+
+XrResult RuntimeTestXrGetActionStateBoolean(XrAction action, uint32_t countSubactionPaths, const XrPath *subactionPaths,
+                                            XrActionStateBoolean *data) {
+    return XR_SUCCESS;
+}
+
+XrResult RuntimeTestXrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo *createInfo, XrSwapchain *swapchain) {
+    *swapchain = reinterpret_cast<XrSwapchain>(RuntimeTestNextHandle());
+    return XR_SUCCESS;
+}
+
+XrResult RuntimeTestXrDestroySwapchain(XrSwapchain swapchain) { return XR_SUCCESS; }
+
+XrResult RuntimeTestXrAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo *acquireInfo,
+                                            uint32_t *index) {
+    *index = 0;
+    return XR_SUCCESS;
+}
+
+XrResult RuntimeTestXrEndFrame(XrSession session, const XrFrameEndInfo *frameEndInfo) { return XR_SUCCESS; }
+
+XrResult RuntimeTestXrStringToPath(XrInstance instance, const char *pathString, XrPath *path) {
+    *path = 1;
+    return XR_SUCCESS;
+}
+
 XrResult RuntimeTestXrGetInstanceProcAddr(XrInstance instance, const char *name, PFN_xrVoidFunction *function) {
     if (0 == strcmp(name, "xrGetInstanceProcAddr")) {
         *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrGetInstanceProcAddr);
@@ -64,6 +137,42 @@ XrResult RuntimeTestXrGetInstanceProcAddr(XrInstance instance, const char *name,
         *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrCreateInstance);
     } else if (0 == strcmp(name, "xrDestroyInstance")) {
         *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrDestroyInstance);
+    } else if (0 == strcmp(name, "xrGetSystem")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrGetSystem);
+    } else if (0 == strcmp(name, "xrCreateSession")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrCreateSession);
+    } else if (0 == strcmp(name, "xrDestroySession")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrDestroySession);
+    } else if (0 == strcmp(name, "xrBeginSession")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrBeginSession);
+    } else if (0 == strcmp(name, "xrEndSession")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrEndSession);
+    } else if (0 == strcmp(name, "xrCreateReferenceSpace")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrCreateReferenceSpace);
+    } else if (0 == strcmp(name, "xrLocateSpace")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrLocateSpace);
+    } else if (0 == strcmp(name, "xrDestroySpace")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrDestroySpace);
+    } else if (0 == strcmp(name, "xrCreateActionSet")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrCreateActionSet);
+    } else if (0 == strcmp(name, "xrDestroyActionSet")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrDestroyActionSet);
+    } else if (0 == strcmp(name, "xrCreateAction")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrCreateAction);
+    } else if (0 == strcmp(name, "xrDestroyAction")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrDestroyAction);
+    } else if (0 == strcmp(name, "xrGetActionStateBoolean")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrGetActionStateBoolean);
+    } else if (0 == strcmp(name, "xrCreateSwapchain")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrCreateSwapchain);
+    } else if (0 == strcmp(name, "xrDestroySwapchain")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrDestroySwapchain);
+    } else if (0 == strcmp(name, "xrAcquireSwapchainImage")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrAcquireSwapchainImage);
+    } else if (0 == strcmp(name, "xrEndFrame")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrEndFrame);
+    } else if (0 == strcmp(name, "xrStringToPath")) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(RuntimeTestXrStringToPath);
     } else {
         *function = nullptr;
     }